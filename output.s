@@ -0,0 +1,45 @@
+.text
+.globl main
+.type main, @function
+main:
+	pushq	%rbp
+	movq	%rsp, %rbp
+	subq	$112, %rsp
+	movq	$7, -8(%rbp)
+	movq	$3, -16(%rbp)
+	movq	-8(%rbp), %rcx
+	addq	-16(%rbp), %rcx
+	movq	%rcx, -24(%rbp)
+	movq	-8(%rbp), %rcx
+	subq	-16(%rbp), %rcx
+	movq	%rcx, -32(%rbp)
+	movq	-8(%rbp), %rcx
+	imulq	-16(%rbp), %rcx
+	movq	%rcx, -40(%rbp)
+	movq	$100, -48(%rbp)
+	movq	-48(%rbp), %rcx
+	addq	$50, %rcx
+	movq	%rcx, -56(%rbp)
+	movq	-56(%rbp), %rcx
+	subq	$25, %rcx
+	movq	%rcx, -64(%rbp)
+	movq	$42, -72(%rbp)
+	movq	-72(%rbp), %rcx
+	subq	-72(%rbp), %rcx
+	movq	%rcx, -80(%rbp)
+	movq	-72(%rbp), %rcx
+	addq	$0, %rcx
+	movq	%rcx, -88(%rbp)
+	movq	-72(%rbp), %rcx
+	imulq	$2, %rcx
+	movq	%rcx, -96(%rbp)
+	movq	$999, -104(%rbp)
+	movq	-8(%rbp), %rcx
+	addq	-16(%rbp), %rcx
+	movq	-32(%rbp), %rsi
+	addq	$1, %rsi
+	imulq	%rsi, %rcx
+	movq	%rcx, -112(%rbp)
+	leave
+	ret
+.section	.note.GNU-stack,"",@progbits
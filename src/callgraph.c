@@ -0,0 +1,350 @@
+#include "callgraph.h"
+#include "optimizer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Grafo de llamadas y resúmenes mod/ref.
+ *
+ * Cada METHOD es un nodo y cada CALL a otro METHOD una arista. Las componentes
+ * fuertemente conexas (Tarjan) salen de las hojas hacia main, así que al cerrar
+ * una componente ya están resueltos todos los métodos que llama desde afuera:
+ * el resumen de la componente es la unión de lo que hace cada miembro por su
+ * propio código y de los resúmenes de sus callees, y lo comparten todos los
+ * miembros.
+ *
+ * Los externos no ven las globales del programa: una llamada a un externo tiene
+ * efectos (entrada/salida) pero no lee ni escribe globales.
+ */
+
+/*
+ * Índice de la global (el orden en que se registró), o -1 si sym no es una.
+ */
+static int global_index(IRSymbol *sym) {
+    return sym && sym->type == IR_SYM_VAR ? ir_global_index(sym->name) : -1;
+}
+
+/*
+ * Lo que el método hace por su propio código: globales que lee y escribe,
+ * métodos y externos que llama, y si tiene algún salto hacia atrás.
+ */
+static bool scan_method(CallGraph *cg, IRList *list, CallNode *node) {
+    StrMap labels;
+    strmap_init(&labels, 16);
+    for (int i = node->start + 1; i < node->end; i++) {
+        if (list->codes[i].op == IR_LABEL && list->codes[i].result) strmap_put(&labels, list->codes[i].result->name, i);
+    }
+
+    bool has_loop = false;
+    for (int i = node->start + 1; i < node->end; i++) {
+        IRCode *code = &list->codes[i];
+        if (code->op == IR_CALL && code->arg1) {
+            int callee = strmap_get(&cg->node_map, code->arg1->name);
+            if (callee < 0) {
+                node->calls_extern = true;
+                bool seen = false;
+                for (int k = 0; k < node->num_externs && !seen; k++) seen = strcmp(node->externs[k], code->arg1->name) == 0;
+                if (!seen) node->externs[node->num_externs++] = code->arg1->name;
+            } else {
+                bool seen = false;
+                for (int k = 0; k < node->num_callees && !seen; k++) seen = node->callees[k] == callee;
+                if (!seen) node->callees[node->num_callees++] = callee;
+            }
+        }
+        if ((code->op == IR_GOTO || ir_is_cond_branch(code)) && code->result) {
+            int target = strmap_get(&labels, code->result->name);
+            if (target >= 0 && target <= i) has_loop = true;
+        }
+
+        IRSymbol *uses[2];
+        int count = ir_use_symbols(code, uses);
+        for (int u = 0; u < count; u++) {
+            int g = global_index(uses[u]);
+            if (g >= 0) bitset_set(&node->reads, g);
+        }
+        int g = global_index(ir_def_symbol(code));
+        if (g >= 0) bitset_set(&node->writes, g);
+    }
+    strmap_free(&labels);
+    return has_loop;
+}
+
+typedef struct {
+    int *index;
+    int *lowlink;
+    bool *on_stack;
+    int *stack;
+    int top;
+    int next_index;
+    int closed;             // Nodos ya ubicados en bottom_up
+    bool *has_loop;
+} Tarjan;
+
+/*
+ * Cierra la componente formada por members: une los resúmenes y los copia a
+ * todos sus miembros.
+ */
+static void summarize_scc(CallGraph *cg, int *members, int count, bool *has_loop) {
+    int scc = cg->num_sccs++;
+    for (int m = 0; m < count; m++) cg->nodes[members[m]].scc = scc;
+
+    BitSet reads, writes;
+    bitset_init(&reads, cg->num_globals);
+    bitset_init(&writes, cg->num_globals);
+    bool recursive = count > 1, calls_extern = false, terminates = true;
+    for (int m = 0; m < count; m++) {
+        CallNode *node = &cg->nodes[members[m]];
+        bitset_union_with(&reads, &node->reads);
+        bitset_union_with(&writes, &node->writes);
+        if (node->calls_extern) calls_extern = true;
+        if (has_loop[members[m]]) terminates = false;
+        for (int k = 0; k < node->num_callees; k++) {
+            CallNode *callee = &cg->nodes[node->callees[k]];
+            if (callee->scc == scc) {
+                recursive = true;
+                continue;
+            }
+            bitset_union_with(&reads, &callee->reads);
+            bitset_union_with(&writes, &callee->writes);
+            if (callee->calls_extern) calls_extern = true;
+            if (!callee->terminates) terminates = false;
+        }
+    }
+    if (recursive) terminates = false;
+
+    for (int m = 0; m < count; m++) {
+        CallNode *node = &cg->nodes[members[m]];
+        bitset_copy(&node->reads, &reads);
+        bitset_copy(&node->writes, &writes);
+        node->recursive = recursive;
+        node->calls_extern = calls_extern;
+        node->terminates = terminates;
+    }
+    bitset_free(&reads);
+    bitset_free(&writes);
+}
+
+static void strong_connect(CallGraph *cg, Tarjan *t, int v) {
+    t->index[v] = t->lowlink[v] = t->next_index++;
+    t->stack[t->top++] = v;
+    t->on_stack[v] = true;
+
+    CallNode *node = &cg->nodes[v];
+    for (int k = 0; k < node->num_callees; k++) {
+        int w = node->callees[k];
+        if (t->index[w] < 0) {
+            strong_connect(cg, t, w);
+            if (t->lowlink[w] < t->lowlink[v]) t->lowlink[v] = t->lowlink[w];
+        } else if (t->on_stack[w] && t->index[w] < t->lowlink[v]) {
+            t->lowlink[v] = t->index[w];
+        }
+    }
+
+    if (t->lowlink[v] == t->index[v]) {
+        int first = t->top;
+        do {
+            first--;
+            t->on_stack[t->stack[first]] = false;
+        } while (t->stack[first] != v);
+        summarize_scc(cg, &t->stack[first], t->top - first, t->has_loop);
+        memcpy(&cg->bottom_up[t->closed], &t->stack[first], (t->top - first) * sizeof(int));
+        t->closed += t->top - first;
+        t->top = first;
+    }
+}
+
+void callgraph_build(CallGraph *cg, IRList *list) {
+    memset(cg, 0, sizeof(CallGraph));
+    cg->nodes = df_alloc(list->size, sizeof(CallNode));
+    cg->num_globals = ir_global_count();
+    strmap_init(&cg->node_map, 16);
+    strmap_init(&cg->extern_map, 16);
+
+    for (int i = 0; i < list->size; i++) {
+        IRCode *code = &list->codes[i];
+        if (code->op == IR_METHOD && code->result) {
+            CallNode *node = &cg->nodes[cg->num_nodes];
+            node->name = code->result->name;
+            node->start = i;
+            node->end = ir_function_end(list, i);
+            strmap_put(&cg->node_map, node->name, cg->num_nodes++);
+        } else if (code->op == IR_EXTERN && code->result) {
+            strmap_put(&cg->extern_map, code->result->name, 1);
+        }
+    }
+
+    bool *has_loop = df_alloc(cg->num_nodes, sizeof(bool));
+    bitset_init(&cg->written, cg->num_globals);
+    for (int k = 0; k < cg->num_nodes; k++) {
+        CallNode *node = &cg->nodes[k];
+        int n = node->end - node->start;
+        node->callees = df_alloc(n, sizeof(int));
+        node->externs = df_alloc(n, sizeof(const char *));
+        node->scc = -1;
+        bitset_init(&node->reads, cg->num_globals);
+        bitset_init(&node->writes, cg->num_globals);
+        has_loop[k] = scan_method(cg, list, node);
+        bitset_union_with(&cg->written, &node->writes);
+    }
+
+    Tarjan t;
+    t.index = df_alloc(cg->num_nodes, sizeof(int));
+    t.lowlink = df_alloc(cg->num_nodes, sizeof(int));
+    t.on_stack = df_alloc(cg->num_nodes, sizeof(bool));
+    t.stack = df_alloc(cg->num_nodes, sizeof(int));
+    t.top = 0;
+    t.next_index = 0;
+    t.closed = 0;
+    t.has_loop = has_loop;
+    cg->bottom_up = df_alloc(cg->num_nodes, sizeof(int));
+    for (int k = 0; k < cg->num_nodes; k++) t.index[k] = -1;
+    for (int k = 0; k < cg->num_nodes; k++) {
+        if (t.index[k] < 0) strong_connect(cg, &t, k);
+    }
+
+    for (int k = 0; k < cg->num_nodes; k++) {
+        CallNode *node = &cg->nodes[k];
+        node->read_only = !node->calls_extern && bitset_count(&node->writes) == 0;
+        node->pure = node->read_only;
+        for (int g = bitset_next(&node->reads, 0); g >= 0 && node->pure; g = bitset_next(&node->reads, g + 1)) {
+            if (bitset_test(&cg->written, g)) node->pure = false;
+        }
+    }
+
+    // Alcanzables desde main, con la pila de Tarjan como worklist
+    int main_node = callgraph_node(cg, "main");
+    for (int k = 0; k < cg->num_nodes; k++) cg->nodes[k].reachable = main_node < 0;
+    if (main_node >= 0) {
+        int top = 0;
+        cg->nodes[main_node].reachable = true;
+        t.stack[top++] = main_node;
+        while (top > 0) {
+            CallNode *node = &cg->nodes[t.stack[--top]];
+            for (int c = 0; c < node->num_callees; c++) {
+                CallNode *callee = &cg->nodes[node->callees[c]];
+                if (callee->reachable) continue;
+                callee->reachable = true;
+                t.stack[top++] = node->callees[c];
+            }
+        }
+    }
+
+    free(t.index);
+    free(t.lowlink);
+    free(t.on_stack);
+    free(t.stack);
+    free(has_loop);
+}
+
+void callgraph_free(CallGraph *cg) {
+    for (int k = 0; k < cg->num_nodes; k++) {
+        free(cg->nodes[k].callees);
+        free(cg->nodes[k].externs);
+        bitset_free(&cg->nodes[k].reads);
+        bitset_free(&cg->nodes[k].writes);
+    }
+    free(cg->nodes);
+    free(cg->bottom_up);
+    bitset_free(&cg->written);
+    strmap_free(&cg->node_map);
+    strmap_free(&cg->extern_map);
+    memset(cg, 0, sizeof(CallGraph));
+}
+
+int callgraph_node(const CallGraph *cg, const char *name) {
+    return strmap_get((StrMap *)&cg->node_map, name);
+}
+
+int callgraph_global(const CallGraph *cg, const char *name) {
+    int g = ir_global_index(name);
+    return g < cg->num_globals ? g : -1;
+}
+
+static void print_globals(const BitSet *set) {
+    int printed = 0;
+    for (int g = bitset_next(set, 0); g >= 0; g = bitset_next(set, g + 1)) {
+        printf("%s%s", printed++ > 0 ? ", " : "", ir_global_name(g));
+    }
+    if (printed == 0) printf("-");
+}
+
+/*
+ * Imprime las componentes desde las hojas y el resumen de cada método.
+ */
+void callgraph_dump(const CallGraph *cg) {
+    printf("\n=== GRAFO DE LLAMADAS ===\n");
+    for (int scc = 0; scc < cg->num_sccs; scc++) {
+        printf("SCC %d:", scc);
+        for (int k = 0; k < cg->num_nodes; k++) {
+            if (cg->nodes[k].scc == scc) printf(" %s", cg->nodes[k].name);
+        }
+        printf("\n");
+        for (int k = 0; k < cg->num_nodes; k++) {
+            const CallNode *node = &cg->nodes[k];
+            if (node->scc != scc) continue;
+            printf("  %s -> ", node->name);
+            int printed = 0;
+            for (int c = 0; c < node->num_callees; c++) {
+                printf("%s%s", printed++ > 0 ? ", " : "", cg->nodes[node->callees[c]].name);
+            }
+            for (int e = 0; e < node->num_externs; e++) {
+                printf("%s%s (externo)", printed++ > 0 ? ", " : "", node->externs[e]);
+            }
+            if (printed == 0) printf("-");
+            printf("\n     lee: ");
+            print_globals(&node->reads);
+            printf("  escribe: ");
+            print_globals(&node->writes);
+            printf("\n     %s%s%s%s%s\n",
+                   node->pure ? "pura" : node->read_only ? "sólo lectura" : "con efectos",
+                   node->calls_extern ? ", llama a externos" : "",
+                   node->recursive ? ", recursiva" : "",
+                   node->terminates ? ", termina" : "",
+                   node->reachable ? "" : ", inalcanzable desde main");
+        }
+    }
+    printf("=== FIN DEL GRAFO DE LLAMADAS ===\n\n");
+}
+
+static CallGraph current;
+static bool current_valid = false;
+
+void callgraph_update(IRList *list) {
+    callgraph_clear();
+    callgraph_build(&current, list);
+    current_valid = true;
+}
+
+void callgraph_clear(void) {
+    if (current_valid) callgraph_free(&current);
+    current_valid = false;
+}
+
+const CallNode *callgraph_summary(const char *name) {
+    if (!current_valid || !name) return NULL;
+    int node = callgraph_node(&current, name);
+    return node >= 0 ? &current.nodes[node] : NULL;
+}
+
+/*
+ * Un externo conocido no toca globales; un método conocido, las de su
+ * resumen; cualquier otra cosa, todas.
+ */
+static bool may_access(const char *callee, const char *global, bool write) {
+    if (!current_valid || !callee) return true;
+    if (strmap_get(&current.extern_map, callee) >= 0) return false;
+    const CallNode *node = callgraph_summary(callee);
+    if (!node) return true;
+    int g = callgraph_global(&current, global);
+    if (g < 0) return false;
+    return bitset_test(write ? &node->writes : &node->reads, g);
+}
+
+bool callgraph_may_read(const char *callee, const char *global) {
+    return may_access(callee, global, false);
+}
+
+bool callgraph_may_write(const char *callee, const char *global) {
+    return may_access(callee, global, true);
+}
@@ -0,0 +1,61 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include "intermediate.h"
+#include "dataflow.h"
+
+/*
+ * Nodo del grafo de llamadas: un METHOD del programa y el resumen de lo que
+ * puede hacer una llamada a él, contando todo lo que llama.
+ */
+typedef struct {
+    const char *name;
+    int start;
+    int end;
+    int *callees;           // Métodos del programa que llama, sin repetir
+    int num_callees;
+    const char **externs;   // Externos que llama directamente, sin repetir
+    int num_externs;
+    int scc;                // Componente fuertemente conexa, numeradas desde las hojas
+    bool recursive;         // Está en un ciclo del grafo (incluye llamarse a sí mismo)
+    bool calls_extern;      // Llama a un externo, directa o indirectamente
+    bool terminates;        // Sin loops ni recursión, ni en ella ni en lo que llama
+    bool read_only;         // No llama a externos ni escribe globales
+    bool pure;              // read_only y sólo lee globales que ningún método escribe
+    bool reachable;         // Se puede llegar desde main (todos, si no hay main)
+    BitSet reads;           // Globales que puede leer (índices de ir_global_index)
+    BitSet writes;          // Globales que puede escribir
+} CallNode;
+
+typedef struct {
+    CallNode *nodes;        // En el orden de los METHOD en la lista
+    int num_nodes;
+    StrMap node_map;
+    StrMap extern_map;
+    int num_globals;        // Globales registradas al construirlo
+    BitSet written;         // Globales que escribe algún método
+    int num_sccs;
+    int *bottom_up;         // Nodos desde las hojas: cada componente después de las que llama
+} CallGraph;
+
+void callgraph_build(CallGraph *cg, IRList *list);
+void callgraph_free(CallGraph *cg);
+int callgraph_node(const CallGraph *cg, const char *name);
+int callgraph_global(const CallGraph *cg, const char *name);
+void callgraph_dump(const CallGraph *cg);
+
+/*
+ * Resúmenes del programa que se está optimizando. El pipeline los calcula al
+ * empezar y los recalcula después de cada pase que agrega, saca o redirige
+ * llamadas; los que sólo eliminan código los dejan más grandes de lo
+ * necesario, nunca incorrectos. Los análisis de flujo de datos los consultan
+ * en cada CALL; sin resúmenes (o para un método que no estaba al calcularlos)
+ * una llamada puede leer y escribir cualquier global.
+ */
+void callgraph_update(IRList *list);
+void callgraph_clear(void);
+const CallNode *callgraph_summary(const char *name);
+bool callgraph_may_read(const char *callee, const char *global);
+bool callgraph_may_write(const char *callee, const char *global);
+
+#endif
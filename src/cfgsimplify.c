@@ -0,0 +1,272 @@
+#include "cfgsimplify.h"
+#include "optimizer.h"
+#include "dataflow.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Simplificación del CFG sobre el IR lineal de cada función.
+ *
+ * Cada vuelta:
+ *   - pliega los saltos cuya condición es constante (GOTO o nada);
+ *   - elimina los bloques a los que no se llega desde la entrada;
+ *   - redirige cada salto a través de los bloques que sólo tienen un GOTO y,
+ *     si es condicional, de los que empiezan con un salto sobre la misma
+ *     condición, cuyo resultado ya se conoce (si no se toma, se sigue después
+ *     de él, con una etiqueta nueva si hace falta);
+ *   - elimina los saltos al bloque siguiente, invierte IF c, L; GOTO M; L: en
+ *     IF !c, M; L: y resuelve un salto sobre la misma condición que el salto
+ *     condicional que lo precede directamente;
+ *   - elimina las etiquetas sin saltos, lo que une su bloque con el anterior.
+ * Se repite hasta que no cambia nada.
+ */
+
+typedef struct {
+    int folded;
+    int unreachable;
+    int threaded;
+    int removed;
+    int labels;
+} CFGStats;
+
+static bool is_jump(IRCode *code) {
+    return code->op == IR_GOTO || ir_is_cond_branch(code);
+}
+
+static bool same_operands(IRCode *a, IRCode *b) {
+    return same_symbol(a->arg1, b->arg1) && same_symbol(a->arg2, b->arg2);
+}
+
+/*
+ * 1 si el salto se toma siempre, 0 si nunca, -1 si depende de los operandos.
+ */
+static int branch_outcome(IRCode *code) {
+    if (code->op == IR_IF_FALSE || code->op == IR_IF_TRUE) {
+        if (!is_constant_symbol(code->arg1)) return -1;
+        bool zero = get_constant_value(code->arg1) == 0;
+        return code->op == IR_IF_FALSE ? zero : !zero;
+    }
+    if (!is_constant_symbol(code->arg1) || !is_constant_symbol(code->arg2)) return -1;
+    int x = get_constant_value(code->arg1), y = get_constant_value(code->arg2);
+    switch (code->op) {
+        case IR_IF_EQ:  return x == y;
+        case IR_IF_NEQ: return x != y;
+        case IR_IF_LT:  return x < y;
+        case IR_IF_LE:  return x <= y;
+        case IR_IF_GT:  return x > y;
+        case IR_IF_GE:  return x >= y;
+        default:        return -1;
+    }
+}
+
+/*
+ * Primera instrucción desde i que no es NOP ni etiqueta (end si no hay).
+ */
+static int next_real(IRList *list, int i, int end) {
+    while (i < end && (ir_is_nop(&list->codes[i]) || list->codes[i].op == IR_LABEL)) i++;
+    return i;
+}
+
+/*
+ * Etiqueta final del salto en jump. Si el destino es un salto condicional que
+ * no se toma y después no hay etiqueta, devuelve NULL y deja en *insert_at
+ * dónde crearla.
+ */
+static IRSymbol *thread_target(IRList *list, StrMap *labels, int jump, int end, int *insert_at) {
+    IRCode *code = &list->codes[jump];
+    IRSymbol *target = code->result;
+    bool cond = ir_is_cond_branch(code);
+
+    // Entre el salto y el destino no se ejecuta nada más que saltos: los operandos no cambian
+    for (int steps = 0; steps < end; steps++) {
+        int pos = strmap_get(labels, target->name);
+        if (pos < 0) break;
+        int q = next_real(list, pos, end);
+        if (q >= end || q == jump) break;
+        IRCode *next = &list->codes[q];
+        if (next->op == IR_GOTO) {
+            target = next->result;
+            continue;
+        }
+        if (!cond || !ir_is_cond_branch(next) || !same_operands(code, next)) break;
+        if (next->op == code->op) {
+            target = next->result;
+            continue;
+        }
+        if (next->op != negate_branch_op(code->op)) break;
+
+        int after = q + 1;
+        while (after < end && ir_is_nop(&list->codes[after])) after++;
+        if (after < end && list->codes[after].op == IR_LABEL) {
+            target = list->codes[after].result;
+            continue;
+        }
+        *insert_at = after;
+        return NULL;
+    }
+    return target;
+}
+
+static void fold_constant_branches(IRList *list, int start, int end, CFGStats *stats, bool *changed) {
+    for (int i = start + 1; i < end; i++) {
+        IRCode *code = &list->codes[i];
+        if (!ir_is_cond_branch(code)) continue;
+        int outcome = branch_outcome(code);
+        if (outcome < 0) continue;
+        if (debug_mode) printf("  [CFG] Línea %d: salto que %s se toma\n", i, outcome ? "siempre" : "nunca");
+        if (outcome) replace_instruction(list, i, IR_GOTO, NULL, NULL, code->result);
+        else mark_instruction_as_nop(list, i);
+        stats->folded++;
+        *changed = true;
+    }
+}
+
+static void remove_unreachable_blocks(IRList *list, int start, CFGStats *stats, bool *changed) {
+    CFG cfg;
+    cfg_build(&cfg, list, start);
+    // El código de nivel superior que quedó al final del rango no es de la función
+    int top_level = cfg_top_level_start(&cfg);
+    for (int b = 0; b < cfg.num_blocks && cfg.blocks[b].start < top_level; b++) {
+        if (cfg.blocks[b].rpo >= 0) continue;
+        for (int i = cfg.blocks[b].start; i < cfg.blocks[b].end; i++) {
+            if (ir_is_nop(&list->codes[i])) continue;
+            if (debug_mode) printf("  [CFG] Línea %d: instrucción inalcanzable eliminada\n", i);
+            mark_instruction_as_nop(list, i);
+            stats->unreachable++;
+            *changed = true;
+        }
+    }
+    cfg_free(&cfg);
+}
+
+/*
+ * Redirige los saltos encadenados. Devuelve la posición donde hace falta una
+ * etiqueta nueva, o -1.
+ */
+static int thread_jumps(IRList *list, StrMap *labels, int start, int end, CFGStats *stats, bool *changed) {
+    for (int i = start + 1; i < end; i++) {
+        IRCode *code = &list->codes[i];
+        if (!is_jump(code)) continue;
+        int insert_at = -1;
+        IRSymbol *target = thread_target(list, labels, i, end, &insert_at);
+        if (!target) return insert_at;
+        if (same_symbol(target, code->result)) continue;
+        if (debug_mode) {
+            printf("  [CFG] Línea %d: salto a %s redirigido a %s\n", i, code->result->name, target->name);
+        }
+        code->result = target;
+        stats->threaded++;
+        *changed = true;
+    }
+    return -1;
+}
+
+static void remove_redundant_jumps(IRList *list, StrMap *labels, int start, int end, CFGStats *stats, bool *changed) {
+    for (int i = start + 1; i < end; i++) {
+        IRCode *code = &list->codes[i];
+        if (!is_jump(code)) continue;
+        int pos = strmap_get(labels, code->result->name);
+        if (pos < 0) continue;
+        int dest = next_real(list, pos, end);
+        if (dest == next_real(list, i + 1, end)) {
+            if (debug_mode) printf("  [CFG] Línea %d: salto al bloque siguiente eliminado\n", i);
+            mark_instruction_as_nop(list, i);
+            stats->removed++;
+            *changed = true;
+            continue;
+        }
+        if (!ir_is_cond_branch(code)) continue;
+
+        // Sin etiquetas en el medio, a la instrucción siguiente sólo se llega cuando el salto no se toma
+        int q = i + 1;
+        while (q < end && ir_is_nop(&list->codes[q])) q++;
+        if (q >= end) continue;
+        IRCode *next = &list->codes[q];
+        if (next->op == IR_GOTO && next_real(list, q + 1, end) == dest) {
+            if (debug_mode) printf("  [CFG] Línea %d: salto condicional invertido sobre el GOTO de la línea %d\n", i, q);
+            code->op = negate_branch_op(code->op);
+            code->result = next->result;
+            mark_instruction_as_nop(list, q);
+            stats->removed++;
+            *changed = true;
+        } else if (ir_is_cond_branch(next) && same_operands(code, next)) {
+            if (next->op == code->op) {
+                if (debug_mode) printf("  [CFG] Línea %d: salto con la condición de la línea %d eliminado\n", q, i);
+                mark_instruction_as_nop(list, q);
+                stats->removed++;
+                *changed = true;
+            } else if (next->op == negate_branch_op(code->op)) {
+                if (debug_mode) printf("  [CFG] Línea %d: salto con la condición negada de la línea %d siempre se toma\n", q, i);
+                replace_instruction(list, q, IR_GOTO, NULL, NULL, next->result);
+                stats->folded++;
+                *changed = true;
+            }
+        }
+    }
+}
+
+static void remove_unused_labels(IRList *list, StrMap *labels, int start, int end, CFGStats *stats, bool *changed) {
+    int *refs = df_alloc(end - start, sizeof(int));
+    for (int i = start + 1; i < end; i++) {
+        if (!is_jump(&list->codes[i])) continue;
+        int pos = strmap_get(labels, list->codes[i].result->name);
+        if (pos >= 0) refs[pos - start]++;
+    }
+    for (int i = start + 1; i < end; i++) {
+        IRCode *code = &list->codes[i];
+        if (code->op != IR_LABEL || !code->result || refs[i - start] > 0) continue;
+        if (debug_mode) printf("  [CFG] Línea %d: etiqueta %s sin saltos eliminada\n", i, code->result->name);
+        mark_instruction_as_nop(list, i);
+        stats->labels++;
+        *changed = true;
+    }
+    free(refs);
+}
+
+static void simplify_function(IRList *list, int start, CFGStats *stats) {
+    for (int round = 0; round < CFG_SIMPLIFY_MAX_ROUNDS; round++) {
+        int end = ir_function_end(list, start);
+        bool changed = false;
+
+        fold_constant_branches(list, start, end, stats, &changed);
+        remove_unreachable_blocks(list, start, stats, &changed);
+
+        StrMap labels;
+        strmap_init(&labels, 16);
+        for (int i = start + 1; i < end; i++) {
+            if (list->codes[i].op == IR_LABEL && list->codes[i].result) {
+                strmap_put(&labels, list->codes[i].result->name, i);
+            }
+        }
+
+        int insert_at = thread_jumps(list, &labels, start, end, stats, &changed);
+        if (insert_at >= 0) {
+            // La etiqueta nueva mueve los índices: se vuelve a empezar
+            IRCode label = {IR_LABEL, NULL, NULL, new_label_symbol()};
+            ir_replace_range(list, insert_at, insert_at, &label, 1);
+            strmap_free(&labels);
+            continue;
+        }
+        remove_redundant_jumps(list, &labels, start, end, stats, &changed);
+        remove_unused_labels(list, &labels, start, end, stats, &changed);
+        strmap_free(&labels);
+
+        if (!changed) break;
+    }
+}
+
+void optimize_cfg_simplification(IRList *list) {
+    CFGStats stats = {0, 0, 0, 0, 0};
+    for (int i = 0; i < list->size; i++) {
+        if (list->codes[i].op == IR_METHOD) simplify_function(list, i, &stats);
+    }
+    compact_ir_list(list);
+
+    int total = stats.folded + stats.unreachable + stats.threaded + stats.removed + stats.labels;
+    if (total > 0 && debug_mode) {
+        printf("✓ Simplificación del CFG: %d saltos resueltos, %d instrucciones inalcanzables, "
+               "%d saltos redirigidos, %d saltos eliminados, %d bloques unidos\n",
+               stats.folded, stats.unreachable, stats.threaded, stats.removed, stats.labels);
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef CFGSIMPLIFY_H
+#define CFGSIMPLIFY_H
+
+#include "intermediate.h"
+
+/*
+ * Vueltas máximas por función; cada una puede habilitar simplificaciones en
+ * la siguiente (un salto plegado deja inalcanzable un bloque, que deja sin
+ * referencias a una etiqueta, ...).
+ */
+#define CFG_SIMPLIFY_MAX_ROUNDS 8
+
+/*
+ * Simplificación del CFG: pliega saltos con condición constante, elimina
+ * bloques inalcanzables, encadena saltos a saltos y a bloques cuyo salto ya
+ * se conoce, elimina saltos al bloque siguiente y etiquetas sin saltos (que
+ * une cada bloque con el anterior).
+ */
+void optimize_cfg_simplification(IRList *list);
+
+#endif
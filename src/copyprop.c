@@ -0,0 +1,328 @@
+#include "copyprop.h"
+#include "optimizer.h"
+#include "dataflow.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Propagación y coalescencia de copias.
+ *
+ * Una copia es un LOAD x, t (de una variable o temporal a un temporal) o un
+ * STORE t, v (de un temporal a una variable). Con available copies (forward,
+ * intersección) se sabe en cada instrucción qué copias siguen valiendo: ni el
+ * origen ni el destino se redefinieron en ningún camino, tampoco en una
+ * llamada que puede escribir un global. Cada uso del destino de una copia
+ * disponible pasa a leer el origen, y las copias a temporales que quedan sin
+ * usos se eliminan.
+ *
+ * Un LOAD v, t sólo se propaga dentro de su bloque: reemplazar el temporal por
+ * la variable en otro bloque (por ejemplo, dentro de un loop cuando el LOAD se
+ * sacó al preheader) cambia lecturas de registro por lecturas de memoria.
+ *
+ * Las copias que siguen vivas se coalescen con la instrucción que calcula su
+ * origen cuando ese temporal no tiene otro uso: t1 = a + b; LOAD t1, t2 pasa a
+ * t2 = a + b, y t1 = a + b; STORE t1, v pasa a v = a + b.
+ */
+
+typedef struct {
+    int propagated;
+    int removed;
+    int coalesced;
+} CopyStats;
+
+typedef struct {
+    int instr;
+    int src;            // Símbolos del CFG
+    int dst;
+    IRSymbol *source;   // Origen al armar la copia: la propagación puede cambiar el operando
+} Copy;
+
+static bool is_temp(IRSymbol *sym) {
+    return sym && sym->name && sym->type == IR_SYM_TEMP;
+}
+
+static bool is_var(IRSymbol *sym) {
+    return sym && sym->name && sym->type == IR_SYM_VAR;
+}
+
+static bool is_copy(IRCode *code) {
+    if (code->op == IR_LOAD) {
+        return (is_temp(code->arg1) || is_var(code->arg1)) && is_temp(code->result) &&
+               strcmp(code->arg1->name, code->result->name) != 0;
+    }
+    return code->op == IR_STORE && is_temp(code->arg1) && is_var(code->result);
+}
+
+/*
+ * Operaciones cuyo resultado el backend puede escribir directo en una variable.
+ */
+static bool computes_into_var(IRInstr op) {
+    switch (op) {
+        case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_MOD:
+        case IR_UMINUS: case IR_AND: case IR_OR: case IR_NOT:
+        case IR_EQ: case IR_NEQ: case IR_LT: case IR_LE: case IR_GT: case IR_GE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * Quita de set (y agrega a kill, si no es NULL) las copias que leen o escriben
+ * sym, de a una palabra por vez.
+ */
+static void kill_copies(BitSet *set, BitSet *kill, BitSet *touch, int sym) {
+    if (!touch[sym].words) return;
+    bitset_difference_with(set, &touch[sym]);
+    if (kill) bitset_union_with(kill, &touch[sym]);
+}
+
+/*
+ * Efecto de la instrucción rel sobre las copias disponibles.
+ */
+static void transfer(CFG *cfg, int rel, int *copy_of, BitSet *touch, BitSet *set, BitSet *kill) {
+    int def = cfg->def_of[rel];
+    if (def >= 0) kill_copies(set, kill, touch, def);
+    if (cfg->list->codes[cfg->start + rel].op == IR_CALL) {
+        BitSet *mod = &cfg->call_mod[rel];
+        for (int g = bitset_next(mod, 0); g >= 0; g = bitset_next(mod, g + 1)) {
+            kill_copies(set, kill, touch, cfg->nonlocal_syms[g]);
+        }
+    }
+    if (copy_of[rel] >= 0) bitset_set(set, copy_of[rel]);
+}
+
+/*
+ * Las copias se numeran agrupadas por destino: las que escriben cada símbolo
+ * son el rango [dst_start[s], dst_start[s + 1]), y touch[s] (vacío si ninguna
+ * lo toca) tiene las que lo leen o escriben.
+ */
+static bool propagate_copies(CFG *cfg, CopyStats *stats) {
+    IRList *list = cfg->list;
+    int n = cfg->end - cfg->start;
+
+    int *copy_of = df_alloc(n, sizeof(int));
+    int *dst_start = df_alloc(cfg->num_syms + 1, sizeof(int));
+    int num_copies = 0;
+    for (int rel = 0; rel < n; rel++) {
+        IRCode *code = &list->codes[cfg->start + rel];
+        copy_of[rel] = -1;
+        if (!is_copy(code)) continue;
+        int src = cfg_sym_index(cfg, code->arg1->name);
+        int dst = cfg->def_of[rel];
+        if (src < 0 || dst < 0) continue;
+        copy_of[rel] = src;
+        dst_start[dst + 1]++;
+        num_copies++;
+    }
+    if (num_copies == 0) {
+        free(copy_of);
+        free(dst_start);
+        return false;
+    }
+    for (int s = 0; s < cfg->num_syms; s++) dst_start[s + 1] += dst_start[s];
+
+    Copy *copies = df_alloc(num_copies, sizeof(Copy));
+    BitSet *touch = df_alloc(cfg->num_syms, sizeof(BitSet));
+    int *fill = df_alloc(cfg->num_syms, sizeof(int));
+    for (int rel = 0; rel < n; rel++) {
+        if (copy_of[rel] < 0) continue;
+        int src = copy_of[rel], dst = cfg->def_of[rel];
+        int k = dst_start[dst] + fill[dst]++;
+        copies[k] = (Copy){cfg->start + rel, src, dst, list->codes[cfg->start + rel].arg1};
+        copy_of[rel] = k;
+        if (!touch[src].words) bitset_init(&touch[src], num_copies);
+        if (!touch[dst].words) bitset_init(&touch[dst], num_copies);
+        bitset_set(&touch[src], k);
+        bitset_set(&touch[dst], k);
+    }
+    free(fill);
+
+    DataflowProblem p;
+    dataflow_problem_init(&p, cfg, DF_FORWARD, DF_MEET_INTERSECT, num_copies);
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        for (int i = cfg->blocks[b].start; i < cfg->blocks[b].end; i++) {
+            transfer(cfg, i - cfg->start, copy_of, touch, &p.gen[b], &p.kill[b]);
+        }
+    }
+    dataflow_solve(&p, cfg);
+
+    bool changed = false;
+    BitSet avail;
+    bitset_init(&avail, num_copies);
+    for (int r = 0; r < cfg->num_reachable; r++) {
+        int b = cfg->rpo_order[r];
+        bitset_copy(&avail, &p.in[b]);
+        for (int i = cfg->blocks[b].start; i < cfg->blocks[b].end; i++) {
+            IRCode *code = &list->codes[i];
+            IRSymbol *uses[2];
+            int num_uses = ir_use_symbols(code, uses);
+            for (int u = 0; u < num_uses; u++) {
+                int sym = cfg_sym_index(cfg, uses[u]->name);
+                if (sym < 0 || (code->arg1 != uses[u] && code->arg2 != uses[u])) continue;
+                int last = dst_start[sym + 1];
+                for (int k = bitset_next_in(&avail, dst_start[sym], last); k >= 0; k = bitset_next_in(&avail, k + 1, last)) {
+                    Copy *copy = &copies[k];
+                    // Un LOAD de una variable sólo se propaga en su bloque, después de él
+                    if (is_var(copy->source) && (copy->instr < cfg->blocks[b].start || copy->instr > i)) continue;
+                    if (debug_mode) {
+                        printf("  [COPY] Línea %d: %s -> %s (copia de la línea %d)\n",
+                               i, uses[u]->name, copy->source->name, copy->instr);
+                    }
+                    if (code->arg1 == uses[u]) code->arg1 = copy->source;
+                    if (code->arg2 == uses[u]) code->arg2 = copy->source;
+                    stats->propagated++;
+                    changed = true;
+                    break;
+                }
+            }
+            transfer(cfg, i - cfg->start, copy_of, touch, &avail, NULL);
+        }
+    }
+    bitset_free(&avail);
+
+    dataflow_problem_free(&p);
+    for (int s = 0; s < cfg->num_syms; s++) {
+        if (touch[s].words) bitset_free(&touch[s]);
+    }
+    free(touch);
+    free(copies);
+    free(copy_of);
+    free(dst_start);
+    return changed;
+}
+
+/*
+ * Cuenta definiciones y usos de cada símbolo de la función.
+ */
+static void count_defs_uses(CFG *cfg, int *defs, int *uses) {
+    for (int i = cfg->start; i < cfg->end; i++) {
+        int rel = i - cfg->start;
+        if (cfg->def_of[rel] >= 0) defs[cfg->def_of[rel]]++;
+        IRSymbol *used[2];
+        int num_uses = ir_use_symbols(&cfg->list->codes[i], used);
+        for (int u = 0; u < num_uses; u++) {
+            int sym = cfg_sym_index(cfg, used[u]->name);
+            if (sym >= 0) uses[sym]++;
+        }
+    }
+}
+
+/*
+ * Elimina las copias a temporales sin usos y descuenta sus definiciones y
+ * usos, para que la coalescencia vea los contadores al día.
+ */
+static bool remove_dead_copies(CFG *cfg, int *defs, int *uses, CopyStats *stats) {
+    IRList *list = cfg->list;
+    bool changed = false;
+    for (int i = cfg->start; i < cfg->end; i++) {
+        IRCode *code = &list->codes[i];
+        if (code->op != IR_LOAD || !is_copy(code)) continue;
+        int dst = cfg->def_of[i - cfg->start];
+        if (dst < 0 || uses[dst] > 0) continue;
+        if (debug_mode) printf("  [COPY] Línea %d: copia a %s sin usos eliminada\n", i, code->result->name);
+        int src = cfg_sym_index(cfg, code->arg1->name);
+        if (src >= 0) uses[src]--;
+        defs[dst]--;
+        mark_instruction_as_nop(list, i);
+        stats->removed++;
+        changed = true;
+    }
+    return changed;
+}
+
+/*
+ * Instrucción del mismo bloque que define el origen de la copia en i, o -1 si
+ * entre las dos se lee o escribe el destino o si el destino es un global y hay
+ * una llamada en el medio.
+ */
+static int find_source_def(IRList *list, int start, int i) {
+    IRCode *copy = &list->codes[i];
+    bool global = ir_is_global(copy->result->name);
+    for (int j = i - 1; j > start; j--) {
+        IRCode *code = &list->codes[j];
+        if (ir_is_nop(code)) continue;
+        if (code->op == IR_LABEL || ir_is_terminator(code)) return -1;
+        if (global && code->op == IR_CALL) return -1;
+
+        IRSymbol *def = ir_def_symbol(code);
+        if (def && strcmp(def->name, copy->arg1->name) == 0) return j;
+        if (def && strcmp(def->name, copy->result->name) == 0) return -1;
+        IRSymbol *uses[2];
+        int num_uses = ir_use_symbols(code, uses);
+        for (int u = 0; u < num_uses; u++) {
+            if (strcmp(uses[u]->name, copy->result->name) == 0) return -1;
+        }
+    }
+    return -1;
+}
+
+static bool coalesce_copies(CFG *cfg, int *defs, int *uses, CopyStats *stats) {
+    IRList *list = cfg->list;
+    bool changed = false;
+    for (int i = cfg->start; i < cfg->end; i++) {
+        IRCode *code = &list->codes[i];
+        if (!is_copy(code) || !is_temp(code->arg1)) continue;
+        int src = cfg_sym_index(cfg, code->arg1->name);
+        if (src < 0 || defs[src] != 1 || uses[src] != 1) continue;
+
+        int d = find_source_def(list, cfg->start, i);
+        if (d < 0) continue;
+        IRCode *def = &list->codes[d];
+        if (def->op == IR_PARAM) continue;
+        if (code->op == IR_STORE && !(def->op == IR_LOAD && def->arg1) && !computes_into_var(def->op)) continue;
+
+        if (debug_mode) {
+            printf("  [COPY] Línea %d: %s se calcula directo en %s (copia de la línea %d)\n",
+                   d, code->arg1->name, code->result->name, i);
+        }
+        if (code->op == IR_STORE && def->op == IR_LOAD) {
+            replace_instruction(list, d, IR_STORE, def->arg1, NULL, code->result);
+        } else {
+            def->result = code->result;
+        }
+        mark_instruction_as_nop(list, i);
+        stats->coalesced++;
+        changed = true;
+    }
+    return changed;
+}
+
+/*
+ * Una vuelta sobre la función: la propagación sólo cambia operandos, así que
+ * las definiciones del CFG siguen valiendo para los dos pasos siguientes.
+ */
+static bool copy_round(IRList *list, int start, CopyStats *stats) {
+    CFG cfg;
+    cfg_build(&cfg, list, start);
+    bool changed = propagate_copies(&cfg, stats);
+
+    int *defs = df_alloc(cfg.num_syms, sizeof(int));
+    int *uses = df_alloc(cfg.num_syms, sizeof(int));
+    count_defs_uses(&cfg, defs, uses);
+    changed |= remove_dead_copies(&cfg, defs, uses, stats);
+    changed |= coalesce_copies(&cfg, defs, uses, stats);
+
+    free(defs);
+    free(uses);
+    cfg_free(&cfg);
+    return changed;
+}
+
+void optimize_copy_propagation(IRList *list) {
+    CopyStats stats = {0, 0, 0};
+    for (int i = 0; i < list->size; i++) {
+        if (list->codes[i].op != IR_METHOD) continue;
+        for (int round = 0; round < COPYPROP_MAX_ROUNDS; round++) {
+            if (!copy_round(list, i, &stats)) break;
+        }
+    }
+    compact_ir_list(list);
+
+    if (debug_mode && stats.propagated + stats.removed + stats.coalesced > 0) {
+        // Cada copia del IR es al menos un movq en el assembly
+        printf("✓ Propagación de copias: %d usos propagados, %d copias eliminadas, %d coalescidas (%d movq menos)\n",
+               stats.propagated, stats.removed, stats.coalesced, stats.removed + stats.coalesced);
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef COPYPROP_H
+#define COPYPROP_H
+
+#include "intermediate.h"
+
+/*
+ * Vueltas máximas por función: cada propagación puede dejar muertas copias
+ * que a su vez eran el origen de otras.
+ */
+#define COPYPROP_MAX_ROUNDS 4
+
+/*
+ * Propagación de copias global (LOAD x, t y STORE t, v) y coalescencia de las
+ * copias que quedan con la instrucción que calcula su origen.
+ */
+void optimize_copy_propagation(IRList *list);
+
+#endif
@@ -0,0 +1,1712 @@
+#include "dataflow.h"
+#include "callgraph.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/*
+ * Reserva memoria en cero o termina el programa con un error. La usan todos
+ * los pases del optimizador.
+ */
+void *df_alloc(size_t count, size_t size) {
+    void *ptr = calloc(count > 0 ? count : 1, size);
+    if (!ptr) {
+        fprintf(stderr, "Error: no se pudo asignar memoria para la optimización\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+/*
+ * Inicializa un conjunto de bits vacío con capacidad para num_bits elementos.
+ */
+void bitset_init(BitSet *set, int num_bits) {
+    set->num_bits = num_bits;
+    set->num_words = (num_bits + 63) / 64;
+    set->words = df_alloc(set->num_words, sizeof(uint64_t));
+}
+
+/*
+ * Libera la memoria del conjunto.
+ */
+void bitset_free(BitSet *set) {
+    free(set->words);
+    set->words = NULL;
+    set->num_bits = 0;
+    set->num_words = 0;
+}
+
+void bitset_clear_all(BitSet *set) {
+    memset(set->words, 0, set->num_words * sizeof(uint64_t));
+}
+
+/*
+ * Pone en 1 todos los bits válidos (los bits sobrantes de la última palabra quedan en 0).
+ */
+void bitset_set_all(BitSet *set) {
+    if (set->num_words == 0) return;
+    memset(set->words, 0xff, set->num_words * sizeof(uint64_t));
+    int rest = set->num_bits % 64;
+    if (rest != 0) {
+        set->words[set->num_words - 1] = (UINT64_C(1) << rest) - 1;
+    }
+}
+
+void bitset_set(BitSet *set, int bit) {
+    set->words[bit >> 6] |= UINT64_C(1) << (bit & 63);
+}
+
+void bitset_clear(BitSet *set, int bit) {
+    set->words[bit >> 6] &= ~(UINT64_C(1) << (bit & 63));
+}
+
+/*
+ * Pone en 1 (o en 0) los bits del rango [from, to), de a una palabra por vez.
+ */
+void bitset_set_range(BitSet *set, int from, int to) {
+    for (int w = from >> 6; from < to; w++) {
+        int hi = (w + 1) << 6 < to ? (w + 1) << 6 : to;
+        uint64_t mask = (hi - from == 64) ? ~UINT64_C(0) : ((UINT64_C(1) << (hi - from)) - 1) << (from & 63);
+        set->words[w] |= mask;
+        from = hi;
+    }
+}
+
+void bitset_clear_range(BitSet *set, int from, int to) {
+    for (int w = from >> 6; from < to; w++) {
+        int hi = (w + 1) << 6 < to ? (w + 1) << 6 : to;
+        uint64_t mask = (hi - from == 64) ? ~UINT64_C(0) : ((UINT64_C(1) << (hi - from)) - 1) << (from & 63);
+        set->words[w] &= ~mask;
+        from = hi;
+    }
+}
+
+bool bitset_test(const BitSet *set, int bit) {
+    return (set->words[bit >> 6] >> (bit & 63)) & 1;
+}
+
+void bitset_copy(BitSet *dst, const BitSet *src) {
+    memcpy(dst->words, src->words, src->num_words * sizeof(uint64_t));
+}
+
+/*
+ * dst = dst ∪ src. Devuelve true si dst cambió.
+ */
+bool bitset_union_with(BitSet *dst, const BitSet *src) {
+    uint64_t changed = 0;
+    for (int w = 0; w < dst->num_words; w++) {
+        uint64_t old = dst->words[w];
+        dst->words[w] = old | src->words[w];
+        changed |= old ^ dst->words[w];
+    }
+    return changed != 0;
+}
+
+/*
+ * dst = dst ∩ src. Devuelve true si dst cambió.
+ */
+bool bitset_intersect_with(BitSet *dst, const BitSet *src) {
+    uint64_t changed = 0;
+    for (int w = 0; w < dst->num_words; w++) {
+        uint64_t old = dst->words[w];
+        dst->words[w] = old & src->words[w];
+        changed |= old ^ dst->words[w];
+    }
+    return changed != 0;
+}
+
+/*
+ * dst = dst \ src. Devuelve true si dst cambió.
+ */
+bool bitset_difference_with(BitSet *dst, const BitSet *src) {
+    uint64_t changed = 0;
+    for (int w = 0; w < dst->num_words; w++) {
+        uint64_t old = dst->words[w];
+        dst->words[w] = old & ~src->words[w];
+        changed |= old ^ dst->words[w];
+    }
+    return changed != 0;
+}
+
+int bitset_count(const BitSet *set) {
+    int count = 0;
+    for (int w = 0; w < set->num_words; w++) {
+        count += __builtin_popcountll(set->words[w]);
+    }
+    return count;
+}
+
+/*
+ * Devuelve el primer bit en 1 a partir de 'from' (inclusive), o -1 si no hay.
+ */
+int bitset_next(const BitSet *set, int from) {
+    return bitset_next_in(set, from, set->num_bits);
+}
+
+/*
+ * Como bitset_next, pero sólo mira el rango [from, to).
+ */
+int bitset_next_in(const BitSet *set, int from, int to) {
+    if (from >= to) return -1;
+    int w = from >> 6;
+    int last = (to - 1) >> 6;
+    uint64_t word = set->words[w] & (~UINT64_C(0) << (from & 63));
+    while (1) {
+        if (word != 0) {
+            int bit = (w << 6) + __builtin_ctzll(word);
+            return bit < to ? bit : -1;
+        }
+        if (++w > last) return -1;
+        word = set->words[w];
+    }
+}
+
+/*
+ * Hash FNV-1a de un string.
+ */
+static unsigned int str_hash(const char *key) {
+    unsigned int hash = 2166136261u;
+    while (*key) {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void strmap_init(StrMap *map, int expected) {
+    map->capacity = 16;
+    while (map->capacity < expected * 2) {
+        map->capacity *= 2;
+    }
+    map->count = 0;
+    map->keys = df_alloc(map->capacity, sizeof(char *));
+    map->values = df_alloc(map->capacity, sizeof(int));
+}
+
+void strmap_free(StrMap *map) {
+    free(map->keys);
+    free(map->values);
+    map->keys = NULL;
+    map->values = NULL;
+    map->capacity = 0;
+    map->count = 0;
+}
+
+/*
+ * Busca una clave. Devuelve -1 si no existe.
+ */
+int strmap_get(StrMap *map, const char *key) {
+    unsigned int mask = map->capacity - 1;
+    unsigned int slot = str_hash(key) & mask;
+    while (map->keys[slot]) {
+        if (strcmp(map->keys[slot], key) == 0) {
+            return map->values[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+void strmap_put(StrMap *map, const char *key, int value) {
+    if ((map->count + 1) * 2 > map->capacity) {
+        const char **old_keys = map->keys;
+        int *old_values = map->values;
+        int old_capacity = map->capacity;
+        map->capacity *= 2;
+        map->count = 0;
+        map->keys = df_alloc(map->capacity, sizeof(char *));
+        map->values = df_alloc(map->capacity, sizeof(int));
+        for (int i = 0; i < old_capacity; i++) {
+            if (old_keys[i]) strmap_put(map, old_keys[i], old_values[i]);
+        }
+        free(old_keys);
+        free(old_values);
+    }
+
+    unsigned int mask = map->capacity - 1;
+    unsigned int slot = str_hash(key) & mask;
+    while (map->keys[slot]) {
+        if (strcmp(map->keys[slot], key) == 0) {
+            map->values[slot] = value;
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+    map->keys[slot] = key;
+    map->values[slot] = value;
+    map->count++;
+}
+
+/*
+ * Saltos condicionales: IF_FALSE/IF_TRUE y los fusionados con una comparación.
+ */
+bool ir_is_cond_branch(IRCode *code) {
+    return code->op == IR_IF_FALSE || code->op == IR_IF_TRUE || ir_is_compare_branch(code->op);
+}
+
+/*
+ * Instrucciones que terminan un bloque básico.
+ */
+bool ir_is_terminator(IRCode *code) {
+    return code->op == IR_GOTO || code->op == IR_RETURN || ir_is_cond_branch(code);
+}
+
+/*
+ * Las instrucciones eliminadas se marcan como LABEL sin etiqueta.
+ */
+bool ir_is_nop(IRCode *code) {
+    return code->op == IR_LABEL && code->result == NULL;
+}
+
+/*
+ * Salto condicional con la condición opuesta (IF_FALSE <-> IF_TRUE, IF_LT <-> IF_GE, ...).
+ */
+IRInstr negate_branch_op(IRInstr op) {
+    if (op == IR_IF_FALSE) return IR_IF_TRUE;
+    if (op == IR_IF_TRUE) return IR_IF_FALSE;
+    return ir_branch_for_compare(ir_compare_for_branch(op), 1);
+}
+
+/*
+ * Dos operandos son el mismo símbolo si tienen el mismo nombre; dos ausentes también.
+ */
+bool same_symbol(IRSymbol *a, IRSymbol *b) {
+    if (!a || !b) return a == b;
+    return strcmp(a->name, b->name) == 0;
+}
+
+static bool is_data_symbol(IRSymbol *sym) {
+    return sym && sym->name && (sym->type == IR_SYM_VAR || sym->type == IR_SYM_TEMP);
+}
+
+/*
+ * Devuelve el temporal o variable que define una instrucción, o NULL.
+ */
+IRSymbol *ir_def_symbol(IRCode *code) {
+    switch (code->op) {
+        case IR_LOAD:
+        case IR_STORE:
+        case IR_ADD:
+        case IR_SUB:
+        case IR_UMINUS:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_MOD:
+        case IR_AND:
+        case IR_OR:
+        case IR_NOT:
+        case IR_EQ:
+        case IR_NEQ:
+        case IR_LT:
+        case IR_LE:
+        case IR_GT:
+        case IR_GE:
+        case IR_CALL:
+        case IR_PARAM:
+        case IR_MEMO_LOOKUP:
+        case IR_MEMO_GET:
+            return is_data_symbol(code->result) ? code->result : NULL;
+        default:
+            return NULL;
+    }
+}
+
+/*
+ * Completa uses con los temporales y variables que lee la instrucción.
+ * Devuelve la cantidad de usos (0, 1 o 2).
+ */
+int ir_use_symbols(IRCode *code, IRSymbol *uses[2]) {
+    int count = 0;
+    switch (code->op) {
+        case IR_LOAD:
+        case IR_STORE:
+        case IR_UMINUS:
+        case IR_NOT:
+        case IR_IF_FALSE:
+        case IR_IF_TRUE:
+        case IR_RETURN:
+        case IR_CALL_PARAM:
+        case IR_MEMO_LOOKUP:
+        case IR_MEMO_GET:
+            if (is_data_symbol(code->arg1)) uses[count++] = code->arg1;
+            break;
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_MOD:
+        case IR_AND:
+        case IR_OR:
+        case IR_EQ:
+        case IR_NEQ:
+        case IR_LT:
+        case IR_LE:
+        case IR_GT:
+        case IR_GE:
+        case IR_IF_EQ:
+        case IR_IF_NEQ:
+        case IR_IF_LT:
+        case IR_IF_LE:
+        case IR_IF_GT:
+        case IR_IF_GE:
+        case IR_MEMO_STORE:
+            if (is_data_symbol(code->arg1)) uses[count++] = code->arg1;
+            if (is_data_symbol(code->arg2)) uses[count++] = code->arg2;
+            break;
+        default:
+            break;
+    }
+    return count;
+}
+
+/*
+ * Devuelve el índice siguiente a la última instrucción de la función que empieza en start.
+ */
+int ir_function_end(IRList *list, int start) {
+    int i = start + 1;
+    while (i < list->size && list->codes[i].op != IR_METHOD && list->codes[i].op != IR_EXTERN) {
+        i++;
+    }
+    return i;
+}
+
+/*
+ * Cantidad de parámetros de cada método, por nombre: la de un METHOD se cuenta
+ * en sus PARAM y la de un EXTERN en la tabla de símbolos. Las claves son los
+ * nombres de los símbolos de la lista.
+ */
+void ir_method_arities(IRList *list, StrMap *arities) {
+    strmap_init(arities, 16);
+    for (int i = 0; i < list->size; i++) {
+        IRCode *code = &list->codes[i];
+        if (!code->result) continue;
+        if (code->op == IR_METHOD) {
+            int count = 0;
+            while (i + 1 + count < list->size && list->codes[i + 1 + count].op == IR_PARAM) count++;
+            strmap_put(arities, code->result->name, count);
+        } else if (code->op == IR_EXTERN) {
+            SymbolTable *scope = get_function_scope(code->result->name);
+            if (!scope) continue;
+            int count = 0;
+            for (int s = 0; s < scope->num_symbols; s++) {
+                if (scope->symbols[s].is_param) count++;
+            }
+            strmap_put(arities, code->result->name, count);
+        }
+    }
+}
+
+/*
+ * Asocia cada CALL_PARAM de codes con el CALL que lo consume simulando la pila
+ * de argumentos pendientes: cada CALL saca tantos como parámetros tiene. Para
+ * los CALL_PARAM, call_of queda en el índice de su CALL, o en -1 si no se puede
+ * asegurar porque entre el argumento y la llamada hay una etiqueta o un salto,
+ * o porque una llamada intermedia es a un método de aridad desconocida.
+ */
+void ir_match_call_params(IRCode *codes, int count, StrMap *arities, int *call_of) {
+    int *pending = df_alloc(count, sizeof(int));
+    int num_pending = 0;
+    int first_ok = 0;   // Los pendientes por debajo de este índice cruzaron un salto
+
+    for (int i = 0; i < count; i++) {
+        IRCode *code = &codes[i];
+        call_of[i] = -1;
+        if (code->op == IR_CALL_PARAM) {
+            pending[num_pending++] = i;
+        } else if (code->op == IR_LABEL || code->op == IR_GOTO || code->op == IR_RETURN ||
+                   ir_is_cond_branch(code)) {
+            first_ok = num_pending;
+        } else if (code->op == IR_CALL && code->arg1) {
+            int arity = strmap_get(arities, code->arg1->name);
+            if (arity < 0 || arity > num_pending) {
+                num_pending = 0;
+                first_ok = 0;
+                continue;
+            }
+            num_pending -= arity;
+            for (int k = num_pending; k < num_pending + arity; k++) {
+                if (k >= first_ok) call_of[pending[k]] = i;
+            }
+            if (first_ok > num_pending) first_ok = num_pending;
+        }
+    }
+    free(pending);
+}
+
+/*
+ * Instrucciones que ejecuta el cuerpo de la función que empieza en start (sin
+ * METHOD, PARAM ni etiquetas).
+ */
+int ir_body_size(IRCode *codes, int start, int end) {
+    int size = 0;
+    for (int i = start + 1; i < end; i++) {
+        IRInstr op = codes[i].op;
+        if (op != IR_PARAM && op != IR_LABEL) size++;
+    }
+    return size;
+}
+
+/*
+ * Las constantes del IR son int: un valor calculado en compilación sólo se
+ * emite si entra.
+ */
+bool fits_int(long long value) {
+    return value >= INT_MIN && value <= INT_MAX;
+}
+
+/*
+ * max_syms acota la cantidad de símbolos distintos que se van a renombrar.
+ */
+void ir_renamer_init(IRRenamer *r, int max_syms, int instance) {
+    strmap_init(&r->map, max_syms);
+    r->syms = df_alloc(max_syms, sizeof(IRSymbol *));
+    r->count = 0;
+    r->instance = instance;
+}
+
+void ir_renamer_free(IRRenamer *r) {
+    free(r->syms);
+    strmap_free(&r->map);
+}
+
+/*
+ * Fija la copia de sym (por ejemplo, un parámetro del callee).
+ */
+void ir_renamer_bind(IRRenamer *r, IRSymbol *sym, IRSymbol *copy) {
+    strmap_put(&r->map, sym->name, r->count);
+    r->syms[r->count++] = copy;
+}
+
+/*
+ * Copia de un operando del cuerpo original; las constantes, las funciones y las
+ * globales se comparten.
+ */
+IRSymbol *ir_rename_operand(IRRenamer *r, IRSymbol *sym) {
+    if (!sym) return NULL;
+    if (sym->type != IR_SYM_TEMP && sym->type != IR_SYM_LABEL && sym->type != IR_SYM_VAR) return sym;
+    if (sym->type == IR_SYM_VAR && (r->instance < 0 || ir_is_global(sym->name))) return sym;
+
+    int index = strmap_get(&r->map, sym->name);
+    if (index >= 0) return r->syms[index];
+
+    IRSymbol *copy;
+    if (sym->type == IR_SYM_TEMP) {
+        copy = new_temp_symbol();
+    } else if (sym->type == IR_SYM_LABEL) {
+        copy = new_label_symbol();
+    } else {
+        char name[256];
+        snprintf(name, sizeof(name), "%s.%d", sym->name, r->instance);
+        copy = new_var_symbol(name);
+    }
+    copy->data_type = sym->data_type;
+    ir_renamer_bind(r, sym, copy);
+    return copy;
+}
+
+static int intern_symbol(CFG *cfg, IRSymbol *sym, int *capacity) {
+    int index = strmap_get(&cfg->sym_map, sym->name);
+    if (index >= 0) return index;
+
+    if (cfg->num_syms >= *capacity) {
+        *capacity *= 2;
+        cfg->sym_names = realloc(cfg->sym_names, *capacity * sizeof(char *));
+        if (!cfg->sym_names) {
+            fprintf(stderr, "Error: no se pudo redimensionar la tabla de símbolos del CFG\n");
+            exit(1);
+        }
+    }
+    index = cfg->num_syms++;
+    cfg->sym_names[index] = sym->name;
+    strmap_put(&cfg->sym_map, sym->name, index);
+    return index;
+}
+
+/*
+ * Construye el CFG de la función cuya instrucción METHOD está en start:
+ * bloques básicos, aristas, orden RPO y numeración de símbolos.
+ */
+void cfg_build(CFG *cfg, IRList *list, int start) {
+    cfg->list = list;
+    cfg->start = start;
+    cfg->end = ir_function_end(list, start);
+    int n = cfg->end - start;
+
+    // Líderes: la primera instrucción, cada etiqueta y lo que sigue a un salto
+    bool *leader = df_alloc(n + 1, sizeof(bool));
+    leader[0] = true;
+    for (int i = 0; i < n; i++) {
+        IRCode *code = &list->codes[start + i];
+        if (code->op == IR_LABEL && code->result) leader[i] = true;
+        if (ir_is_terminator(code)) leader[i + 1] = true;
+    }
+
+    cfg->num_blocks = 0;
+    for (int i = 0; i < n; i++) {
+        if (leader[i]) cfg->num_blocks++;
+    }
+    cfg->blocks = df_alloc(cfg->num_blocks, sizeof(BasicBlock));
+    cfg->block_of = df_alloc(n, sizeof(int));
+
+    int b = -1;
+    for (int i = 0; i < n; i++) {
+        if (leader[i]) {
+            b++;
+            cfg->blocks[b].start = start + i;
+            cfg->blocks[b].rpo = -1;
+        }
+        cfg->blocks[b].end = start + i + 1;
+        cfg->block_of[i] = b;
+    }
+    free(leader);
+
+    // Etiqueta -> bloque
+    StrMap labels;
+    strmap_init(&labels, cfg->num_blocks);
+    for (b = 0; b < cfg->num_blocks; b++) {
+        IRCode *first = &list->codes[cfg->blocks[b].start];
+        if (first->op == IR_LABEL && first->result) {
+            strmap_put(&labels, first->result->name, b);
+        }
+    }
+
+    // Sucesores
+    int *pred_count = df_alloc(cfg->num_blocks, sizeof(int));
+    for (b = 0; b < cfg->num_blocks; b++) {
+        BasicBlock *block = &cfg->blocks[b];
+        IRCode *last = &list->codes[block->end - 1];
+        int target = -1;
+        bool falls_through = true;
+
+        if (last->op == IR_GOTO || ir_is_cond_branch(last)) {
+            if (last->result) target = strmap_get(&labels, last->result->name);
+            falls_through = last->op != IR_GOTO;
+        } else if (last->op == IR_RETURN) {
+            falls_through = false;
+        }
+
+        block->num_succs = 0;
+        if (falls_through && b + 1 < cfg->num_blocks) {
+            block->succs[block->num_succs++] = b + 1;
+        }
+        if (target >= 0 && (block->num_succs == 0 || block->succs[0] != target)) {
+            block->succs[block->num_succs++] = target;
+        }
+        for (int s = 0; s < block->num_succs; s++) {
+            pred_count[block->succs[s]]++;
+        }
+    }
+    strmap_free(&labels);
+
+    // Predecesores
+    for (b = 0; b < cfg->num_blocks; b++) {
+        cfg->blocks[b].preds = df_alloc(pred_count[b], sizeof(int));
+        cfg->blocks[b].num_preds = 0;
+    }
+    for (b = 0; b < cfg->num_blocks; b++) {
+        for (int s = 0; s < cfg->blocks[b].num_succs; s++) {
+            BasicBlock *succ = &cfg->blocks[cfg->blocks[b].succs[s]];
+            succ->preds[succ->num_preds++] = b;
+        }
+    }
+    free(pred_count);
+
+    // Orden RPO mediante DFS iterativo desde el bloque de entrada
+    cfg->rpo_order = df_alloc(cfg->num_blocks, sizeof(int));
+    int *stack = df_alloc(cfg->num_blocks, sizeof(int));
+    int *next_succ = df_alloc(cfg->num_blocks, sizeof(int));
+    bool *visited = df_alloc(cfg->num_blocks, sizeof(bool));
+    int sp = 0;
+    int post = cfg->num_blocks;
+
+    if (cfg->num_blocks > 0) {
+        stack[sp++] = 0;
+        visited[0] = true;
+    }
+    while (sp > 0) {
+        int top = stack[sp - 1];
+        BasicBlock *block = &cfg->blocks[top];
+        if (next_succ[top] < block->num_succs) {
+            int succ = block->succs[next_succ[top]++];
+            if (!visited[succ]) {
+                visited[succ] = true;
+                stack[sp++] = succ;
+            }
+        } else {
+            cfg->rpo_order[--post] = top;
+            sp--;
+        }
+    }
+    // Compactar: los bloques alcanzables quedaron al final del arreglo
+    cfg->num_reachable = cfg->num_blocks - post;
+    memmove(cfg->rpo_order, cfg->rpo_order + post, cfg->num_reachable * sizeof(int));
+    for (int i = 0; i < cfg->num_reachable; i++) {
+        cfg->blocks[cfg->rpo_order[i]].rpo = i;
+    }
+    free(stack);
+    free(next_succ);
+    free(visited);
+
+    // Numeración de símbolos y usos/definiciones por instrucción
+    int sym_capacity = 64;
+    cfg->num_syms = 0;
+    cfg->sym_names = df_alloc(sym_capacity, sizeof(char *));
+    strmap_init(&cfg->sym_map, n);
+    cfg->def_of = df_alloc(n, sizeof(int));
+    cfg->use_of = df_alloc(2 * n, sizeof(int));
+
+    for (int i = 0; i < n; i++) {
+        IRCode *code = &list->codes[start + i];
+        IRSymbol *uses[2];
+        int num_uses = ir_use_symbols(code, uses);
+        cfg->use_of[2 * i] = -1;
+        cfg->use_of[2 * i + 1] = -1;
+        for (int u = 0; u < num_uses; u++) {
+            int slot = (u == 0 && uses[u] == code->arg1) ? 0 : 1;
+            cfg->use_of[2 * i + slot] = intern_symbol(cfg, uses[u], &sym_capacity);
+        }
+
+        IRSymbol *def = ir_def_symbol(code);
+        cfg->def_of[i] = def ? intern_symbol(cfg, def, &sym_capacity) : -1;
+    }
+
+    // Símbolos no locales: globales o leídos en un bloque antes de definirse en él
+    int *last_def_block = df_alloc(cfg->num_syms, sizeof(int));
+    bool *nonlocal = df_alloc(cfg->num_syms, sizeof(bool));
+    for (int sym = 0; sym < cfg->num_syms; sym++) {
+        last_def_block[sym] = -1;
+        nonlocal[sym] = ir_is_global(cfg->sym_names[sym]);
+    }
+    for (b = 0; b < cfg->num_blocks; b++) {
+        for (int i = cfg->blocks[b].start; i < cfg->blocks[b].end; i++) {
+            int rel = i - start;
+            for (int u = 0; u < 2; u++) {
+                int use = cfg->use_of[2 * rel + u];
+                if (use >= 0 && last_def_block[use] != b) nonlocal[use] = true;
+            }
+            if (cfg->def_of[rel] >= 0) last_def_block[cfg->def_of[rel]] = b;
+        }
+    }
+
+    cfg->sym_bit = df_alloc(cfg->num_syms, sizeof(int));
+    cfg->nonlocal_syms = df_alloc(cfg->num_syms, sizeof(int));
+    cfg->num_nonlocal = 0;
+    for (int sym = 0; sym < cfg->num_syms; sym++) {
+        if (nonlocal[sym]) {
+            cfg->sym_bit[sym] = cfg->num_nonlocal;
+            cfg->nonlocal_syms[cfg->num_nonlocal++] = sym;
+        } else {
+            cfg->sym_bit[sym] = -1;
+        }
+    }
+
+    bitset_init(&cfg->globals, cfg->num_nonlocal);
+    for (int bit = 0; bit < cfg->num_nonlocal; bit++) {
+        if (ir_is_global(cfg->sym_names[cfg->nonlocal_syms[bit]])) {
+            bitset_set(&cfg->globals, bit);
+        }
+    }
+
+    // Globales que puede leer o escribir cada CALL, según el grafo de llamadas
+    cfg->call_mod = df_alloc(n, sizeof(BitSet));
+    cfg->call_ref = df_alloc(n, sizeof(BitSet));
+    for (int i = 0; i < n; i++) {
+        IRCode *code = &list->codes[start + i];
+        if (code->op != IR_CALL) continue;
+        const char *callee = code->arg1 ? code->arg1->name : NULL;
+        bitset_init(&cfg->call_mod[i], cfg->num_nonlocal);
+        bitset_init(&cfg->call_ref[i], cfg->num_nonlocal);
+        for (int bit = bitset_next(&cfg->globals, 0); bit >= 0; bit = bitset_next(&cfg->globals, bit + 1)) {
+            const char *global = cfg->sym_names[cfg->nonlocal_syms[bit]];
+            if (callgraph_may_write(callee, global)) bitset_set(&cfg->call_mod[i], bit);
+            if (callgraph_may_read(callee, global)) bitset_set(&cfg->call_ref[i], bit);
+        }
+    }
+    free(last_def_block);
+    free(nonlocal);
+}
+
+void cfg_free(CFG *cfg) {
+    for (int i = 0; i < cfg->end - cfg->start; i++) {
+        bitset_free(&cfg->call_mod[i]);
+        bitset_free(&cfg->call_ref[i]);
+    }
+    free(cfg->call_mod);
+    free(cfg->call_ref);
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        free(cfg->blocks[b].preds);
+    }
+    free(cfg->blocks);
+    free(cfg->rpo_order);
+    free(cfg->block_of);
+    free(cfg->sym_names);
+    free(cfg->def_of);
+    free(cfg->use_of);
+    free(cfg->sym_bit);
+    free(cfg->nonlocal_syms);
+    strmap_free(&cfg->sym_map);
+    bitset_free(&cfg->globals);
+    memset(cfg, 0, sizeof(CFG));
+}
+
+int cfg_sym_index(CFG *cfg, const char *name) {
+    return strmap_get(&cfg->sym_map, name);
+}
+
+/*
+ * Comienzo del código de nivel superior que quedó al final del rango de la
+ * función: los bloques inalcanzables que siguen al último alcanzable, si alguno
+ * escribe una global (la inicialización de una global escrita después del
+ * método). Si no hay tal cola devuelve cfg->end.
+ */
+int cfg_top_level_start(CFG *cfg) {
+    int b = cfg->num_blocks;
+    while (b > 0 && cfg->blocks[b - 1].rpo < 0) b--;
+    if (b == cfg->num_blocks) return cfg->end;
+    int tail = cfg->blocks[b].start;
+    for (int i = tail; i < cfg->end; i++) {
+        IRCode *code = &cfg->list->codes[i];
+        if (code->op == IR_STORE && code->result && ir_is_global(code->result->name)) return tail;
+    }
+    return cfg->end;
+}
+
+/*
+ * Reserva los conjuntos gen/kill/in/out de cada bloque y la frontera (vacía).
+ */
+void dataflow_problem_init(DataflowProblem *p, CFG *cfg, DFDirection direction,
+                           DFMeet meet, int num_bits) {
+    p->direction = direction;
+    p->meet = meet;
+    p->num_bits = num_bits;
+    p->num_blocks = cfg->num_blocks;
+    p->visits = 0;
+    p->gen = df_alloc(cfg->num_blocks, sizeof(BitSet));
+    p->kill = df_alloc(cfg->num_blocks, sizeof(BitSet));
+    p->in = df_alloc(cfg->num_blocks, sizeof(BitSet));
+    p->out = df_alloc(cfg->num_blocks, sizeof(BitSet));
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        bitset_init(&p->gen[b], num_bits);
+        bitset_init(&p->kill[b], num_bits);
+        bitset_init(&p->in[b], num_bits);
+        bitset_init(&p->out[b], num_bits);
+    }
+    bitset_init(&p->boundary, num_bits);
+}
+
+void dataflow_problem_free(DataflowProblem *p) {
+    for (int b = 0; b < p->num_blocks; b++) {
+        bitset_free(&p->gen[b]);
+        bitset_free(&p->kill[b]);
+        bitset_free(&p->in[b]);
+        bitset_free(&p->out[b]);
+    }
+    free(p->gen);
+    free(p->kill);
+    free(p->in);
+    free(p->out);
+    bitset_free(&p->boundary);
+    p->gen = p->kill = p->in = p->out = NULL;
+    p->num_blocks = 0;
+}
+
+/*
+ * Solver de worklist. Los bloques pendientes se guardan en un bitset indexado por
+ * posición RPO (inversa para problemas backward) y se recorren en barridos en ese
+ * orden, de modo que casi todos los bloques ven a sus predecesores ya actualizados.
+ * Los bloques inalcanzables conservan el valor inicial.
+ */
+void dataflow_solve(DataflowProblem *p, CFG *cfg) {
+    int n = cfg->num_reachable;
+    bool forward = p->direction == DF_FORWARD;
+
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        if (p->meet == DF_MEET_INTERSECT) {
+            bitset_set_all(&p->in[b]);
+            bitset_set_all(&p->out[b]);
+        } else {
+            bitset_clear_all(&p->in[b]);
+            bitset_clear_all(&p->out[b]);
+        }
+    }
+
+    BitSet pending;
+    bitset_init(&pending, n);
+    bitset_set_all(&pending);
+    int cursor = 0;
+
+    while (1) {
+        int pos = bitset_next(&pending, cursor);
+        if (pos < 0) {
+            pos = bitset_next(&pending, 0);
+            if (pos < 0) break;
+        }
+        bitset_clear(&pending, pos);
+        cursor = pos + 1;
+        p->visits++;
+
+        int b = cfg->rpo_order[forward ? pos : n - 1 - pos];
+        BasicBlock *block = &cfg->blocks[b];
+        BitSet *meet_set = forward ? &p->in[b] : &p->out[b];
+        BitSet *result = forward ? &p->out[b] : &p->in[b];
+        int num_edges = forward ? block->num_preds : block->num_succs;
+
+        // Confluencia
+        if ((forward && b == 0) || (!forward && num_edges == 0)) {
+            bitset_copy(meet_set, &p->boundary);
+        } else {
+            if (p->meet == DF_MEET_INTERSECT) {
+                bitset_set_all(meet_set);
+            } else {
+                bitset_clear_all(meet_set);
+            }
+            for (int e = 0; e < num_edges; e++) {
+                int other = forward ? block->preds[e] : block->succs[e];
+                if (cfg->blocks[other].rpo < 0) continue;
+                BitSet *value = forward ? &p->out[other] : &p->in[other];
+                if (p->meet == DF_MEET_INTERSECT) {
+                    bitset_intersect_with(meet_set, value);
+                } else {
+                    bitset_union_with(meet_set, value);
+                }
+            }
+        }
+
+        // Transferencia: result = gen ∪ (meet - kill)
+        uint64_t changed = 0;
+        uint64_t *gen = p->gen[b].words;
+        uint64_t *kill = p->kill[b].words;
+        uint64_t *in = meet_set->words;
+        uint64_t *out = result->words;
+        for (int w = 0; w < result->num_words; w++) {
+            uint64_t value = gen[w] | (in[w] & ~kill[w]);
+            changed |= value ^ out[w];
+            out[w] = value;
+        }
+
+        if (changed) {
+            int num_next = forward ? block->num_succs : block->num_preds;
+            for (int e = 0; e < num_next; e++) {
+                int other = forward ? block->succs[e] : block->preds[e];
+                int rpo = cfg->blocks[other].rpo;
+                if (rpo < 0) continue;
+                bitset_set(&pending, forward ? rpo : n - 1 - rpo);
+            }
+        }
+    }
+
+    bitset_free(&pending);
+}
+
+/*
+ * Variables vivas (backward, unión). Los globales se consideran vivos al salir
+ * de la función y son leídos por cualquier CALL.
+ */
+void liveness_compute(DataflowProblem *p, CFG *cfg) {
+    dataflow_problem_init(p, cfg, DF_BACKWARD, DF_MEET_UNION, cfg->num_nonlocal);
+
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        BasicBlock *block = &cfg->blocks[b];
+        BitSet *gen = &p->gen[b];
+        BitSet *kill = &p->kill[b];
+
+        for (int i = block->end - 1; i >= block->start; i--) {
+            int rel = i - cfg->start;
+            int def = cfg->def_of[rel];
+            if (def >= 0 && cfg->sym_bit[def] >= 0) {
+                bitset_set(kill, cfg->sym_bit[def]);
+                bitset_clear(gen, cfg->sym_bit[def]);
+            }
+            if (cfg->list->codes[i].op == IR_CALL) {
+                bitset_union_with(gen, &cfg->call_ref[rel]);
+            }
+            for (int u = 0; u < 2; u++) {
+                int use = cfg->use_of[2 * rel + u];
+                if (use >= 0 && cfg->sym_bit[use] >= 0) bitset_set(gen, cfg->sym_bit[use]);
+            }
+        }
+    }
+
+    bitset_copy(&p->boundary, &cfg->globals);
+    dataflow_solve(p, cfg);
+}
+
+/*
+ * Consulta si un símbolo está vivo al entrar/salir de un bloque.
+ * Los símbolos locales a un bloque nunca lo están.
+ */
+bool liveness_live_in(DataflowProblem *p, CFG *cfg, int block, int sym) {
+    return cfg->sym_bit[sym] >= 0 && bitset_test(&p->in[block], cfg->sym_bit[sym]);
+}
+
+bool liveness_live_out(DataflowProblem *p, CFG *cfg, int block, int sym) {
+    return cfg->sym_bit[sym] >= 0 && bitset_test(&p->out[block], cfg->sym_bit[sym]);
+}
+
+static void add_definition(ReachingDefs *rd, int *capacity, int instr, int sym) {
+    if (rd->num_defs >= *capacity) {
+        *capacity *= 2;
+        rd->defs = realloc(rd->defs, *capacity * sizeof(Definition));
+        if (!rd->defs) {
+            fprintf(stderr, "Error: no se pudo redimensionar la tabla de definiciones\n");
+            exit(1);
+        }
+    }
+    rd->defs[rd->num_defs].instr = instr;
+    rd->defs[rd->num_defs].sym = sym;
+    rd->num_defs++;
+}
+
+/*
+ * Reaching definitions (forward, unión). Cada variable tiene una definición de
+ * entrada (instr == -1). Un CALL agrega una definición posible de cada global,
+ * que no mata a las anteriores.
+ * Las definiciones se numeran agrupadas por símbolo: las de cada uno ocupan un
+ * rango contiguo de bits, y una definición segura lo mata palabra por palabra.
+ */
+void reaching_defs_compute(ReachingDefs *rd, CFG *cfg) {
+    int n = cfg->end - cfg->start;
+    int capacity = 64;
+    rd->defs = df_alloc(capacity, sizeof(Definition));
+    rd->num_defs = 0;
+    rd->instr_def_start = df_alloc(n + 1, sizeof(int));
+
+    // Variables no locales, que reciben una definición de entrada
+    bool *is_var = df_alloc(cfg->num_syms, sizeof(bool));
+    for (int i = 0; i < n; i++) {
+        IRCode *code = &cfg->list->codes[cfg->start + i];
+        if (cfg->use_of[2 * i] >= 0 && code->arg1->type == IR_SYM_VAR) {
+            is_var[cfg->use_of[2 * i]] = true;
+        }
+        if (cfg->use_of[2 * i + 1] >= 0 && code->arg2->type == IR_SYM_VAR) {
+            is_var[cfg->use_of[2 * i + 1]] = true;
+        }
+        IRSymbol *def = ir_def_symbol(code);
+        if (def && def->type == IR_SYM_VAR) is_var[cfg->def_of[i]] = true;
+    }
+
+    // Definiciones de entrada
+    for (int s = 0; s < cfg->num_syms; s++) {
+        if (is_var[s] && cfg->sym_bit[s] >= 0) add_definition(rd, &capacity, -1, s);
+    }
+
+    for (int i = 0; i < n; i++) {
+        rd->instr_def_start[i] = rd->num_defs;
+        if (cfg->def_of[i] >= 0 && cfg->sym_bit[cfg->def_of[i]] >= 0) {
+            add_definition(rd, &capacity, cfg->start + i, cfg->def_of[i]);
+        }
+        if (cfg->list->codes[cfg->start + i].op == IR_CALL) {
+            BitSet *mod = &cfg->call_mod[i];
+            for (int g = bitset_next(mod, 0); g >= 0; g = bitset_next(mod, g + 1)) {
+                add_definition(rd, &capacity, cfg->start + i, cfg->nonlocal_syms[g]);
+            }
+        }
+    }
+    rd->instr_def_start[n] = rd->num_defs;
+    free(is_var);
+
+    // Renumerar agrupando por símbolo (estable: las de entrada primero, después en orden)
+    rd->sym_def_start = df_alloc(cfg->num_syms + 1, sizeof(int));
+    for (int d = 0; d < rd->num_defs; d++) {
+        rd->sym_def_start[rd->defs[d].sym + 1]++;
+    }
+    for (int s = 0; s < cfg->num_syms; s++) {
+        rd->sym_def_start[s + 1] += rd->sym_def_start[s];
+    }
+    Definition *sorted = df_alloc(rd->num_defs, sizeof(Definition));
+    rd->instr_defs = df_alloc(rd->num_defs, sizeof(int));
+    int *fill = df_alloc(cfg->num_syms, sizeof(int));
+    for (int d = 0; d < rd->num_defs; d++) {
+        int s = rd->defs[d].sym;
+        int id = rd->sym_def_start[s] + fill[s]++;
+        sorted[id] = rd->defs[d];
+        rd->instr_defs[d] = id;
+    }
+    free(fill);
+    free(rd->defs);
+    rd->defs = sorted;
+
+    DataflowProblem *p = &rd->problem;
+    dataflow_problem_init(p, cfg, DF_FORWARD, DF_MEET_UNION, rd->num_defs);
+
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        BasicBlock *block = &cfg->blocks[b];
+        for (int i = block->start; i < block->end; i++) {
+            int rel = i - cfg->start;
+            for (int k = rd->instr_def_start[rel]; k < rd->instr_def_start[rel + 1]; k++) {
+                int d = rd->instr_defs[k];
+                int s = rd->defs[d].sym;
+                bool must = cfg->def_of[rel] == s && k == rd->instr_def_start[rel];
+                if (must) {
+                    bitset_set_range(&p->kill[b], rd->sym_def_start[s], rd->sym_def_start[s + 1]);
+                    bitset_clear_range(&p->gen[b], rd->sym_def_start[s], rd->sym_def_start[s + 1]);
+                }
+                bitset_set(&p->gen[b], d);
+            }
+        }
+    }
+
+    for (int d = 0; d < rd->num_defs; d++) {
+        if (rd->defs[d].instr == -1) bitset_set(&p->boundary, d);
+    }
+    dataflow_solve(p, cfg);
+}
+
+void reaching_defs_free(ReachingDefs *rd) {
+    dataflow_problem_free(&rd->problem);
+    free(rd->defs);
+    free(rd->instr_def_start);
+    free(rd->instr_defs);
+    free(rd->sym_def_start);
+    rd->defs = NULL;
+    rd->num_defs = 0;
+}
+
+static bool is_expression_op(IRInstr op) {
+    switch (op) {
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_MOD:
+        case IR_AND:
+        case IR_OR:
+        case IR_EQ:
+        case IR_NEQ:
+        case IR_LT:
+        case IR_LE:
+        case IR_GT:
+        case IR_GE:
+        case IR_NOT:
+        case IR_UMINUS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void expression_operand(CFG *cfg, IRSymbol *sym, int *kind, int *val) {
+    if (!sym) {
+        *kind = 2;
+        *val = 0;
+    } else if (sym->type == IR_SYM_CONST) {
+        *kind = 1;
+        *val = sym->value.int_val;
+    } else {
+        *kind = 0;
+        *val = cfg_sym_index(cfg, sym->name);
+    }
+}
+
+static unsigned int expression_hash(const Expression *e) {
+    unsigned int hash = (unsigned int)e->op * 2654435761u;
+    hash = (hash ^ (unsigned int)(e->kind1 * 31 + e->val1)) * 16777619u;
+    hash = (hash ^ (unsigned int)(e->kind2 * 31 + e->val2)) * 16777619u;
+    return hash;
+}
+
+/*
+ * Available expressions (forward, intersección). Una expresión deja de estar
+ * disponible cuando se redefine alguno de sus operandos; un CALL mata las que
+ * leen globales.
+ */
+void available_exprs_compute(AvailableExprs *ae, CFG *cfg) {
+    int n = cfg->end - cfg->start;
+    ae->instr_expr = df_alloc(n, sizeof(int));
+    ae->exprs = df_alloc(n, sizeof(Expression));
+    ae->num_exprs = 0;
+
+    int table_size = 16;
+    while (table_size < n * 2) table_size *= 2;
+    int *table = df_alloc(table_size, sizeof(int));
+    memset(table, -1, table_size * sizeof(int));
+
+    for (int i = 0; i < n; i++) {
+        IRCode *code = &cfg->list->codes[cfg->start + i];
+        ae->instr_expr[i] = -1;
+        if (!is_expression_op(code->op) || !code->result) continue;
+
+        Expression e;
+        e.op = code->op;
+        expression_operand(cfg, code->arg1, &e.kind1, &e.val1);
+        expression_operand(cfg, code->arg2, &e.kind2, &e.val2);
+        if ((e.kind1 == 0 && cfg->sym_bit[e.val1] < 0) || (e.kind2 == 0 && cfg->sym_bit[e.val2] < 0)) {
+            continue;
+        }
+
+        unsigned int slot = expression_hash(&e) & (table_size - 1);
+        while (table[slot] >= 0) {
+            Expression *other = &ae->exprs[table[slot]];
+            if (other->op == e.op && other->kind1 == e.kind1 && other->val1 == e.val1 &&
+                other->kind2 == e.kind2 && other->val2 == e.val2) {
+                break;
+            }
+            slot = (slot + 1) & (table_size - 1);
+        }
+        if (table[slot] < 0) {
+            table[slot] = ae->num_exprs;
+            ae->exprs[ae->num_exprs++] = e;
+        }
+        ae->instr_expr[i] = table[slot];
+    }
+    free(table);
+
+    // Expresiones que usan cada símbolo (formato CSR)
+    int *start = df_alloc(cfg->num_syms + 1, sizeof(int));
+    for (int e = 0; e < ae->num_exprs; e++) {
+        if (ae->exprs[e].kind1 == 0) start[ae->exprs[e].val1 + 1]++;
+        if (ae->exprs[e].kind2 == 0 && !(ae->exprs[e].kind1 == 0 && ae->exprs[e].val1 == ae->exprs[e].val2)) {
+            start[ae->exprs[e].val2 + 1]++;
+        }
+    }
+    for (int s = 0; s < cfg->num_syms; s++) {
+        start[s + 1] += start[s];
+    }
+    int *users = df_alloc(start[cfg->num_syms], sizeof(int));
+    int *fill = df_alloc(cfg->num_syms, sizeof(int));
+    for (int e = 0; e < ae->num_exprs; e++) {
+        if (ae->exprs[e].kind1 == 0) {
+            int s = ae->exprs[e].val1;
+            users[start[s] + fill[s]++] = e;
+        }
+        if (ae->exprs[e].kind2 == 0 && !(ae->exprs[e].kind1 == 0 && ae->exprs[e].val1 == ae->exprs[e].val2)) {
+            int s = ae->exprs[e].val2;
+            users[start[s] + fill[s]++] = e;
+        }
+    }
+    free(fill);
+
+    DataflowProblem *p = &ae->problem;
+    dataflow_problem_init(p, cfg, DF_FORWARD, DF_MEET_INTERSECT, ae->num_exprs);
+
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        BasicBlock *block = &cfg->blocks[b];
+        for (int i = block->start; i < block->end; i++) {
+            int rel = i - cfg->start;
+            if (ae->instr_expr[rel] >= 0) {
+                bitset_set(&p->gen[b], ae->instr_expr[rel]);
+            }
+
+            int def = cfg->def_of[rel];
+            if (def >= 0) {
+                for (int k = start[def]; k < start[def + 1]; k++) {
+                    bitset_clear(&p->gen[b], users[k]);
+                    bitset_set(&p->kill[b], users[k]);
+                }
+            }
+            if (cfg->list->codes[i].op == IR_CALL) {
+                BitSet *mod = &cfg->call_mod[rel];
+                for (int g = bitset_next(mod, 0); g >= 0; g = bitset_next(mod, g + 1)) {
+                    int sym = cfg->nonlocal_syms[g];
+                    for (int k = start[sym]; k < start[sym + 1]; k++) {
+                        bitset_clear(&p->gen[b], users[k]);
+                        bitset_set(&p->kill[b], users[k]);
+                    }
+                }
+            }
+        }
+    }
+    free(start);
+    free(users);
+
+    dataflow_solve(p, cfg);
+}
+
+void available_exprs_free(AvailableExprs *ae) {
+    dataflow_problem_free(&ae->problem);
+    free(ae->exprs);
+    free(ae->instr_expr);
+    ae->exprs = NULL;
+    ae->num_exprs = 0;
+}
+
+static void push_int(int **array, int *size, int *capacity, int value) {
+    if (*size >= *capacity) {
+        *capacity = (*capacity == 0) ? 64 : *capacity * 2;
+        *array = realloc(*array, *capacity * sizeof(int));
+        if (!*array) {
+            fprintf(stderr, "Error: no se pudo redimensionar las cadenas def-use\n");
+            exit(1);
+        }
+    }
+    (*array)[(*size)++] = value;
+}
+
+/*
+ * Construye las cadenas use-def y def-use de la función en O(n + tamaño de las cadenas).
+ * Dentro de un bloque basta con recordar la última definición de cada símbolo; sólo
+ * los usos expuestos a la entrada del bloque consultan reaching definitions.
+ * Las llamadas son definiciones posibles de los globales: se suman a las anteriores.
+ */
+void defuse_build(DefUseChains *du, CFG *cfg) {
+    int n = cfg->end - cfg->start;
+    du->num_instrs = n;
+    du->use_start = df_alloc(2 * n + 1, sizeof(int));
+    du->use_defs = NULL;
+    int num_links = 0;
+    int links_capacity = 0;
+
+    ReachingDefs rd;
+    reaching_defs_compute(&rd, cfg);
+
+    int *seen = df_alloc(cfg->num_syms, sizeof(int));       // bloque + 1 de la última def vista
+    int *cur_def = df_alloc(cfg->num_syms, sizeof(int));
+    int *call_mark = df_alloc(cfg->num_syms, sizeof(int));
+    int *calls = df_alloc(n, sizeof(int));
+
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        BasicBlock *block = &cfg->blocks[b];
+        BitSet *reach = &rd.problem.in[b];
+        int num_calls = 0;
+
+        for (int i = block->start; i < block->end; i++) {
+            int rel = i - cfg->start;
+            IRCode *code = &cfg->list->codes[i];
+
+            for (int u = 0; u < 2; u++) {
+                du->use_start[2 * rel + u] = num_links;
+                int sym = cfg->use_of[2 * rel + u];
+                if (sym < 0) continue;
+
+                int first_call = 0;
+                if (seen[sym] == b + 1) {
+                    push_int(&du->use_defs, &num_links, &links_capacity, cur_def[sym]);
+                    first_call = call_mark[sym];
+                } else {
+                    int last = rd.sym_def_start[sym + 1];
+                    for (int d = bitset_next_in(reach, rd.sym_def_start[sym], last); d >= 0;
+                         d = bitset_next_in(reach, d + 1, last)) {
+                        push_int(&du->use_defs, &num_links, &links_capacity, rd.defs[d].instr);
+                    }
+                }
+                if (cfg->sym_bit[sym] >= 0 && bitset_test(&cfg->globals, cfg->sym_bit[sym])) {
+                    for (int c = first_call; c < num_calls; c++) {
+                        if (!bitset_test(&cfg->call_mod[calls[c] - cfg->start], cfg->sym_bit[sym])) continue;
+                        push_int(&du->use_defs, &num_links, &links_capacity, calls[c]);
+                    }
+                }
+            }
+
+            int def = cfg->def_of[rel];
+            if (def >= 0) {
+                seen[def] = b + 1;
+                cur_def[def] = i;
+                call_mark[def] = num_calls;
+            }
+            if (code->op == IR_CALL) {
+                calls[num_calls++] = i;
+            }
+        }
+    }
+    du->use_start[2 * n] = num_links;
+
+    free(seen);
+    free(cur_def);
+    free(call_mark);
+    free(calls);
+    reaching_defs_free(&rd);
+
+    // def-use: invertir las cadenas, sólo para el símbolo que define cada instrucción
+    du->def_start = df_alloc(n + 1, sizeof(int));
+    for (int use = 0; use < 2 * n; use++) {
+        int sym = cfg->use_of[use];
+        for (int k = du->use_start[use]; k < du->use_start[use + 1]; k++) {
+            int d = du->use_defs[k];
+            if (d >= 0 && cfg->def_of[d - cfg->start] == sym) du->def_start[d - cfg->start + 1]++;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        du->def_start[i + 1] += du->def_start[i];
+    }
+    du->def_uses = df_alloc(du->def_start[n], sizeof(int));
+    int *fill = df_alloc(n, sizeof(int));
+    for (int use = 0; use < 2 * n; use++) {
+        int sym = cfg->use_of[use];
+        for (int k = du->use_start[use]; k < du->use_start[use + 1]; k++) {
+            int d = du->use_defs[k];
+            if (d >= 0 && cfg->def_of[d - cfg->start] == sym) {
+                int rel = d - cfg->start;
+                du->def_uses[du->def_start[rel] + fill[rel]++] = use;
+            }
+        }
+    }
+    free(fill);
+}
+
+void defuse_free(DefUseChains *du) {
+    free(du->use_start);
+    free(du->use_defs);
+    free(du->def_start);
+    free(du->def_uses);
+    memset(du, 0, sizeof(DefUseChains));
+}
+
+/*
+ * Reemplaza por replacement cada uso del valor definido en def_instr (índice absoluto)
+ * que no sea alcanzado por ninguna otra definición. Devuelve la cantidad de reemplazos.
+ */
+int defuse_replace_all_uses(DefUseChains *du, CFG *cfg, int def_instr, IRSymbol *replacement) {
+    int rel = def_instr - cfg->start;
+    int replaced = 0;
+    for (int k = du->def_start[rel]; k < du->def_start[rel + 1]; k++) {
+        int use = du->def_uses[k];
+        if (du->use_start[use + 1] - du->use_start[use] != 1) continue;
+
+        IRCode *code = &cfg->list->codes[cfg->start + use / 2];
+        if (use % 2 == 0) {
+            code->arg1 = replacement;
+        } else {
+            code->arg2 = replacement;
+        }
+        replaced++;
+    }
+    return replaced;
+}
+
+/*
+ * Dominadores inmediatos con el algoritmo iterativo de Cooper, Harvey y Kennedy,
+ * recorriendo los bloques alcanzables en RPO.
+ */
+static void compute_idoms(CFG *cfg, int *idom) {
+    for (int b = 0; b < cfg->num_blocks; b++) idom[b] = -1;
+    if (cfg->num_reachable == 0) return;
+    idom[cfg->rpo_order[0]] = cfg->rpo_order[0];
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int k = 1; k < cfg->num_reachable; k++) {
+            int b = cfg->rpo_order[k];
+            int new_idom = -1;
+            for (int p = 0; p < cfg->blocks[b].num_preds; p++) {
+                int pred = cfg->blocks[b].preds[p];
+                if (idom[pred] < 0) continue;
+                if (new_idom < 0) {
+                    new_idom = pred;
+                    continue;
+                }
+                int x = pred, y = new_idom;
+                while (x != y) {
+                    while (cfg->blocks[x].rpo > cfg->blocks[y].rpo) x = idom[x];
+                    while (cfg->blocks[y].rpo > cfg->blocks[x].rpo) y = idom[y];
+                }
+                new_idom = x;
+            }
+            if (idom[b] != new_idom) {
+                idom[b] = new_idom;
+                changed = true;
+            }
+        }
+    }
+}
+
+/*
+ * Construye el grafo SSA de la función sin modificar el IR: ubica las phi de los
+ * símbolos no locales en la frontera de dominancia iterada de sus definiciones
+ * (los locales nunca las necesitan) y renombra recorriendo el árbol de dominadores.
+ * Una llamada cuenta como definición, con valor SSA_CLOBBER, de cada global que puede escribir.
+ */
+void ssa_build(SSAGraph *ssa, CFG *cfg) {
+    int n = cfg->end - cfg->start;
+    int nb = cfg->num_blocks;
+    ssa->cfg = cfg;
+    ssa->num_instrs = n;
+    ssa->idom = df_alloc(nb, sizeof(int));
+    compute_idoms(cfg, ssa->idom);
+
+    // Frontera de dominancia (formato CSR): primero se cuenta, después se llena
+    int *df_start = df_alloc(nb + 1, sizeof(int));
+    for (int pass = 0; pass < 2; pass++) {
+        int *fill = pass ? df_alloc(nb, sizeof(int)) : NULL;
+        for (int b = 0; b < nb; b++) {
+            if (ssa->idom[b] < 0 || cfg->blocks[b].num_preds < 2) continue;
+            for (int p = 0; p < cfg->blocks[b].num_preds; p++) {
+                int runner = cfg->blocks[b].preds[p];
+                if (ssa->idom[runner] < 0) continue;
+                while (runner != ssa->idom[b]) {
+                    if (pass == 0) {
+                        df_start[runner + 1]++;
+                    } else {
+                        ssa->frontier[df_start[runner] + fill[runner]++] = b;
+                    }
+                    runner = ssa->idom[runner];
+                }
+            }
+        }
+        if (pass == 0) {
+            for (int b = 0; b < nb; b++) df_start[b + 1] += df_start[b];
+            ssa->frontier = df_alloc(df_start[nb], sizeof(int));
+        }
+        free(fill);
+    }
+    ssa->frontier_start = df_start;
+
+    // Bloques que definen cada símbolo no local (CSR)
+    int nl = cfg->num_nonlocal;
+    int *def_start = df_alloc(nl + 1, sizeof(int));
+    int *last_block = df_alloc(nl, sizeof(int));
+    for (int v = 0; v < nl; v++) last_block[v] = -1;
+    int *block_defs = NULL;     // Pares (bit, bloque) en orden de aparición
+    int num_pairs = 0, pairs_capacity = 0;
+    for (int b = 0; b < nb; b++) {
+        if (ssa->idom[b] < 0) continue;
+        for (int i = cfg->blocks[b].start; i < cfg->blocks[b].end; i++) {
+            int def = cfg->def_of[i - cfg->start];
+            if (def >= 0 && cfg->sym_bit[def] >= 0 && last_block[cfg->sym_bit[def]] != b) {
+                last_block[cfg->sym_bit[def]] = b;
+                push_int(&block_defs, &num_pairs, &pairs_capacity, cfg->sym_bit[def]);
+                push_int(&block_defs, &num_pairs, &pairs_capacity, b);
+            }
+            if (cfg->list->codes[i].op == IR_CALL) {
+                BitSet *mod = &cfg->call_mod[i - cfg->start];
+                for (int g = bitset_next(mod, 0); g >= 0; g = bitset_next(mod, g + 1)) {
+                    if (last_block[g] == b) continue;
+                    last_block[g] = b;
+                    push_int(&block_defs, &num_pairs, &pairs_capacity, g);
+                    push_int(&block_defs, &num_pairs, &pairs_capacity, b);
+                }
+            }
+        }
+    }
+    for (int k = 0; k < num_pairs; k += 2) def_start[block_defs[k] + 1]++;
+    for (int v = 0; v < nl; v++) def_start[v + 1] += def_start[v];
+    int num_def_blocks = def_start[nl];
+    int *def_blocks = df_alloc(num_def_blocks, sizeof(int));
+    int *def_fill = df_alloc(nl, sizeof(int));
+    for (int k = 0; k < num_pairs; k += 2) {
+        int v = block_defs[k];
+        def_blocks[def_start[v] + def_fill[v]++] = block_defs[k + 1];
+    }
+    free(def_fill);
+    free(block_defs);
+    free(last_block);
+
+    // Ubicación de las phi: frontera de dominancia iterada de cada símbolo
+    int *phi_pairs = NULL;      // Pares (bloque, símbolo)
+    int num_phi_pairs = 0, phi_capacity = 0;
+    int *has_phi = df_alloc(nb, sizeof(int));
+    int *queued = df_alloc(nb, sizeof(int));
+    int *work = df_alloc(nb + num_def_blocks + 1, sizeof(int));
+    for (int v = 0; v < nl; v++) {
+        int top = 0;
+        for (int k = def_start[v]; k < def_start[v + 1]; k++) {
+            queued[def_blocks[k]] = v + 1;
+            work[top++] = def_blocks[k];
+        }
+        while (top > 0) {
+            int x = work[--top];
+            for (int k = df_start[x]; k < df_start[x + 1]; k++) {
+                int y = ssa->frontier[k];
+                if (has_phi[y] == v + 1) continue;
+                has_phi[y] = v + 1;
+                push_int(&phi_pairs, &num_phi_pairs, &phi_capacity, y);
+                push_int(&phi_pairs, &num_phi_pairs, &phi_capacity, cfg->nonlocal_syms[v]);
+                if (queued[y] != v + 1) {
+                    queued[y] = v + 1;
+                    work[top++] = y;
+                }
+            }
+        }
+    }
+    free(has_phi);
+    free(queued);
+    free(work);
+    free(def_start);
+    free(def_blocks);
+
+    // Phis agrupadas por bloque, con un argumento por predecesor
+    ssa->num_phis = num_phi_pairs / 2;
+    ssa->phis = df_alloc(ssa->num_phis, sizeof(PhiNode));
+    ssa->block_phi_start = df_alloc(nb + 1, sizeof(int));
+    for (int k = 0; k < num_phi_pairs; k += 2) ssa->block_phi_start[phi_pairs[k] + 1]++;
+    for (int b = 0; b < nb; b++) ssa->block_phi_start[b + 1] += ssa->block_phi_start[b];
+    int num_args = 0;
+    int *phi_fill = df_alloc(nb, sizeof(int));
+    for (int k = 0; k < num_phi_pairs; k += 2) {
+        int b = phi_pairs[k];
+        PhiNode *phi = &ssa->phis[ssa->block_phi_start[b] + phi_fill[b]++];
+        phi->block = b;
+        phi->sym = phi_pairs[k + 1];
+        num_args += cfg->blocks[b].num_preds;
+    }
+    free(phi_fill);
+    free(phi_pairs);
+    ssa->phi_args = df_alloc(num_args, sizeof(int));
+    num_args = 0;
+    for (int k = 0; k < ssa->num_phis; k++) {
+        ssa->phis[k].args = ssa->phi_args + num_args;
+        for (int j = 0; j < cfg->blocks[ssa->phis[k].block].num_preds; j++) {
+            ssa->phis[k].args[j] = SSA_ENTRY;
+        }
+        num_args += cfg->blocks[ssa->phis[k].block].num_preds;
+    }
+
+    // Renombrado: recorrido del árbol de dominadores con una pila de deshacer
+    ssa->use_value = df_alloc(2 * n, sizeof(int));
+    for (int u = 0; u < 2 * n; u++) ssa->use_value[u] = SSA_ENTRY;
+    int *current = df_alloc(cfg->num_syms, sizeof(int));
+    for (int sym = 0; sym < cfg->num_syms; sym++) current[sym] = SSA_ENTRY;
+
+    int *child_start = df_alloc(nb + 1, sizeof(int));
+    int *children = df_alloc(nb, sizeof(int));
+    for (int b = 0; b < nb; b++) {
+        if (ssa->idom[b] >= 0 && ssa->idom[b] != b) child_start[ssa->idom[b] + 1]++;
+    }
+    for (int b = 0; b < nb; b++) child_start[b + 1] += child_start[b];
+    int *child_fill = df_alloc(nb, sizeof(int));
+    for (int b = 0; b < nb; b++) {
+        if (ssa->idom[b] >= 0 && ssa->idom[b] != b) {
+            children[child_start[ssa->idom[b]] + child_fill[ssa->idom[b]]++] = b;
+        }
+    }
+    free(child_fill);
+
+    int *undo = NULL;           // Pares (símbolo, valor anterior)
+    int undo_top = 0, undo_capacity = 0;
+    int *stack = df_alloc(2 * nb + 2, sizeof(int));    // Bloque, o ~bloque al salir
+    int *mark = df_alloc(nb, sizeof(int));
+    int sp = 0;
+    if (cfg->num_reachable > 0) stack[sp++] = cfg->rpo_order[0];
+
+    while (sp > 0) {
+        int b = stack[--sp];
+        if (b < 0) {
+            // Salida del bloque: se restauran los valores de sus dominadores
+            b = ~b;
+            while (undo_top > mark[b]) {
+                undo_top -= 2;
+                current[undo[undo_top]] = undo[undo_top + 1];
+            }
+            continue;
+        }
+
+        mark[b] = undo_top;
+        for (int k = ssa->block_phi_start[b]; k < ssa->block_phi_start[b + 1]; k++) {
+            push_int(&undo, &undo_top, &undo_capacity, ssa->phis[k].sym);
+            push_int(&undo, &undo_top, &undo_capacity, current[ssa->phis[k].sym]);
+            current[ssa->phis[k].sym] = n + k;
+        }
+        for (int i = cfg->blocks[b].start; i < cfg->blocks[b].end; i++) {
+            int rel = i - cfg->start;
+            for (int slot = 0; slot < 2; slot++) {
+                int sym = cfg->use_of[2 * rel + slot];
+                if (sym >= 0) ssa->use_value[2 * rel + slot] = current[sym];
+            }
+            int def = cfg->def_of[rel];
+            if (def >= 0) {
+                push_int(&undo, &undo_top, &undo_capacity, def);
+                push_int(&undo, &undo_top, &undo_capacity, current[def]);
+                current[def] = rel;
+            }
+            if (cfg->list->codes[i].op == IR_CALL) {
+                BitSet *mod = &cfg->call_mod[rel];
+                for (int g = bitset_next(mod, 0); g >= 0; g = bitset_next(mod, g + 1)) {
+                    int sym = cfg->nonlocal_syms[g];
+                    push_int(&undo, &undo_top, &undo_capacity, sym);
+                    push_int(&undo, &undo_top, &undo_capacity, current[sym]);
+                    current[sym] = SSA_CLOBBER;
+                }
+            }
+        }
+        for (int s = 0; s < cfg->blocks[b].num_succs; s++) {
+            int succ = cfg->blocks[b].succs[s];
+            int j = ssa_pred_index(cfg, succ, b);
+            for (int k = ssa->block_phi_start[succ]; k < ssa->block_phi_start[succ + 1]; k++) {
+                ssa->phis[k].args[j] = current[ssa->phis[k].sym];
+            }
+        }
+
+        stack[sp++] = ~b;
+        for (int c = child_start[b]; c < child_start[b + 1]; c++) {
+            stack[sp++] = children[c];
+        }
+    }
+    free(undo);
+    free(stack);
+    free(mark);
+    free(current);
+    free(child_start);
+    free(children);
+
+    // Usuarios de cada valor (CSR): instrucciones y phis
+    int num_values = n + ssa->num_phis;
+    ssa->user_start = df_alloc(num_values + 1, sizeof(int));
+    for (int pass = 0; pass < 2; pass++) {
+        int *fill = pass ? df_alloc(num_values, sizeof(int)) : NULL;
+        for (int u = 0; u < 2 * n; u++) {
+            int v = ssa->use_value[u];
+            if (cfg->use_of[u] < 0 || v < 0) continue;
+            if (pass == 0) ssa->user_start[v + 1]++;
+            else ssa->users[ssa->user_start[v] + fill[v]++] = u / 2;
+        }
+        for (int k = 0; k < ssa->num_phis; k++) {
+            for (int j = 0; j < cfg->blocks[ssa->phis[k].block].num_preds; j++) {
+                int v = ssa->phis[k].args[j];
+                if (v < 0) continue;
+                if (pass == 0) ssa->user_start[v + 1]++;
+                else ssa->users[ssa->user_start[v] + fill[v]++] = n + k;
+            }
+        }
+        if (pass == 0) {
+            for (int v = 0; v < num_values; v++) ssa->user_start[v + 1] += ssa->user_start[v];
+            ssa->users = df_alloc(ssa->user_start[num_values], sizeof(int));
+        }
+        free(fill);
+    }
+}
+
+void ssa_free(SSAGraph *ssa) {
+    free(ssa->idom);
+    free(ssa->frontier_start);
+    free(ssa->frontier);
+    free(ssa->phis);
+    free(ssa->phi_args);
+    free(ssa->block_phi_start);
+    free(ssa->use_value);
+    free(ssa->user_start);
+    free(ssa->users);
+    memset(ssa, 0, sizeof(SSAGraph));
+}
+
+/*
+ * Posición de pred entre los predecesores de block, -1 si no lo es.
+ */
+int ssa_pred_index(CFG *cfg, int block, int pred) {
+    for (int j = 0; j < cfg->blocks[block].num_preds; j++) {
+        if (cfg->blocks[block].preds[j] == pred) return j;
+    }
+    return -1;
+}
+
+/*
+ * Resumen de los tres análisis para cada función (modo debug).
+ */
+void dataflow_report(IRList *list) {
+    for (int i = 0; i < list->size; i++) {
+        if (list->codes[i].op != IR_METHOD) continue;
+
+        CFG cfg;
+        cfg_build(&cfg, list, i);
+
+        DataflowProblem live;
+        ReachingDefs rd;
+        AvailableExprs ae;
+        liveness_compute(&live, &cfg);
+        reaching_defs_compute(&rd, &cfg);
+        available_exprs_compute(&ae, &cfg);
+
+        int live_in = cfg.num_blocks > 0 ? bitset_count(&live.in[0]) : 0;
+        printf("  [DATAFLOW] %s: %d bloques (%d alcanzables), %d símbolos (%d no locales), "
+               "%d vivos a la entrada, %d definiciones, %d expresiones, %d visitas\n",
+               list->codes[i].result->name, cfg.num_blocks, cfg.num_reachable, cfg.num_syms,
+               cfg.num_nonlocal, live_in, rd.num_defs, ae.num_exprs,
+               live.visits + rd.problem.visits + ae.problem.visits);
+
+        i = cfg.end - 1;
+        dataflow_problem_free(&live);
+        reaching_defs_free(&rd);
+        available_exprs_free(&ae);
+        cfg_free(&cfg);
+    }
+}
@@ -0,0 +1,282 @@
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include "intermediate.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Conjunto de bits denso, almacenado en palabras de 64 bits.
+ */
+typedef struct {
+    uint64_t *words;
+    int num_bits;
+    int num_words;
+} BitSet;
+
+/*
+ * Tabla hash de strings a enteros (direccionamiento abierto).
+ * Las claves no se copian: deben vivir mientras se use la tabla.
+ */
+typedef struct {
+    const char **keys;
+    int *values;
+    int capacity;
+    int count;
+} StrMap;
+
+/*
+ * Bloque básico: rango [start, end) de instrucciones de la IRList.
+ */
+typedef struct {
+    int start;
+    int end;
+    int succs[2];
+    int num_succs;
+    int *preds;
+    int num_preds;
+    int rpo;            // Posición en el orden RPO, -1 si es inalcanzable
+} BasicBlock;
+
+/*
+ * Grafo de flujo de control de una función (METHOD ... hasta el próximo METHOD/EXTERN).
+ * Además de los bloques, guarda el universo de símbolos (temporales y variables)
+ * y, por cada instrucción, el símbolo que define y los que usa.
+ *
+ * Los análisis entre bloques sólo necesitan los símbolos no locales: los globales
+ * y los que se leen en algún bloque antes de definirse en él. El resto (casi todos
+ * los temporales) nunca está vivo en el borde de un bloque, así que no ocupa bits.
+ */
+typedef struct {
+    IRList *list;
+    int start;              // Índice de la instrucción METHOD
+    int end;
+    BasicBlock *blocks;
+    int num_blocks;
+    int *rpo_order;         // Bloques alcanzables en orden RPO
+    int num_reachable;
+    int *block_of;          // Bloque de cada instrucción (índice relativo a start)
+    StrMap sym_map;         // Nombre -> índice de símbolo
+    const char **sym_names; // Índice de símbolo -> nombre
+    int num_syms;
+    int *def_of;            // Símbolo definido por cada instrucción, -1 si ninguno
+    int *use_of;            // Símbolo leído en arg1/arg2 de cada instrucción, -1 si no hay
+    int *sym_bit;           // Bit de cada símbolo no local, -1 si es local a un bloque
+    int *nonlocal_syms;     // Bit -> símbolo
+    int num_nonlocal;
+    BitSet globals;         // Globales, indexados por bit de símbolo no local
+    BitSet *call_mod;       // Por cada CALL (índice relativo): globales que puede escribir
+    BitSet *call_ref;       // Por cada CALL: globales que puede leer
+} CFG;
+
+typedef enum {
+    DF_FORWARD,
+    DF_BACKWARD
+} DFDirection;
+
+typedef enum {
+    DF_MEET_UNION,
+    DF_MEET_INTERSECT
+} DFMeet;
+
+/*
+ * Problema de flujo de datos en forma gen/kill:
+ *   forward:  out[b] = gen[b] ∪ (in[b] - kill[b]),  in[b]  = meet(out[p]) de predecesores
+ *   backward: in[b]  = gen[b] ∪ (out[b] - kill[b]), out[b] = meet(in[s]) de sucesores
+ * El valor de frontera se aplica a la entrada (forward) o a los bloques de salida (backward).
+ */
+typedef struct {
+    DFDirection direction;
+    DFMeet meet;
+    int num_bits;
+    int num_blocks;
+    BitSet *gen;
+    BitSet *kill;
+    BitSet *in;
+    BitSet *out;
+    BitSet boundary;
+    int visits;             // Cantidad de bloques procesados por el solver
+} DataflowProblem;
+
+/*
+ * Definición para reaching definitions (sólo de símbolos no locales).
+ * instr == -1 representa el valor que la variable tiene a la entrada de la función.
+ */
+typedef struct {
+    int instr;
+    int sym;
+} Definition;
+
+typedef struct {
+    Definition *defs;
+    int num_defs;
+    int *instr_def_start;   // Definiciones de cada instrucción (formato CSR, relativo a start)
+    int *instr_defs;
+    int *sym_def_start;     // Las definiciones de cada símbolo son el rango [sym_def_start[s], sym_def_start[s + 1])
+    DataflowProblem problem;
+} ReachingDefs;
+
+/*
+ * Expresión para available expressions. Cada operando es un símbolo no local
+ * (kind 0, índice en el CFG) o una constante (kind 1, valor).
+ */
+typedef struct {
+    IRInstr op;
+    int kind1, val1;
+    int kind2, val2;
+} Expression;
+
+typedef struct {
+    Expression *exprs;
+    int num_exprs;
+    int *instr_expr;        // Expresión calculada por cada instrucción, -1 si ninguna
+    DataflowProblem problem;
+} AvailableExprs;
+
+/*
+ * Cadenas use-def y def-use de una función. Los usos se identifican por
+ * 2 * (instrucción relativa a start) + operando (0 = arg1, 1 = arg2).
+ *   use-def: definiciones que alcanzan cada uso (instrucción absoluta, -1 = entrada)
+ *   def-use: usos del valor que define cada instrucción
+ */
+typedef struct {
+    int *use_start;         // 2 * n + 1 entradas
+    int *use_defs;
+    int *def_start;         // n + 1 entradas
+    int *def_uses;
+    int num_instrs;
+} DefUseChains;
+
+/*
+ * Grafo SSA de una función, construido sin reescribir el IR. Los valores 0..n-1 son
+ * las instrucciones (relativas a start) y n + k es la phi k. Las phi sólo se crean
+ * para símbolos no locales; cada una tiene un argumento por predecesor de su bloque,
+ * en el orden de preds. SSA_ENTRY es el valor de un símbolo al entrar a la función
+ * (o en un camino inalcanzable) y SSA_CLOBBER el de un global tras una llamada que
+ * puede escribirlo.
+ */
+#define SSA_ENTRY   -1
+#define SSA_CLOBBER -2
+
+typedef struct {
+    int block;
+    int sym;
+    int *args;
+} PhiNode;
+
+typedef struct {
+    CFG *cfg;
+    int num_instrs;
+    int *idom;              // Dominador inmediato; la entrada es su propio dominador, -1 si es inalcanzable
+    int *frontier_start;    // Frontera de dominancia de cada bloque (CSR)
+    int *frontier;
+    PhiNode *phis;          // Agrupadas por bloque
+    int num_phis;
+    int *phi_args;
+    int *block_phi_start;   // Phis de cada bloque (CSR, num_blocks + 1 entradas)
+    int *use_value;         // Valor que lee cada uso (2 * rel + operando)
+    int *user_start;        // Usuarios de cada valor (CSR): instrucción rel o n + k para la phi k
+    int *users;
+} SSAGraph;
+
+/*
+ * Renombre de los operandos de un cuerpo copiado (inlining, clones
+ * especializados): cada temporal y etiqueta tiene una copia nueva, y las
+ * variables locales también si instance >= 0 ("nombre.instance").
+ */
+typedef struct {
+    StrMap map;             // Nombre original -> índice en syms
+    IRSymbol **syms;
+    int count;
+    int instance;           // -1: las variables se comparten con el original
+} IRRenamer;
+
+/*
+ * Memoria en cero para los pases; sin memoria termina el programa
+ */
+void *df_alloc(size_t count, size_t size);
+
+/*
+ * Conjuntos de bits
+ */
+void bitset_init(BitSet *set, int num_bits);
+void bitset_free(BitSet *set);
+void bitset_clear_all(BitSet *set);
+void bitset_set_all(BitSet *set);
+void bitset_set(BitSet *set, int bit);
+void bitset_clear(BitSet *set, int bit);
+void bitset_set_range(BitSet *set, int from, int to);
+void bitset_clear_range(BitSet *set, int from, int to);
+bool bitset_test(const BitSet *set, int bit);
+void bitset_copy(BitSet *dst, const BitSet *src);
+bool bitset_union_with(BitSet *dst, const BitSet *src);
+bool bitset_intersect_with(BitSet *dst, const BitSet *src);
+bool bitset_difference_with(BitSet *dst, const BitSet *src);
+int bitset_count(const BitSet *set);
+int bitset_next(const BitSet *set, int from);
+int bitset_next_in(const BitSet *set, int from, int to);
+
+/*
+ * Tabla de strings
+ */
+void strmap_init(StrMap *map, int expected);
+void strmap_free(StrMap *map);
+int strmap_get(StrMap *map, const char *key);
+void strmap_put(StrMap *map, const char *key, int value);
+
+/*
+ * Grafo de flujo de control
+ */
+bool ir_is_cond_branch(IRCode *code);
+bool ir_is_terminator(IRCode *code);
+bool ir_is_nop(IRCode *code);
+IRInstr negate_branch_op(IRInstr op);
+bool same_symbol(IRSymbol *a, IRSymbol *b);
+IRSymbol *ir_def_symbol(IRCode *code);
+int ir_use_symbols(IRCode *code, IRSymbol *uses[2]);
+int ir_function_end(IRList *list, int start);
+void ir_method_arities(IRList *list, StrMap *arities);
+void ir_match_call_params(IRCode *codes, int count, StrMap *arities, int *call_of);
+int ir_body_size(IRCode *codes, int start, int end);
+bool fits_int(long long value);
+void cfg_build(CFG *cfg, IRList *list, int start);
+void cfg_free(CFG *cfg);
+int cfg_sym_index(CFG *cfg, const char *name);
+int cfg_top_level_start(CFG *cfg);
+
+/*
+ * Copia de cuerpos
+ */
+void ir_renamer_init(IRRenamer *r, int max_syms, int instance);
+void ir_renamer_free(IRRenamer *r);
+void ir_renamer_bind(IRRenamer *r, IRSymbol *sym, IRSymbol *copy);
+IRSymbol *ir_rename_operand(IRRenamer *r, IRSymbol *sym);
+
+/*
+ * Solver genérico y clientes
+ */
+void dataflow_problem_init(DataflowProblem *p, CFG *cfg, DFDirection direction,
+                           DFMeet meet, int num_bits);
+void dataflow_problem_free(DataflowProblem *p);
+void dataflow_solve(DataflowProblem *p, CFG *cfg);
+
+void liveness_compute(DataflowProblem *p, CFG *cfg);
+bool liveness_live_in(DataflowProblem *p, CFG *cfg, int block, int sym);
+bool liveness_live_out(DataflowProblem *p, CFG *cfg, int block, int sym);
+void reaching_defs_compute(ReachingDefs *rd, CFG *cfg);
+void reaching_defs_free(ReachingDefs *rd);
+void available_exprs_compute(AvailableExprs *ae, CFG *cfg);
+void available_exprs_free(AvailableExprs *ae);
+
+void defuse_build(DefUseChains *du, CFG *cfg);
+void defuse_free(DefUseChains *du);
+int defuse_replace_all_uses(DefUseChains *du, CFG *cfg, int def_instr, IRSymbol *replacement);
+
+void ssa_build(SSAGraph *ssa, CFG *cfg);
+void ssa_free(SSAGraph *ssa);
+int ssa_pred_index(CFG *cfg, int block, int pred);
+
+void dataflow_report(IRList *list);
+
+#endif
@@ -0,0 +1,44 @@
+#include "deadfunc.h"
+#include "optimizer.h"
+#include "callgraph.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Eliminación de funciones muertas.
+ *
+ * Un método al que no se llega desde main por ninguna cadena de llamadas nunca
+ * se ejecuta: se borra del IR antes de optimizar y no llega al backend. Corre
+ * al principio del pipeline, para no optimizar código que se descarta, y de
+ * nuevo después de DCE, cuando el inlining y la especialización pueden haber
+ * dejado sin llamadas a los métodos originales. Sin main no se borra nada.
+ */
+
+void optimize_dead_functions(IRList *list) {
+    CallGraph cg;
+    callgraph_build(&cg, list);
+
+    int removed = 0, instructions = 0;
+    for (int k = 0; k < cg.num_nodes; k++) {
+        CallNode *node = &cg.nodes[k];
+        if (node->reachable) continue;
+        // Si al método le sigue código de nivel superior, ése se conserva
+        CFG cfg;
+        cfg_build(&cfg, list, node->start);
+        int end = cfg_top_level_start(&cfg);
+        cfg_free(&cfg);
+        if (debug_mode) {
+            printf("  [DEAD FUNC] Línea %d: %s no se llama desde main (%d instrucciones)\n",
+                   node->start, node->name, end - node->start);
+        }
+        for (int i = node->start; i < end; i++) mark_instruction_as_nop(list, i);
+        instructions += end - node->start;
+        removed++;
+    }
+    callgraph_free(&cg);
+    compact_ir_list(list);
+
+    if (removed > 0 && debug_mode) {
+        printf("✓ Eliminación de funciones muertas: %d métodos eliminados, %d instrucciones\n", removed, instructions);
+    }
+}
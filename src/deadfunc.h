@@ -0,0 +1,12 @@
+#ifndef DEADFUNC_H
+#define DEADFUNC_H
+
+#include "intermediate.h"
+
+/*
+ * Eliminación de funciones muertas: borra los métodos a los que no se llega
+ * desde main por el grafo de llamadas.
+ */
+void optimize_dead_functions(IRList *list);
+
+#endif
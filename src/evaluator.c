@@ -0,0 +1,352 @@
+#include "evaluator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*
+ * Evaluador del IR en tiempo de compilación.
+ *
+ * Cada método se traduce una vez a EvalInstr: temporales y variables locales
+ * pasan a ser slots de un arreglo por frame, las constantes quedan resueltas y
+ * los saltos apuntan a la instrucción destino. Los enteros son de 64 bits y la
+ * aritmética da la vuelta como en el código nativo.
+ *
+ * Cada llamada evaluada tiene un presupuesto de pasos (instrucciones
+ * ejecutadas, contando las de los métodos que llama), así que una función que
+ * no termina sólo cuesta ese presupuesto.
+ *
+ * ir_eval_program ejecuta el programa completo: primero las asignaciones de
+ * las globales que están antes del primer método y después main, con las
+ * globales en un arreglo propio y las llamadas a print_int registradas.
+ */
+
+void ir_eval_init(IREvaluator *ev, IRList *list, long budget) {
+    ev->list = list;
+    ev->funcs = df_alloc(list->size + 1, sizeof(EvalFunc));     // +1: tramo de globales
+    ev->num_funcs = 0;
+    ev->budget = budget;
+    ev->steps = 0;
+    ev->whole_program = false;
+    ev->globals = NULL;
+    ev->num_globals = 0;
+    ev->output = NULL;
+    ev->num_output = 0;
+    ev->max_output = 0;
+    strmap_init(&ev->func_map, 16);
+    strmap_init(&ev->global_map, 16);
+    for (int i = 0; i < list->size; i++) {
+        if (list->codes[i].op != IR_METHOD || !list->codes[i].result) continue;
+        EvalFunc *f = &ev->funcs[ev->num_funcs];
+        f->name = list->codes[i].result->name;
+        f->start = i;
+        f->end = ir_function_end(list, i);
+        strmap_put(&ev->func_map, f->name, ev->num_funcs++);
+    }
+}
+
+void ir_eval_free(IREvaluator *ev) {
+    for (int k = 0; k < ev->num_funcs; k++) {
+        free(ev->funcs[k].code);
+        free(ev->funcs[k].param_slots);
+    }
+    free(ev->funcs);
+    free(ev->globals);
+    free(ev->output);
+    strmap_free(&ev->func_map);
+    strmap_free(&ev->global_map);
+}
+
+int ir_eval_function(IREvaluator *ev, const char *name) {
+    return strmap_get(&ev->func_map, name);
+}
+
+const char *ir_eval_status_text(EvalStatus status) {
+    switch (status) {
+        case EVAL_OK:          return "evaluada";
+        case EVAL_EXTERN:      return "llama a un externo";
+        case EVAL_GLOBAL:      return "usa variables globales";
+        case EVAL_BUDGET:      return "excede el presupuesto de pasos";
+        case EVAL_DEPTH:       return "excede la profundidad de llamadas";
+        case EVAL_DIV_ZERO:    return "divide por cero";
+        case EVAL_OUTPUT:      return "excede el máximo de salidas";
+        case EVAL_UNSUPPORTED: return "instrucción no soportada";
+    }
+    return "";
+}
+
+static int slot_of(StrMap *slots, int *num_slots, const char *name) {
+    int slot = strmap_get(slots, name);
+    if (slot < 0) {
+        slot = (*num_slots)++;
+        strmap_put(slots, name, slot);
+    }
+    return slot;
+}
+
+static EvalOperand compile_operand(IREvaluator *ev, StrMap *slots, int *num_slots, IRSymbol *sym, bool *global) {
+    EvalOperand op = {-1, false, 0};
+    if (!sym) return op;
+    if (sym->type == IR_SYM_CONST) {
+        op.value = atol(sym->name);
+    } else if (sym->type == IR_SYM_VAR && ir_is_global(sym->name)) {
+        if (ev->whole_program) {
+            op.slot = slot_of(&ev->global_map, &ev->num_globals, sym->name);
+            op.global = true;
+        } else {
+            *global = true;
+        }
+    } else {
+        op.slot = slot_of(slots, num_slots, sym->name);
+    }
+    return op;
+}
+
+static void compile_function(IREvaluator *ev, EvalFunc *f) {
+    IRCode *codes = ev->list->codes;
+    int n = f->end - f->start;
+    int old_globals = ev->num_globals;
+    StrMap slots, labels;
+    strmap_init(&slots, n);
+    strmap_init(&labels, n);
+    for (int i = f->start + 1; i < f->end; i++) {
+        if (codes[i].op == IR_LABEL && codes[i].result) strmap_put(&labels, codes[i].result->name, i - f->start - 1);
+    }
+
+    f->code = df_alloc(n, sizeof(EvalInstr));
+    f->param_slots = df_alloc(n, sizeof(int));
+    f->size = n - 1;
+    for (int i = f->start + 1; i < f->end; i++) {
+        IRCode *code = &codes[i];
+        EvalInstr *instr = &f->code[i - f->start - 1];
+        instr->op = code->op;
+        instr->dst = -1;
+        instr->dst_global = false;
+        instr->target = -1;
+        instr->global = false;
+        switch (code->op) {
+            case IR_PARAM:
+                f->param_slots[f->num_params++] = slot_of(&slots, &f->num_slots, code->result->name);
+                break;
+            case IR_LABEL:
+            case IR_EXTERN:
+                break;
+            case IR_GOTO:
+            case IR_IF_FALSE:
+            case IR_IF_TRUE:
+            case IR_IF_EQ:
+            case IR_IF_NEQ:
+            case IR_IF_LT:
+            case IR_IF_LE:
+            case IR_IF_GT:
+            case IR_IF_GE:
+                instr->a = compile_operand(ev, &slots, &f->num_slots, code->arg1, &instr->global);
+                instr->b = compile_operand(ev, &slots, &f->num_slots, code->arg2, &instr->global);
+                instr->target = strmap_get(&labels, code->result->name);
+                break;
+            case IR_CALL:
+                instr->target = ir_eval_function(ev, code->arg1->name);
+                if (instr->target < 0 && ev->whole_program && strcmp(code->arg1->name, "print_int") == 0) {
+                    instr->target = EVAL_PRINT_INT;
+                }
+                if (code->result) instr->dst = slot_of(&slots, &f->num_slots, code->result->name);
+                break;
+            case IR_CALL_PARAM:
+                f->max_pending++;
+                instr->a = compile_operand(ev, &slots, &f->num_slots, code->arg1, &instr->global);
+                break;
+            default:
+                instr->a = compile_operand(ev, &slots, &f->num_slots, code->arg1, &instr->global);
+                instr->b = compile_operand(ev, &slots, &f->num_slots, code->arg2, &instr->global);
+                if (code->result) {
+                    if (code->result->type == IR_SYM_VAR && ir_is_global(code->result->name)) {
+                        if (ev->whole_program) {
+                            instr->dst = slot_of(&ev->global_map, &ev->num_globals, code->result->name);
+                            instr->dst_global = true;
+                        } else {
+                            instr->global = true;
+                        }
+                    } else {
+                        instr->dst = slot_of(&slots, &f->num_slots, code->result->name);
+                    }
+                }
+                break;
+        }
+    }
+    f->compiled = true;
+    // Globales que aparecen por primera vez en este método
+    if (ev->num_globals > old_globals) {
+        ev->globals = realloc(ev->globals, ev->num_globals * sizeof(long));
+        if (!ev->globals) {
+            fprintf(stderr, "Error: no se pudo asignar memoria para el evaluador\n");
+            exit(1);
+        }
+        for (int k = old_globals; k < ev->num_globals; k++) ev->globals[k] = 0;
+    }
+    strmap_free(&slots);
+    strmap_free(&labels);
+}
+
+static long value_of(IREvaluator *ev, long *frame, EvalOperand op) {
+    if (op.slot < 0) return op.value;
+    return op.global ? ev->globals[op.slot] : frame[op.slot];
+}
+
+
+static long wrap_add(long x, long y) { return (long)((uint64_t)x + (uint64_t)y); }
+static long wrap_sub(long x, long y) { return (long)((uint64_t)x - (uint64_t)y); }
+static long wrap_mul(long x, long y) { return (long)((uint64_t)x * (uint64_t)y); }
+
+static EvalStatus run_function(IREvaluator *ev, int index, const long *args, int num_args, long *result, int depth) {
+    if (depth > EVAL_MAX_DEPTH) return EVAL_DEPTH;
+    EvalFunc *f = &ev->funcs[index];
+    if (!f->compiled) compile_function(ev, f);
+
+    long *frame = df_alloc(f->num_slots, sizeof(long));
+    long *pending = df_alloc(f->max_pending, sizeof(long));
+    int num_pending = 0;
+    for (int k = 0; k < f->num_params && k < num_args; k++) frame[f->param_slots[k]] = args[k];
+
+    EvalStatus status = EVAL_OK;
+    bool returned = false;
+    *result = 0;
+    int pc = 0;
+    while (pc < f->size) {
+        if (++ev->steps > ev->budget) {
+            status = EVAL_BUDGET;
+            break;
+        }
+        EvalInstr *instr = &f->code[pc];
+        if (instr->global) {
+            status = EVAL_GLOBAL;
+            break;
+        }
+        long x = value_of(ev, frame, instr->a), y = value_of(ev, frame, instr->b);
+        long r = 0;
+        bool jump = false;
+        switch (instr->op) {
+            case IR_PARAM:
+            case IR_LABEL:
+            case IR_EXTERN:
+                pc++;
+                continue;
+            case IR_LOAD:
+            case IR_STORE:  r = x; break;
+            case IR_ADD:    r = wrap_add(x, y); break;
+            case IR_SUB:    r = wrap_sub(x, y); break;
+            case IR_MUL:    r = wrap_mul(x, y); break;
+            case IR_UMINUS: r = wrap_sub(0, x); break;
+            case IR_DIV:
+            case IR_MOD:
+                // idivq falla con divisor 0 y con LONG_MIN / -1
+                if (y == 0 || (y == -1 && x == INT64_MIN)) {
+                    status = EVAL_DIV_ZERO;
+                    break;
+                }
+                r = instr->op == IR_DIV ? x / y : x % y;
+                break;
+            case IR_AND:    r = x != 0 && y != 0; break;
+            case IR_OR:     r = x != 0 || y != 0; break;
+            case IR_NOT:    r = x == 0; break;
+            case IR_EQ:     r = x == y; break;
+            case IR_NEQ:    r = x != y; break;
+            case IR_LT:     r = x < y; break;
+            case IR_LE:     r = x <= y; break;
+            case IR_GT:     r = x > y; break;
+            case IR_GE:     r = x >= y; break;
+            case IR_GOTO:   jump = true; break;
+            case IR_IF_FALSE: jump = x == 0; break;
+            case IR_IF_TRUE:  jump = x != 0; break;
+            case IR_IF_EQ:  jump = x == y; break;
+            case IR_IF_NEQ: jump = x != y; break;
+            case IR_IF_LT:  jump = x < y; break;
+            case IR_IF_LE:  jump = x <= y; break;
+            case IR_IF_GT:  jump = x > y; break;
+            case IR_IF_GE:  jump = x >= y; break;
+            case IR_CALL_PARAM:
+                pending[num_pending++] = x;
+                pc++;
+                continue;
+            case IR_CALL: {
+                if (instr->target == EVAL_PRINT_INT) {
+                    if (num_pending == 0 || ev->num_output >= ev->max_output) {
+                        status = num_pending == 0 ? EVAL_UNSUPPORTED : EVAL_OUTPUT;
+                        break;
+                    }
+                    ev->output[ev->num_output++] = pending[--num_pending];
+                    break;
+                }
+                if (instr->target < 0) {
+                    status = EVAL_EXTERN;
+                    break;
+                }
+                EvalFunc *callee = &ev->funcs[instr->target];
+                if (!callee->compiled) compile_function(ev, callee);
+                int count = callee->num_params < num_pending ? callee->num_params : num_pending;
+                num_pending -= count;
+                status = run_function(ev, instr->target, &pending[num_pending], count, &r, depth + 1);
+                break;
+            }
+            case IR_RETURN:
+                *result = x;
+                returned = true;
+                break;
+            default:
+                status = EVAL_UNSUPPORTED;
+                break;
+        }
+        if (status != EVAL_OK || returned) break;
+        if (jump) {
+            if (instr->target < 0) {
+                status = EVAL_UNSUPPORTED;
+                break;
+            }
+            pc = instr->target;
+            continue;
+        }
+        if (instr->dst_global) ev->globals[instr->dst] = r;
+        else if (instr->dst >= 0) frame[instr->dst] = r;
+        pc++;
+    }
+
+    free(frame);
+    free(pending);
+    return status;
+}
+
+/*
+ * Evalúa la función de índice func con los argumentos dados. En result queda
+ * el valor devuelto (0 si termina sin RETURN con valor).
+ */
+EvalStatus ir_eval_call(IREvaluator *ev, int func, const long *args, int num_args, long *result) {
+    ev->steps = 0;
+    return run_function(ev, func, args, num_args, result, 0);
+}
+
+/*
+ * Ejecuta el programa completo: las asignaciones de globales anteriores al
+ * primer método y después main, registrando hasta max_output llamadas a
+ * print_int. Se usa con un evaluador recién inicializado. En result queda el
+ * valor que devuelve main.
+ */
+EvalStatus ir_eval_program(IREvaluator *ev, int max_output, long *result) {
+    int main_func = ir_eval_function(ev, "main");
+    if (main_func < 0) return EVAL_UNSUPPORTED;
+    ev->whole_program = true;
+    ev->max_output = max_output;
+    ev->output = df_alloc(max_output, sizeof(long));
+    ev->steps = 0;
+
+    // Las globales se inicializan antes del primer método: ese tramo se corre
+    // como una función más, en el lugar libre después de la última
+    int first = ev->num_funcs > 0 ? ev->funcs[0].start : ev->list->size;
+    int prelude = ev->num_funcs;
+    ev->funcs[prelude] = (EvalFunc){"", -1, first, false, NULL, 0, 0, NULL, 0, 0};
+    long ignored;
+    EvalStatus status = run_function(ev, prelude, NULL, 0, &ignored, 0);
+    free(ev->funcs[prelude].code);
+    free(ev->funcs[prelude].param_slots);
+    if (status != EVAL_OK) return status;
+
+    return run_function(ev, main_func, NULL, 0, result, 0);
+}
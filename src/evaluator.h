@@ -0,0 +1,96 @@
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include "intermediate.h"
+#include "dataflow.h"
+
+/*
+ * Profundidad máxima de llamadas anidadas durante una evaluación.
+ */
+#define EVAL_MAX_DEPTH          10000
+
+/*
+ * Destino de un CALL a print_int cuando se evalúa el programa completo.
+ */
+#define EVAL_PRINT_INT          (-2)
+
+/*
+ * Resultado de evaluar una llamada en tiempo de compilación.
+ */
+typedef enum {
+    EVAL_OK,
+    EVAL_EXTERN,            // Llegó a una llamada a un externo
+    EVAL_GLOBAL,            // Leyó o escribió una variable global
+    EVAL_BUDGET,            // Superó el presupuesto de pasos
+    EVAL_DEPTH,             // Superó EVAL_MAX_DEPTH llamadas anidadas
+    EVAL_DIV_ZERO,          // División o módulo por cero (o que desborda)
+    EVAL_OUTPUT,            // Superó el máximo de llamadas a print_int registradas
+    EVAL_UNSUPPORTED        // Instrucción que el evaluador no conoce
+} EvalStatus;
+
+/*
+ * Operando ya resuelto: un slot del frame, una global o una constante.
+ */
+typedef struct {
+    int slot;               // -1 si es constante
+    bool global;            // slot es un índice de las globales
+    long value;
+} EvalOperand;
+
+typedef struct {
+    IRInstr op;
+    EvalOperand a;
+    EvalOperand b;
+    int dst;                // Slot del resultado, -1 si no tiene
+    bool dst_global;        // dst es un índice de las globales
+    int target;             // Saltos: instrucción destino; CALL: función llamada (-1 externo)
+    bool global;            // Usa una variable global fuera del programa completo
+} EvalInstr;
+
+/*
+ * Método traducido a instrucciones con slots en lugar de nombres. Se traduce
+ * la primera vez que se lo llama.
+ */
+typedef struct {
+    const char *name;
+    int start;
+    int end;
+    bool compiled;
+    EvalInstr *code;
+    int size;
+    int num_slots;
+    int *param_slots;
+    int num_params;
+    int max_pending;        // CALL_PARAM del cuerpo: tope de la pila de argumentos
+} EvalFunc;
+
+/*
+ * Intérprete del IR para evaluar llamadas en tiempo de compilación. Sólo
+ * evalúa código puro: termina al llegar a un externo o a una global. Al
+ * evaluar el programa completo (ir_eval_program) las globales tienen valor y
+ * las llamadas a print_int se registran en output.
+ */
+typedef struct {
+    IRList *list;
+    EvalFunc *funcs;
+    int num_funcs;
+    StrMap func_map;
+    long budget;            // Pasos por llamada evaluada
+    long steps;
+    bool whole_program;
+    StrMap global_map;
+    long *globals;
+    int num_globals;
+    long *output;           // Argumentos de print_int, en orden
+    int num_output;
+    int max_output;
+} IREvaluator;
+
+void ir_eval_init(IREvaluator *ev, IRList *list, long budget);
+void ir_eval_free(IREvaluator *ev);
+int ir_eval_function(IREvaluator *ev, const char *name);
+EvalStatus ir_eval_call(IREvaluator *ev, int func, const long *args, int num_args, long *result);
+EvalStatus ir_eval_program(IREvaluator *ev, int max_output, long *result);
+const char *ir_eval_status_text(EvalStatus status);
+
+#endif
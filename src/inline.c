@@ -0,0 +1,323 @@
+#include "inline.h"
+#include "optimizer.h"
+#include "callgraph.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Inlining de métodos.
+ *
+ * La lista se parte en piezas: el código previo al primer METHOD, cada EXTERN y
+ * cada función. Del grafo de llamadas salen las funciones recursivas (las que
+ * están en un ciclo), que nunca se inlinean, y el orden de abajo hacia arriba
+ * en que se procesan las demás: cuando se inlinea una llamada, el cuerpo del
+ * callee ya tiene inlineadas sus propias llamadas.
+ *
+ * Los argumentos de una llamada son los CALL_PARAM pendientes: se apilan y cada
+ * CALL saca tantos como parámetros tiene el callee. Si entre un CALL_PARAM y su
+ * CALL hay una etiqueta o un salto (argumentos con cortocircuito) la llamada no
+ * se inlinea.
+ *
+ * Una llamada inlineada guarda cada argumento en una copia del parámetro en el
+ * mismo lugar donde estaba su CALL_PARAM y reemplaza el CALL por el cuerpo del
+ * callee con temporales, etiquetas y variables locales renombradas (las variables
+ * pasan a llamarse "nombre.N", que no choca con ningún identificador del fuente).
+ * Cada RETURN guarda su valor en el temporal del CALL y salta al final del cuerpo.
+ *
+ * El costo de una llamada es el tamaño del cuerpo menos lo que se ahorra: los
+ * CALL_PARAM, el CALL, el RETURN y un poco por cada argumento constante.
+ */
+
+typedef struct {
+    IRCode *codes;
+    int size;
+    int capacity;
+    int orig_start;         // Posición de la pieza en la lista original
+} InlinePiece;
+
+typedef struct {
+    const char *name;
+    int piece;
+    IRSymbol **params;
+    int num_params;
+    bool recursive;
+} InlineFunc;
+
+typedef struct {
+    InlinePiece *pieces;
+    int num_pieces;
+    InlineFunc *funcs;
+    int num_funcs;
+    StrMap func_map;
+    StrMap arities;         // Parámetros de cada método, también de los externos
+    int instance;           // Sufijo de las variables de la próxima copia
+    int inlined;
+    int growth;
+    bool *used;             // Por función: se inlineó en alguna llamada
+} Inliner;
+
+static void piece_emit(InlinePiece *p, IRInstr op, IRSymbol *arg1, IRSymbol *arg2, IRSymbol *result) {
+    if (p->size >= p->capacity) {
+        p->capacity = p->capacity > 0 ? p->capacity * 2 : 16;
+        p->codes = realloc(p->codes, p->capacity * sizeof(IRCode));
+        if (!p->codes) {
+            fprintf(stderr, "Error: no se pudo asignar memoria para el inlining\n");
+            exit(1);
+        }
+    }
+    IRCode *code = &p->codes[p->size++];
+    code->op = op;
+    code->arg1 = arg1;
+    code->arg2 = arg2;
+    code->result = result;
+}
+
+static int body_size(InlinePiece *p) {
+    return ir_body_size(p->codes, 0, p->size);
+}
+
+static void split_pieces(Inliner *in, IRList *list) {
+    in->pieces = df_alloc(list->size, sizeof(InlinePiece));
+    in->funcs = df_alloc(list->size, sizeof(InlineFunc));
+    strmap_init(&in->func_map, 16);
+
+    int i = 0;
+    while (i < list->size) {
+        int end = i + 1;
+        while (end < list->size && list->codes[end].op != IR_METHOD && list->codes[end].op != IR_EXTERN) {
+            end++;
+        }
+
+        InlinePiece *p = &in->pieces[in->num_pieces];
+        p->size = end - i;
+        p->capacity = p->size;
+        p->codes = df_alloc(p->size, sizeof(IRCode));
+        memcpy(p->codes, &list->codes[i], p->size * sizeof(IRCode));
+        p->orig_start = i;
+
+        if (list->codes[i].op == IR_METHOD && list->codes[i].result) {
+            InlineFunc *f = &in->funcs[in->num_funcs];
+            f->name = list->codes[i].result->name;
+            f->piece = in->num_pieces;
+            f->params = df_alloc(p->size, sizeof(IRSymbol *));
+            for (int j = 1; j < p->size; j++) {
+                if (p->codes[j].op == IR_PARAM && p->codes[j].result) {
+                    f->params[f->num_params++] = p->codes[j].result;
+                }
+            }
+            strmap_put(&in->func_map, f->name, in->num_funcs);
+            in->num_funcs++;
+        }
+        in->num_pieces++;
+        i = end;
+    }
+}
+
+/*
+ * Copia el cuerpo del callee en lugar del CALL. params son las copias de los
+ * parámetros donde ya se guardaron los argumentos.
+ */
+static void emit_body(InlinePiece *out, InlinePiece *callee, InlineFunc *func,
+                      IRSymbol **params, int instance, IRSymbol *result) {
+    IRRenamer r;
+    ir_renamer_init(&r, 3 * callee->size + func->num_params, instance);
+    for (int k = 0; k < func->num_params; k++) ir_renamer_bind(&r, func->params[k], params[k]);
+
+    IRSymbol *end_label = NULL;
+    for (int j = 1; j < callee->size; j++) {
+        IRCode *code = &callee->codes[j];
+        if (code->op == IR_PARAM || ir_is_nop(code)) continue;
+        if (code->op == IR_RETURN) {
+            if (code->arg1 && result) {
+                piece_emit(out, IR_LOAD, ir_rename_operand(&r, code->arg1), NULL, result);
+            }
+            if (j < callee->size - 1) {
+                if (!end_label) end_label = new_label_symbol();
+                piece_emit(out, IR_GOTO, NULL, NULL, end_label);
+            }
+            continue;
+        }
+        piece_emit(out, code->op, ir_rename_operand(&r, code->arg1),
+                   ir_rename_operand(&r, code->arg2), ir_rename_operand(&r, code->result));
+    }
+    if (end_label) piece_emit(out, IR_LABEL, NULL, NULL, end_label);
+
+    ir_renamer_free(&r);
+}
+
+/*
+ * Inlinea las llamadas de una función cuyo callee pasa el modelo de costo.
+ */
+static void inline_calls(Inliner *in, int f) {
+    InlineFunc *func = &in->funcs[f];
+    InlinePiece *p = &in->pieces[func->piece];
+    int n = p->size;
+
+    int *call_of = df_alloc(n, sizeof(int));
+    int *first_arg = df_alloc(n, sizeof(int));  // Por CALL: su primer CALL_PARAM
+    int *last_arg = df_alloc(n, sizeof(int));
+    int *next_arg = df_alloc(n, sizeof(int));   // Por CALL_PARAM: el siguiente de la misma llamada
+    IRSymbol **store_to = df_alloc(n, sizeof(IRSymbol *));     // Por CALL_PARAM inlineado
+    IRSymbol ***call_params = df_alloc(n, sizeof(IRSymbol **)); // Por CALL inlineado
+    int *call_instance = df_alloc(n, sizeof(int));
+    int budget = body_size(p) > INLINE_MIN_GROWTH ? body_size(p) : INLINE_MIN_GROWTH;
+    int growth = 0;
+    int count = 0;
+
+    ir_match_call_params(p->codes, n, &in->arities, call_of);
+    for (int i = 0; i < n; i++) first_arg[i] = last_arg[i] = next_arg[i] = -1;
+    for (int i = 0; i < n; i++) {
+        int call = call_of[i];
+        if (call < 0) continue;
+        if (last_arg[call] < 0) first_arg[call] = i;
+        else next_arg[last_arg[call]] = i;
+        last_arg[call] = i;
+    }
+
+    for (int i = 1; i < n; i++) {
+        IRCode *code = &p->codes[i];
+        if (code->op != IR_CALL || !code->arg1) continue;
+        int c = strmap_get(&in->func_map, code->arg1->name);
+        if (c < 0) continue;
+
+        InlineFunc *callee = &in->funcs[c];
+        InlinePiece *cp = &in->pieces[callee->piece];
+        int arity = callee->num_params;
+        int size = body_size(cp);
+        int num_args = 0;
+        int const_args = 0;
+        for (int a = first_arg[i]; a >= 0; a = next_arg[a]) {
+            num_args++;
+            if (is_constant_symbol(p->codes[a].arg1)) const_args++;
+        }
+        int cost = size - (arity + 2) - INLINE_CONST_ARG_BONUS * const_args;
+
+        const char *reason = NULL;
+        char reason_buf[64];
+        if (callee->recursive) {
+            reason = "recursiva";
+        } else if (num_args != arity) {
+            reason = "argumentos con saltos";
+        } else if (cost > inline_threshold) {
+            snprintf(reason_buf, sizeof(reason_buf), "costo %d > umbral %d", cost, inline_threshold);
+            reason = reason_buf;
+        } else if (growth + cp->size > budget) {
+            reason = "fuera del presupuesto de crecimiento";
+        }
+        if (reason) {
+            if (debug_mode) {
+                printf("  [INLINE] Línea %d: %s -> %s no se inlinea (%s)\n",
+                       p->orig_start + i, func->name, callee->name, reason);
+            }
+            continue;
+        }
+
+        int instance = in->instance++;
+        IRSymbol **params = df_alloc(arity, sizeof(IRSymbol *));
+        int k = 0;
+        for (int a = first_arg[i]; a >= 0; a = next_arg[a], k++) {
+            char name[256];
+            snprintf(name, sizeof(name), "%s.%d", callee->params[k]->name, instance);
+            params[k] = new_var_symbol(name);
+            params[k]->data_type = callee->params[k]->data_type;
+            store_to[a] = params[k];
+        }
+        call_params[i] = params;
+        call_instance[i] = instance;
+        growth += cp->size;
+        count++;
+        in->used[c] = true;
+        if (debug_mode) {
+            printf("  [INLINE] Línea %d: %s -> %s inlineada (%d instrucciones, costo %d)\n",
+                   p->orig_start + i, func->name, callee->name, size, cost);
+        }
+    }
+
+    if (count > 0) {
+        InlinePiece out = {NULL, 0, 0, p->orig_start};
+        for (int i = 0; i < n; i++) {
+            IRCode *code = &p->codes[i];
+            if (code->op == IR_CALL_PARAM && store_to[i]) {
+                piece_emit(&out, IR_STORE, code->arg1, NULL, store_to[i]);
+            } else if (code->op == IR_CALL && call_params[i]) {
+                int c = strmap_get(&in->func_map, code->arg1->name);
+                emit_body(&out, &in->pieces[in->funcs[c].piece], &in->funcs[c],
+                          call_params[i], call_instance[i], code->result);
+                free(call_params[i]);
+            } else {
+                piece_emit(&out, code->op, code->arg1, code->arg2, code->result);
+            }
+        }
+        in->growth += out.size - p->size;
+        in->inlined += count;
+        free(p->codes);
+        *p = out;
+    }
+
+    free(call_of);
+    free(first_arg);
+    free(last_arg);
+    free(next_arg);
+    free(store_to);
+    free(call_params);
+    free(call_instance);
+}
+
+int optimize_inlining(IRList *list) {
+    if (inline_threshold <= 0 || list->size == 0) return 0;
+
+    Inliner in;
+    memset(&in, 0, sizeof(in));
+    split_pieces(&in, list);
+    ir_method_arities(list, &in.arities);
+    in.used = df_alloc(in.num_funcs, sizeof(bool));
+
+    CallGraph cg;
+    callgraph_build(&cg, list);
+    for (int k = 0; k < cg.num_nodes; k++) {
+        int f = strmap_get(&in.func_map, cg.nodes[k].name);
+        if (f >= 0) in.funcs[f].recursive = cg.nodes[k].recursive;
+    }
+    for (int k = 0; k < cg.num_nodes; k++) {
+        int f = strmap_get(&in.func_map, cg.nodes[cg.bottom_up[k]].name);
+        if (f >= 0) inline_calls(&in, f);
+    }
+    callgraph_free(&cg);
+
+    if (in.inlined > 0) {
+        int total = 0;
+        for (int k = 0; k < in.num_pieces; k++) total += in.pieces[k].size;
+        IRCode *codes = df_alloc(total, sizeof(IRCode));
+        int pos = 0;
+        for (int k = 0; k < in.num_pieces; k++) {
+            memcpy(&codes[pos], in.pieces[k].codes, in.pieces[k].size * sizeof(IRCode));
+            pos += in.pieces[k].size;
+        }
+        free(list->codes);
+        list->codes = codes;
+        list->size = total;
+        list->capacity = total > 0 ? total : 1;
+    }
+
+    if (in.inlined > 0 && debug_mode) {
+        int funcs = 0;
+        for (int f = 0; f < in.num_funcs; f++) {
+            if (in.used[f]) funcs++;
+        }
+        printf("✓ Inlining: %d llamadas reemplazadas por el cuerpo de %d funciones (umbral %d), +%d instrucciones\n",
+               in.inlined, funcs, inline_threshold, in.growth);
+    }
+
+    int inlined = in.inlined;
+    for (int k = 0; k < in.num_pieces; k++) free(in.pieces[k].codes);
+    for (int f = 0; f < in.num_funcs; f++) {
+        free(in.funcs[f].params);
+    }
+    free(in.pieces);
+    free(in.funcs);
+    free(in.used);
+    strmap_free(&in.func_map);
+    strmap_free(&in.arities);
+    return inlined;
+}
@@ -0,0 +1,20 @@
+#ifndef INLINE_H
+#define INLINE_H
+
+#include "intermediate.h"
+
+/*
+ * Modelo de costo del inlining: cada argumento constante abarata la llamada
+ * (su cuerpo se pliega después) y cada función puede crecer como mucho en su
+ * propio tamaño o en INLINE_MIN_GROWTH instrucciones.
+ */
+#define INLINE_CONST_ARG_BONUS  2
+#define INLINE_MIN_GROWTH       256
+
+/*
+ * Inlining de métodos chicos y no recursivos en sus llamadas.
+ * Devuelve la cantidad de llamadas reemplazadas.
+ */
+int optimize_inlining(IRList *list);
+
+#endif
@@ -1,5 +1,6 @@
 #include "intermediate.h"
 #include "optimizer.h"
+#include "callgraph.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -12,12 +13,21 @@ static const char *ir_names[] = {
     "LOAD", "STORE", "ADD", "SUB", "UMINUS", "MUL", "DIV", "MOD",
     "AND", "OR", "NOT", "EQ", "NEQ", "LT", "LE", "GT", "GE", "LABEL",
     "GOTO", "IF_FALSE", "IF_TRUE", "RETURN", "CALL", "METHOD", "EXTERN",
-    "PARAM", "LOAD_PARAM"
+    "PARAM", "LOAD_PARAM", "IF_EQ", "IF_NEQ", "IF_LT", "IF_LE", "IF_GT", "IF_GE",
+    "MEMO_DIRECT", "MEMO_HASH", "MEMO_LOOKUP", "MEMO_GET", "MEMO_STORE"
 };
 
 static int temp_count = 0;
 static int label_count = 0;
 
+/* Scope de la función que se está generando, para conocer el tipo de sus variables. */
+static SymbolTable *function_scope = NULL;
+
+/* Nombres de las variables declaradas a nivel de programa (nombre -> orden). */
+static StrMap global_names;
+static const char **global_list = NULL;
+static int global_count = 0;
+
 /*
  * Inicializa una lista de instrucciones IR
  */
@@ -63,6 +73,7 @@ IRSymbol *new_temp_symbol() {
     sprintf(buf, "t%d", temp_count++);
     sym->name = strdup(buf);
     sym->type = IR_SYM_TEMP;
+    sym->data_type = TYPE_INTEGER;
     return sym;
 }
 
@@ -81,6 +92,7 @@ IRSymbol *new_label_symbol() {
     sprintf(buf, "L%d", label_count++);
     sym->name = strdup(buf);
     sym->type = IR_SYM_LABEL;
+    sym->data_type = TYPE_VOID;
     return sym;
 }
 
@@ -101,8 +113,10 @@ IRSymbol *new_const_symbol(int value, int is_bool) {
     
     if (is_bool) {
         sym->value.bool_val = value;
+        sym->data_type = TYPE_BOOL;
     } else {
         sym->value.int_val = value;
+        sym->data_type = TYPE_INTEGER;
     }
     return sym;
 }
@@ -119,6 +133,7 @@ IRSymbol *new_var_symbol(const char *name) {
     
     sym->name = strdup(name);
     sym->type = IR_SYM_VAR;
+    sym->data_type = TYPE_INTEGER;
     return sym;
 }
 
@@ -134,6 +149,7 @@ IRSymbol *new_func_symbol(const char *name) {
     
     sym->name = strdup(name);
     sym->type = IR_SYM_FUNC;
+    sym->data_type = TYPE_FUNCTION;
     return sym;
 }
 
@@ -150,6 +166,296 @@ void free_ir_symbol(IRSymbol *sym) {
     }
 }
 
+/*
+ * Registra una variable global. Los optimizadores la tratan como viva al salir
+ * de cada función y como modificable por cualquier llamada.
+ */
+void ir_register_global(const char *name) {
+    if (ir_is_global(name)) return;
+    if (global_count == 0) strmap_init(&global_names, 16);
+    char *copy = strdup(name);
+    global_list = realloc(global_list, (global_count + 1) * sizeof(const char *));
+    if (!copy || !global_list) {
+        fprintf(stderr, "Error: no se pudo registrar la variable global %s\n", name);
+        exit(1);
+    }
+    global_list[global_count] = copy;
+    strmap_put(&global_names, copy, global_count++);
+}
+
+/*
+ * Indica si un nombre corresponde a una variable global. Los análisis lo
+ * consultan por cada operando, así que es una búsqueda en la tabla de hash.
+ */
+int ir_is_global(const char *name) {
+    return ir_global_index(name) >= 0;
+}
+
+/*
+ * Orden de registro de la global (0..ir_global_count() - 1), o -1 si no lo es.
+ */
+int ir_global_index(const char *name) {
+    return global_count > 0 ? strmap_get(&global_names, name) : -1;
+}
+
+int ir_global_count(void) {
+    return global_count;
+}
+
+const char *ir_global_name(int index) {
+    return global_list[index];
+}
+
+/*
+ * Indica si una instrucción es un salto condicional fusionado (IF_EQ ... IF_GE).
+ */
+int ir_is_compare_branch(IRInstr op) {
+    return op >= IR_IF_EQ && op <= IR_IF_GE;
+}
+
+/*
+ * Devuelve el salto fusionado que corresponde a una comparación (LT → IF_LT).
+ * Con negate, el de la condición opuesta (LT → IF_GE).
+ */
+IRInstr ir_branch_for_compare(IRInstr cmp, int negate) {
+    switch (cmp) {
+        case IR_EQ:  return negate ? IR_IF_NEQ : IR_IF_EQ;
+        case IR_NEQ: return negate ? IR_IF_EQ : IR_IF_NEQ;
+        case IR_LT:  return negate ? IR_IF_GE : IR_IF_LT;
+        case IR_LE:  return negate ? IR_IF_GT : IR_IF_LE;
+        case IR_GT:  return negate ? IR_IF_LE : IR_IF_GT;
+        case IR_GE:  return negate ? IR_IF_LT : IR_IF_GE;
+        default:     return cmp;
+    }
+}
+
+/*
+ * Devuelve la comparación que evalúa un salto fusionado (IF_LT → LT).
+ */
+IRInstr ir_compare_for_branch(IRInstr branch) {
+    switch (branch) {
+        case IR_IF_EQ:  return IR_EQ;
+        case IR_IF_NEQ: return IR_NEQ;
+        case IR_IF_LT:  return IR_LT;
+        case IR_IF_LE:  return IR_LE;
+        case IR_IF_GT:  return IR_GT;
+        case IR_IF_GE:  return IR_GE;
+        default:        return branch;
+    }
+}
+
+/*
+ * Comparación del IR que corresponde a un operador relacional del AST, o -1.
+ */
+static int compare_instr_for(int op) {
+    switch (op) {
+        case TOP_COMP:     return IR_EQ;
+        case TOP_DESIGUAL: return IR_NEQ;
+        case TOP_MENOR:    return IR_LT;
+        case TOP_MAYOR:    return IR_GT;
+        case TOP_MENORIG:  return IR_LE;
+        case TOP_MAYORIG:  return IR_GE;
+        default:           return -1;
+    }
+}
+
+/*
+ * Busca una variable en un scope y en sus bloques anidados.
+ */
+static Symbol *find_in_scope_tree(SymbolTable *scope, const char *name) {
+    if (!scope) return NULL;
+    for (int i = 0; i < scope->num_symbols; i++) {
+        if (strcmp(scope->symbols[i].name, name) == 0) return &scope->symbols[i];
+    }
+    for (int i = 0; i < scope->num_children; i++) {
+        Symbol *sym = find_in_scope_tree(scope->children[i], name);
+        if (sym) return sym;
+    }
+    return NULL;
+}
+
+/*
+ * Tipo de una variable de la función actual o global. Las tablas de símbolos
+ * siguen vivas durante la generación de código intermedio.
+ */
+static DataType var_data_type(const char *name) {
+    Symbol *sym = find_in_scope_tree(function_scope, name);
+    if (!sym && global_table) {
+        for (int i = 0; i < global_table->num_symbols; i++) {
+            if (strcmp(global_table->symbols[i].name, name) == 0) {
+                sym = &global_table->symbols[i];
+                break;
+            }
+        }
+    }
+    return sym ? get_type_from_string(sym->type) : TYPE_INTEGER;
+}
+
+/*
+ * Tipo de retorno de un método, según su entrada en la tabla global.
+ */
+static DataType method_return_type(const char *name) {
+    if (!global_table) return TYPE_INTEGER;
+    for (int i = 0; i < global_table->num_symbols; i++) {
+        if (strcmp(global_table->symbols[i].name, name) == 0) {
+            return get_return_type(&global_table->symbols[i]);
+        }
+    }
+    return TYPE_INTEGER;
+}
+
+/*
+ * Crea el símbolo de una variable con su tipo semántico.
+ */
+static IRSymbol *typed_var_symbol(const char *name) {
+    IRSymbol *sym = new_var_symbol(name);
+    sym->data_type = var_data_type(name);
+    return sym;
+}
+
+/*
+ * Indica si la evaluación de una expresión incluye alguna llamada a método.
+ */
+static int contains_call(Nodo *node) {
+    if (!node) return 0;
+    if (node->tipo == NODO_METHOD_CALL) return 1;
+    if (node->tipo == NODO_OP) {
+        return contains_call(node->opBinaria.izq) || contains_call(node->opBinaria.der);
+    }
+    return 0;
+}
+
+/*
+ * Indica si una expresión puede evaluarse aunque su valor no haga falta:
+ * sin llamadas (efectos) ni divisiones (pueden fallar por cero).
+ */
+static int can_evaluate_eagerly(Nodo *node) {
+    if (!node) return 1;
+    if (node->tipo == NODO_METHOD_CALL) return 0;
+    if (node->tipo == NODO_OP) {
+        if (node->opBinaria.op == TOP_DIV || node->opBinaria.op == TOP_RESTO) return 0;
+        return can_evaluate_eagerly(node->opBinaria.izq) && can_evaluate_eagerly(node->opBinaria.der);
+    }
+    return 1;
+}
+
+/*
+ * Genera el operando de una instrucción. Las constantes y las variables se usan
+ * directamente, sin cargarlas antes en un temporal; el resto se evalúa con gen_code().
+ */
+static IRSymbol *gen_operand(Nodo *node, IRList *list) {
+    if (node) {
+        switch (node->tipo) {
+            case NODO_INTEGER:
+                return new_const_symbol(node->val_int, 0);
+            case NODO_BOOL:
+                return new_const_symbol(node->val_bool, 1);
+            case NODO_ID:
+                if (node->nombre) return typed_var_symbol(node->nombre);
+                break;
+            default:
+                break;
+        }
+    }
+    return gen_code(node, list);
+}
+
+static void gen_jump_if_true(Nodo *cond, IRList *list, IRSymbol *label_true);
+
+/*
+ * Emite un salto fusionado (IF_LT a, b, L) con los operandos de una comparación.
+ */
+static void gen_compare_branch(Nodo *cond, IRList *list, IRInstr branch, IRSymbol *label) {
+    IRSymbol *left = contains_call(cond->opBinaria.der)
+        ? gen_code(cond->opBinaria.izq, list)
+        : gen_operand(cond->opBinaria.izq, list);
+    IRSymbol *right = gen_operand(cond->opBinaria.der, list);
+    ir_emit(list, branch, left, right, label);
+}
+
+/*
+ * Genera código de saltos para una condición: salta a label_false si es falsa y
+ * sigue de largo si es verdadera. && y || se evalúan en cortocircuito, así que el
+ * operando derecho sólo se calcula cuando hace falta.
+ */
+static void gen_jump_if_false(Nodo *cond, IRList *list, IRSymbol *label_false) {
+    if (cond->tipo == NODO_BOOL) {
+        if (!cond->val_bool) ir_emit(list, IR_GOTO, NULL, NULL, label_false);
+        return;
+    }
+    
+    if (cond->tipo == NODO_OP) {
+        switch (cond->opBinaria.op) {
+            case TOP_AND:
+                gen_jump_if_false(cond->opBinaria.izq, list, label_false);
+                gen_jump_if_false(cond->opBinaria.der, list, label_false);
+                return;
+            case TOP_OR: {
+                IRSymbol *label_true = new_label_symbol();
+                gen_jump_if_true(cond->opBinaria.izq, list, label_true);
+                gen_jump_if_false(cond->opBinaria.der, list, label_false);
+                ir_emit(list, IR_LABEL, NULL, NULL, label_true);
+                return;
+            }
+            case TOP_NOT:
+                gen_jump_if_true(cond->opBinaria.der, list, label_false);
+                return;
+            default:
+                break;
+        }
+        
+        // Una comparación que sólo alimenta el salto se fusiona con él
+        int cmp = compare_instr_for(cond->opBinaria.op);
+        if (cmp >= 0) {
+            gen_compare_branch(cond, list, ir_branch_for_compare(cmp, 1), label_false);
+            return;
+        }
+    }
+    
+    IRSymbol *value = gen_operand(cond, list);
+    ir_emit(list, IR_IF_FALSE, value, NULL, label_false);
+}
+
+/*
+ * Simétrica a gen_jump_if_false(): salta a label_true si la condición es verdadera.
+ */
+static void gen_jump_if_true(Nodo *cond, IRList *list, IRSymbol *label_true) {
+    if (cond->tipo == NODO_BOOL) {
+        if (cond->val_bool) ir_emit(list, IR_GOTO, NULL, NULL, label_true);
+        return;
+    }
+    
+    if (cond->tipo == NODO_OP) {
+        switch (cond->opBinaria.op) {
+            case TOP_OR:
+                gen_jump_if_true(cond->opBinaria.izq, list, label_true);
+                gen_jump_if_true(cond->opBinaria.der, list, label_true);
+                return;
+            case TOP_AND: {
+                IRSymbol *label_false = new_label_symbol();
+                gen_jump_if_false(cond->opBinaria.izq, list, label_false);
+                gen_jump_if_true(cond->opBinaria.der, list, label_true);
+                ir_emit(list, IR_LABEL, NULL, NULL, label_false);
+                return;
+            }
+            case TOP_NOT:
+                gen_jump_if_false(cond->opBinaria.der, list, label_true);
+                return;
+            default:
+                break;
+        }
+        
+        int cmp = compare_instr_for(cond->opBinaria.op);
+        if (cmp >= 0) {
+            gen_compare_branch(cond, list, ir_branch_for_compare(cmp, 0), label_true);
+            return;
+        }
+    }
+    
+    IRSymbol *value = gen_operand(cond, list);
+    ir_emit(list, IR_IF_TRUE, value, NULL, label_true);
+}
+
 /*
  * Convierte recursivamente cada nodo del árbol sintáctico en una secuencia de instrucciones IR.
  */
@@ -167,6 +473,7 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
         case NODO_BOOL: {
             IRSymbol *const_sym = new_const_symbol(node->val_bool, 1);
             IRSymbol *temp = new_temp_symbol();
+            temp->data_type = TYPE_BOOL;
             ir_emit(list, IR_LOAD, const_sym, NULL, temp);
             return temp;
         }
@@ -177,18 +484,42 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
                 return NULL;
             }
             
-            IRSymbol *var_sym = new_var_symbol(node->nombre);
+            IRSymbol *var_sym = typed_var_symbol(node->nombre);
             IRSymbol *temp = new_temp_symbol();
+            temp->data_type = var_sym->data_type;
             ir_emit(list, IR_LOAD, var_sym, NULL, temp);
             return temp;
         }
 
         case NODO_OP: {
             IRSymbol *temp = new_temp_symbol();
+            if (node->opBinaria.op == TOP_AND || node->opBinaria.op == TOP_OR ||
+                node->opBinaria.op == TOP_NOT || compare_instr_for(node->opBinaria.op) >= 0) {
+                temp->data_type = TYPE_BOOL;
+            }
             
+            // && y || como valor con un operando derecho sin efectos: AND/OR sobre bools,
+            // sin saltos (evaluarlo siempre no cambia el resultado)
+            if ((node->opBinaria.op == TOP_AND || node->opBinaria.op == TOP_OR) &&
+                can_evaluate_eagerly(node->opBinaria.der)) {
+                IRSymbol *left = gen_operand(node->opBinaria.izq, list);
+                IRSymbol *right = gen_operand(node->opBinaria.der, list);
+                ir_emit(list, node->opBinaria.op == TOP_AND ? IR_AND : IR_OR, left, right, temp);
+            }
+            // && y || como valor: saltos en cortocircuito que cargan 1 o 0 en el temporal
+            else if (node->opBinaria.op == TOP_AND || node->opBinaria.op == TOP_OR) {
+                IRSymbol *label_false = new_label_symbol();
+                IRSymbol *label_end = new_label_symbol();
+                gen_jump_if_false(node, list, label_false);
+                ir_emit(list, IR_LOAD, new_const_symbol(1, 1), NULL, temp);
+                ir_emit(list, IR_GOTO, NULL, NULL, label_end);
+                ir_emit(list, IR_LABEL, NULL, NULL, label_false);
+                ir_emit(list, IR_LOAD, new_const_symbol(0, 1), NULL, temp);
+                ir_emit(list, IR_LABEL, NULL, NULL, label_end);
+            }
             // Para operador unario NOT
-            if (node->opBinaria.op == TOP_NOT) {
-                IRSymbol *operand = gen_code(node->opBinaria.der, list);
+            else if (node->opBinaria.op == TOP_NOT) {
+                IRSymbol *operand = gen_operand(node->opBinaria.der, list);
                 ir_emit(list, IR_NOT, operand, NULL, temp);
             } 
             // Para menos unario (si izq es 0 y der existe, es menos unario)
@@ -196,13 +527,17 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
                      node->opBinaria.izq && 
                      node->opBinaria.izq->tipo == NODO_INTEGER && 
                      node->opBinaria.izq->val_int == 0) {
-                IRSymbol *operand = gen_code(node->opBinaria.der, list);
+                IRSymbol *operand = gen_operand(node->opBinaria.der, list);
                 ir_emit(list, IR_UMINUS, operand, NULL, temp);
             }
             // Operadores binarios
             else {
-                IRSymbol *left = gen_code(node->opBinaria.izq, list);
-                IRSymbol *right = gen_code(node->opBinaria.der, list);
+                // Si el operando derecho llama a un método, la variable de la izquierda
+                // se lee antes de la llamada (la llamada puede modificar una global)
+                IRSymbol *left = contains_call(node->opBinaria.der)
+                    ? gen_code(node->opBinaria.izq, list)
+                    : gen_operand(node->opBinaria.izq, list);
+                IRSymbol *right = gen_operand(node->opBinaria.der, list);
                 
                 switch (node->opBinaria.op) {
                     case TOP_SUMA:
@@ -238,12 +573,6 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
                     case TOP_MAYORIG:
                         ir_emit(list, IR_GE, left, right, temp);
                         break;
-                    case TOP_AND:
-                        ir_emit(list, IR_AND, left, right, temp);
-                        break;
-                    case TOP_OR:
-                        ir_emit(list, IR_OR, left, right, temp);
-                        break;
                     default:
                         fprintf(stderr, "Operador binario no soportado: %d\n", node->opBinaria.op);
                         break;
@@ -258,13 +587,13 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
                 return NULL;
             }
             
-            IRSymbol *rhs = gen_code(node->assign.expr, list);
+            IRSymbol *rhs = gen_operand(node->assign.expr, list);
             if (!rhs) {
                 fprintf(stderr, "Error: no se pudo generar código para la expresión en assign\n");
                 return NULL;
             }
             
-            IRSymbol *var_sym = new_var_symbol(node->assign.id);
+            IRSymbol *var_sym = typed_var_symbol(node->assign.id);
             ir_emit(list, IR_STORE, rhs, NULL, var_sym);
             return var_sym;
         }
@@ -277,9 +606,9 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
             
             // Si hay inicialización, generar código para la expresión
             if (node->assign.expr) {
-                IRSymbol *rhs = gen_code(node->assign.expr, list);
+                IRSymbol *rhs = gen_operand(node->assign.expr, list);
                 if (rhs) {
-                    IRSymbol *var_sym = new_var_symbol(node->assign.id);
+                    IRSymbol *var_sym = typed_var_symbol(node->assign.id);
                     ir_emit(list, IR_STORE, rhs, NULL, var_sym);
                 }
             }
@@ -310,12 +639,13 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
                 // Método normal - generar implementación
                 IRSymbol *func_sym = new_func_symbol(node->method.nombre);
                 ir_emit(list, IR_METHOD, NULL, NULL, func_sym);
+                function_scope = get_function_scope(node->method.nombre);
                 
                 // Generar parámetros
                 Nodo *param = node->method.params;
                 while (param) {
                     if (param->nombre) {
-                        IRSymbol *param_sym = new_var_symbol(param->nombre);
+                        IRSymbol *param_sym = typed_var_symbol(param->nombre);
                         ir_emit(list, IR_PARAM, NULL, NULL, param_sym);
                     }
                     param = param->siguiente;
@@ -327,6 +657,7 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
                     gen_code(stmt, list);
                     stmt = stmt->siguiente;
                 }
+                function_scope = NULL;
             }
             break;
         }
@@ -340,7 +671,7 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
             if (node->method_call.args) {
                 Nodo *arg = node->method_call.args;
                 while (arg) {
-                    IRSymbol *arg_temp = gen_code(arg, list);
+                    IRSymbol *arg_temp = gen_operand(arg, list);
                     if (arg_temp) {
                         ir_emit(list, IR_CALL_PARAM, arg_temp, NULL, NULL);
                     }
@@ -350,6 +681,7 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
             
             IRSymbol *func_sym = new_func_symbol(node->method_call.nombre);
             IRSymbol *temp = new_temp_symbol();
+            temp->data_type = method_return_type(node->method_call.nombre);
             
             ir_emit(list, IR_CALL, func_sym, NULL, temp);
             return temp;
@@ -361,18 +693,12 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
                 break;
             }
             
-            IRSymbol *cond = gen_code(node->if_stmt.cond, list);
-            if (!cond) {
-                fprintf(stderr, "Error: no se pudo generar código para condición IF\n");
-                break;
-            }
-            
             IRSymbol *label_end = new_label_symbol();
             
             // Si hay else
             if (node->if_stmt.else_block) {
                 IRSymbol *label_else = new_label_symbol();
-                ir_emit(list, IR_IF_FALSE, cond, NULL, label_else);
+                gen_jump_if_false(node->if_stmt.cond, list, label_else);
                 
                 // Procesar todas las sentencias del then
                 Nodo *stmt = node->if_stmt.then_block;
@@ -392,7 +718,7 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
                 }
             } else {
                 // Solo if
-                ir_emit(list, IR_IF_FALSE, cond, NULL, label_end);
+                gen_jump_if_false(node->if_stmt.cond, list, label_end);
                 
                 // Procesar todas las sentencias del then
                 Nodo *stmt = node->if_stmt.then_block;
@@ -416,13 +742,7 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
             IRSymbol *label_end = new_label_symbol();
             
             ir_emit(list, IR_LABEL, NULL, NULL, label_start);
-            IRSymbol *cond = gen_code(node->while_stmt.cond, list);
-            if (!cond) {
-                fprintf(stderr, "Error: no se pudo generar código para condición WHILE\n");
-                break;
-            }
-            
-            ir_emit(list, IR_IF_FALSE, cond, NULL, label_end);
+            gen_jump_if_false(node->while_stmt.cond, list, label_end);
             
             // Procesar todas las sentencias del cuerpo del while
             Nodo *stmt = node->while_stmt.body;
@@ -438,7 +758,7 @@ IRSymbol *gen_code(Nodo *node, IRList *list) {
 
         case NODO_RETURN: {
             if (node->ret_expr) {
-                IRSymbol *ret_val = gen_code(node->ret_expr, list);
+                IRSymbol *ret_val = gen_operand(node->ret_expr, list);
                 ir_emit(list, IR_RETURN, ret_val, NULL, NULL);
             } else {
                 ir_emit(list, IR_RETURN, NULL, NULL, NULL);
@@ -536,9 +856,33 @@ void ir_print(IRList *list) {
                 break;
             
             case IR_CALL_PARAM:
+            case IR_MEMO_DIRECT:
+            case IR_MEMO_HASH:
                 if (code->arg1) printf(" %s", code->arg1->name);
                 break;
 
+            case IR_MEMO_LOOKUP:
+            case IR_MEMO_GET:
+                if (code->arg1) printf(" %s", code->arg1->name);
+                if (code->result) printf(", %s", code->result->name);
+                break;
+
+            case IR_MEMO_STORE:
+                if (code->arg1) printf(" %s", code->arg1->name);
+                if (code->arg2) printf(", %s", code->arg2->name);
+                break;
+
+            case IR_IF_EQ:
+            case IR_IF_NEQ:
+            case IR_IF_LT:
+            case IR_IF_LE:
+            case IR_IF_GT:
+            case IR_IF_GE:
+                if (code->arg1) printf(" %s", code->arg1->name);
+                if (code->arg2) printf(", %s", code->arg2->name);
+                if (code->result) printf(", %s", code->result->name);
+                break;
+
             default:
                 break;
         }
@@ -632,7 +976,31 @@ void ir_save_to_file(IRList *list, const char *filename) {
                 break;
 
             case IR_CALL_PARAM:
+            case IR_MEMO_DIRECT:
+            case IR_MEMO_HASH:
+                if (code->arg1) fprintf(file, " %s", code->arg1->name);
+                break;
+
+            case IR_MEMO_LOOKUP:
+            case IR_MEMO_GET:
                 if (code->arg1) fprintf(file, " %s", code->arg1->name);
+                if (code->result) fprintf(file, ", %s", code->result->name);
+                break;
+
+            case IR_MEMO_STORE:
+                if (code->arg1) fprintf(file, " %s", code->arg1->name);
+                if (code->arg2) fprintf(file, ", %s", code->arg2->name);
+                break;
+
+            case IR_IF_EQ:
+            case IR_IF_NEQ:
+            case IR_IF_LT:
+            case IR_IF_LE:
+            case IR_IF_GT:
+            case IR_IF_GE:
+                if (code->arg1) fprintf(file, " %s", code->arg1->name);
+                if (code->arg2) fprintf(file, ", %s", code->arg2->name);
+                if (code->result) fprintf(file, ", %s", code->result->name);
                 break;
                 
             default:
@@ -681,13 +1049,40 @@ int generate_intermediate_code(Nodo *ast) {
     if (ast->tipo == NODO_ID && strcmp(ast->nombre, "program") == 0) {
         Nodo *current = ast->siguiente;
         while (current) {
-            gen_code(current, &ir_list);
+            if (current->tipo == NODO_DECL && current->assign.id) {
+                ir_register_global(current->assign.id);
+            }
+            current = current->siguiente;
+        }
+
+        /*
+         * Los inicializadores de variables globales se emiten antes del primer
+         * METHOD, en el orden del fuente: el código de nivel superior es el que
+         * precede a los métodos, y un STORE tras un método caería dentro del
+         * rango de esa función.
+         */
+        current = ast->siguiente;
+        while (current) {
+            if (current->tipo == NODO_DECL) gen_code(current, &ir_list);
+            current = current->siguiente;
+        }
+
+        current = ast->siguiente;
+        while (current) {
+            if (current->tipo != NODO_DECL) gen_code(current, &ir_list);
             current = current->siguiente;
         }
     } else {
         gen_code(ast, &ir_list);
     }
     
+    if (dump_callgraph) {
+        CallGraph cg;
+        callgraph_build(&cg, &ir_list);
+        callgraph_dump(&cg);
+        callgraph_free(&cg);
+    }
+    
     // Aplicar optimizaciones al código intermedio solo si están habilitadas
     if (optimizer_enabled) {
         if (debug_mode) {
@@ -3,6 +3,7 @@
 
 #include "ast.h"
 #include "symtab.h"
+#include "semantics.h"
 
 /*
  * Tipos de instrucciones
@@ -34,7 +35,18 @@ typedef enum {
     IR_METHOD,
     IR_EXTERN,
     IR_PARAM,
-    IR_CALL_PARAM
+    IR_CALL_PARAM,
+    IR_IF_EQ,       // Saltos condicionales fusionados: IF_LT a, b, L salta a L si a < b
+    IR_IF_NEQ,
+    IR_IF_LT,
+    IR_IF_LE,
+    IR_IF_GT,
+    IR_IF_GE,
+    IR_MEMO_DIRECT, // Tabla de memoización de la función: MEMO_DIRECT n (índice = clave mod n)
+    IR_MEMO_HASH,   // MEMO_HASH n (índice = hash multiplicativo de la clave)
+    IR_MEMO_LOOKUP, // MEMO_LOOKUP k, t: t = 1 si la tabla tiene un valor para la clave k
+    IR_MEMO_GET,    // MEMO_GET k, t: t = valor guardado para k
+    IR_MEMO_STORE   // MEMO_STORE k, v: guarda v para la clave k
 } IRInstr;
 
 /*
@@ -53,6 +65,7 @@ typedef struct IRSymbol {
         int int_val;
         int bool_val;
     } value;
+    DataType data_type;     // TYPE_BOOL garantiza que el valor es 0 o 1
 } IRSymbol;
 
 typedef struct IRCode {
@@ -84,6 +97,16 @@ IRSymbol *new_var_symbol(const char *name);
 IRSymbol *new_func_symbol(const char *name);
 void free_ir_sybol(IRSymbol *sym);
 
+void ir_register_global(const char *name);
+int ir_is_global(const char *name);
+int ir_global_index(const char *name);
+int ir_global_count(void);
+const char *ir_global_name(int index);
+
+int ir_is_compare_branch(IRInstr op);
+IRInstr ir_branch_for_compare(IRInstr cmp, int negate);
+IRInstr ir_compare_for_branch(IRInstr branch);
+
 IRSymbol *gen_code(Nodo *node, IRList *list);
 int generate_intermediate_code(Nodo *ast);
 
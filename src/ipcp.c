@@ -0,0 +1,267 @@
+#include "ipcp.h"
+#include "optimizer.h"
+#include "dataflow.h"
+#include "evaluator.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Propagación interprocedural de constantes.
+ *
+ * Evaluación de llamadas: un CALL a un método del programa con todos sus
+ * argumentos constantes se ejecuta en el evaluador del IR. Si termina dentro
+ * del presupuesto sin llegar a un externo ni a una global, la llamada se
+ * reemplaza por LOAD del resultado y sus CALL_PARAM desaparecen. Las funciones
+ * que no se pudieron evaluar por impuras o por el presupuesto no se vuelven a
+ * intentar.
+ *
+ * Parámetros constantes: si todas las llamadas a un método le pasan la misma
+ * constante en un parámetro, el parámetro deja de serlo. Las llamadas dejan de
+ * pasar ese argumento y el método empieza con un STORE de la constante, que
+ * SCCP propaga por el cuerpo. Si alguna llamada no se puede emparejar con sus
+ * argumentos, el método no se toca.
+ *
+ * Las dos cosas se repiten junto con SCCP hasta que no cambia nada: un
+ * parámetro constante puede volver constantes los argumentos de las llamadas
+ * que hace el método, y una llamada evaluada los de las siguientes.
+ */
+
+typedef struct {
+    const char *name;
+    int start;
+    int end;
+    int num_params;
+    int num_sites;
+    bool unknown;           // Alguna llamada sin argumentos emparejados
+    IRSymbol **value;       // Por parámetro: la constante de todas las llamadas
+    bool *varies;
+} IPCPFunc;
+
+/*
+ * Índices de los CALL_PARAM del CALL en pos (relativo a start), en orden.
+ * Devuelve cuántos hay.
+ */
+static int call_args(int *call_of, int pos, int *args) {
+    int count = 0;
+    for (int a = 0; a < pos; a++) {
+        if (call_of[a] == pos) args[count++] = a;
+    }
+    return count;
+}
+
+static void describe_call(char *buf, size_t size, const char *name, long *values, int count) {
+    size_t len = snprintf(buf, size, "%s(", name);
+    for (int k = 0; k < count && len < size; k++) {
+        len += snprintf(buf + len, size - len, "%s%ld", k > 0 ? ", " : "", values[k]);
+    }
+    if (len < size) snprintf(buf + len, size - len, ")");
+}
+
+/*
+ * Reemplaza por su resultado las llamadas con argumentos constantes que el
+ * evaluador puede ejecutar. Devuelve cuántas reemplazó.
+ */
+static int evaluate_pure_calls(IRList *list, StrMap *failed) {
+    StrMap arities;
+    ir_method_arities(list, &arities);
+    IREvaluator ev;
+    ir_eval_init(&ev, list, eval_steps);
+
+    int evaluated = 0;
+    char desc[512];
+    for (int k = 0; k < ev.num_funcs; k++) {
+        int start = ev.funcs[k].start, n = ev.funcs[k].end - start;
+        int *call_of = df_alloc(n, sizeof(int));
+        int *args = df_alloc(n, sizeof(int));
+        long *values = df_alloc(n, sizeof(long));
+        ir_match_call_params(&list->codes[start], n, &arities, call_of);
+
+        for (int j = 0; j < n; j++) {
+            IRCode *code = &list->codes[start + j];
+            if (code->op != IR_CALL || !code->arg1) continue;
+            int callee = ir_eval_function(&ev, code->arg1->name);
+            if (callee < 0 || strmap_get(failed, code->arg1->name) >= 0) continue;
+
+            int count = call_args(call_of, j, args);
+            if (count != strmap_get(&arities, code->arg1->name)) continue;
+            bool constant = true;
+            for (int a = 0; a < count && constant; a++) {
+                IRSymbol *arg = list->codes[start + args[a]].arg1;
+                if (!is_constant_symbol(arg)) constant = false;
+                else values[a] = atol(arg->name);
+            }
+            if (!constant) continue;
+
+            long result;
+            EvalStatus status = ir_eval_call(&ev, callee, values, count, &result);
+            describe_call(desc, sizeof(desc), code->arg1->name, values, count);
+            if (status != EVAL_OK) {
+                if (debug_mode) {
+                    printf("  [IPCP] Línea %d: %s no se evalúa (%s)\n", start + j, desc, ir_eval_status_text(status));
+                }
+                if (status != EVAL_DIV_ZERO) strmap_put(failed, code->arg1->name, 1);
+                continue;
+            }
+            if (result < INT_MIN || result > INT_MAX) {
+                if (debug_mode) printf("  [IPCP] Línea %d: %s no se evalúa (resultado fuera de rango)\n", start + j, desc);
+                continue;
+            }
+
+            if (debug_mode) {
+                printf("  [IPCP] Línea %d: %s = %ld evaluada en compilación (%ld pasos)\n", start + j, desc, result, ev.steps);
+            }
+            for (int a = 0; a < count; a++) mark_instruction_as_nop(list, start + args[a]);
+            if (code->result) {
+                replace_instruction(list, start + j, IR_LOAD,
+                                    new_const_symbol((int)result, code->result->data_type == TYPE_BOOL),
+                                    NULL, code->result);
+            } else {
+                mark_instruction_as_nop(list, start + j);
+            }
+            evaluated++;
+        }
+        free(call_of);
+        free(args);
+        free(values);
+    }
+
+    ir_eval_free(&ev);
+    strmap_free(&arities);
+    compact_ir_list(list);
+    return evaluated;
+}
+
+/*
+ * Convierte en constantes los parámetros que reciben la misma constante en
+ * todas las llamadas. Devuelve cuántos convirtió.
+ */
+static int propagate_parameters(IRList *list) {
+    StrMap arities, func_map;
+    ir_method_arities(list, &arities);
+    strmap_init(&func_map, 16);
+    IPCPFunc *funcs = df_alloc(list->size, sizeof(IPCPFunc));
+    int num_funcs = 0;
+    for (int i = 0; i < list->size; i++) {
+        if (list->codes[i].op != IR_METHOD || !list->codes[i].result) continue;
+        IPCPFunc *f = &funcs[num_funcs];
+        f->name = list->codes[i].result->name;
+        f->start = i;
+        f->end = ir_function_end(list, i);
+        f->num_params = strmap_get(&arities, f->name);
+        f->value = df_alloc(f->num_params, sizeof(IRSymbol *));
+        f->varies = df_alloc(f->num_params, sizeof(bool));
+        strmap_put(&func_map, f->name, num_funcs++);
+    }
+
+    // Argumentos de cada llamada: se recuerdan sus posiciones para borrarlos
+    int *site_args = df_alloc(list->size, sizeof(int));
+    int *site_callee = df_alloc(list->size, sizeof(int));
+    int *site_param = df_alloc(list->size, sizeof(int));
+    int num_site_args = 0;
+    for (int k = 0; k < num_funcs; k++) {
+        int start = funcs[k].start, n = funcs[k].end - start;
+        int *call_of = df_alloc(n, sizeof(int));
+        int *args = df_alloc(n, sizeof(int));
+        ir_match_call_params(&list->codes[start], n, &arities, call_of);
+        for (int j = 0; j < n; j++) {
+            IRCode *code = &list->codes[start + j];
+            if (code->op != IR_CALL || !code->arg1) continue;
+            int callee = strmap_get(&func_map, code->arg1->name);
+            if (callee < 0) continue;
+            IPCPFunc *g = &funcs[callee];
+            int count = call_args(call_of, j, args);
+            if (count != g->num_params) {
+                g->unknown = true;
+                continue;
+            }
+            g->num_sites++;
+            for (int p = 0; p < count; p++) {
+                IRSymbol *arg = list->codes[start + args[p]].arg1;
+                if (!is_constant_symbol(arg)) g->varies[p] = true;
+                else if (!g->value[p]) g->value[p] = arg;
+                else if (strcmp(g->value[p]->name, arg->name) != 0) g->varies[p] = true;
+                site_args[num_site_args] = start + args[p];
+                site_callee[num_site_args] = callee;
+                site_param[num_site_args] = p;
+                num_site_args++;
+            }
+        }
+        free(call_of);
+        free(args);
+    }
+
+    int propagated = 0;
+    for (int k = 0; k < num_funcs; k++) {
+        IPCPFunc *f = &funcs[k];
+        bool main_func = strcmp(f->name, "main") == 0;
+        for (int p = 0; p < f->num_params; p++) {
+            if (main_func || f->unknown || f->num_sites == 0 || f->varies[p]) f->value[p] = NULL;
+            if (!f->value[p]) continue;
+            propagated++;
+            if (debug_mode) {
+                printf("  [IPCP] %s: parámetro %s = %s en todas las llamadas (%d)\n", f->name,
+                       list->codes[f->start + 1 + p].result->name, f->value[p]->name, f->num_sites);
+            }
+        }
+    }
+
+    if (propagated > 0) {
+        // Primero los argumentos (sin mover índices), después los encabezados de atrás hacia adelante
+        for (int s = 0; s < num_site_args; s++) {
+            if (funcs[site_callee[s]].value[site_param[s]]) mark_instruction_as_nop(list, site_args[s]);
+        }
+        for (int k = num_funcs - 1; k >= 0; k--) {
+            IPCPFunc *f = &funcs[k];
+            IRCode *header = df_alloc(2 * f->num_params, sizeof(IRCode));
+            int count = 0;
+            bool changed = false;
+            for (int p = 0; p < f->num_params; p++) {
+                if (!f->value[p]) header[count++] = list->codes[f->start + 1 + p];
+                else changed = true;
+            }
+            for (int p = 0; p < f->num_params; p++) {
+                if (f->value[p]) {
+                    header[count++] = (IRCode){IR_STORE, f->value[p], NULL, list->codes[f->start + 1 + p].result};
+                }
+            }
+            if (changed) ir_replace_range(list, f->start + 1, f->start + 1 + f->num_params, header, count);
+            free(header);
+        }
+        compact_ir_list(list);
+    }
+
+    for (int k = 0; k < num_funcs; k++) {
+        free(funcs[k].value);
+        free(funcs[k].varies);
+    }
+    free(funcs);
+    free(site_args);
+    free(site_callee);
+    free(site_param);
+    strmap_free(&func_map);
+    strmap_free(&arities);
+    return propagated;
+}
+
+void optimize_interprocedural_constants(IRList *list) {
+    StrMap failed;          // Funciones que no se pueden evaluar
+    strmap_init(&failed, 16);
+    int evaluated = 0, propagated = 0;
+
+    for (int round = 0; round < IPCP_MAX_ROUNDS; round++) {
+        int calls = eval_steps > 0 ? evaluate_pure_calls(list, &failed) : 0;
+        int params = propagate_parameters(list);
+        evaluated += calls;
+        propagated += params;
+        if (calls + params == 0) break;
+        optimize_constant_propagation(list);
+    }
+    strmap_free(&failed);
+
+    if (evaluated + propagated > 0 && debug_mode) {
+        printf("✓ Propagación interprocedural: %d parámetros constantes, %d llamadas evaluadas en compilación\n",
+               propagated, evaluated);
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef IPCP_H
+#define IPCP_H
+
+#include "intermediate.h"
+
+/*
+ * Vueltas de evaluación de llamadas + propagación de parámetros + SCCP: cada
+ * una puede dejar constantes nuevas para la siguiente.
+ */
+#define IPCP_MAX_ROUNDS         4
+
+/*
+ * Propagación interprocedural de constantes: los parámetros que reciben la
+ * misma constante en todas las llamadas pasan a ser esa constante, y las
+ * llamadas a funciones puras con argumentos constantes se evalúan en tiempo de
+ * compilación (con un presupuesto de -eval-steps pasos por llamada).
+ */
+void optimize_interprocedural_constants(IRList *list);
+
+#endif
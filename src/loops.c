@@ -0,0 +1,1260 @@
+#include "loops.h"
+#include "optimizer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/*
+ * Indica si el bloque a domina al bloque b, subiendo por los dominadores inmediatos.
+ */
+bool block_dominates(SSAGraph *ssa, int a, int b) {
+    if (ssa->idom[b] < 0) return false;
+    while (b != a) {
+        if (ssa->idom[b] == b) return false;
+        b = ssa->idom[b];
+    }
+    return true;
+}
+
+bool loop_contains(Loop *loop, int block) {
+    return bitset_test(&loop->body, block);
+}
+
+static int compare_loops(const void *a, const void *b) {
+    const Loop *x = a, *y = b;
+    if (x->num_blocks != y->num_blocks) return y->num_blocks - x->num_blocks;
+    return x->header - y->header;
+}
+
+/*
+ * Encuentra los loops naturales de la función: cada arista cuyo destino domina a
+ * su origen es una arista de vuelta, y el cuerpo son los bloques desde los que se
+ * llega al latch sin pasar por el header.
+ */
+void loop_nest_build(LoopNest *nest, CFG *cfg, SSAGraph *ssa) {
+    int nb = cfg->num_blocks;
+    nest->cfg = cfg;
+    nest->ssa = ssa;
+    nest->loops = df_alloc(nb, sizeof(Loop));
+    nest->num_loops = 0;
+    nest->innermost = df_alloc(nb, sizeof(int));
+
+    int *loop_of_header = df_alloc(nb, sizeof(int));
+    int *stack = df_alloc(nb, sizeof(int));
+    for (int b = 0; b < nb; b++) loop_of_header[b] = -1;
+
+    for (int r = 0; r < cfg->num_reachable; r++) {
+        int latch = cfg->rpo_order[r];
+        BasicBlock *bb = &cfg->blocks[latch];
+        for (int s = 0; s < bb->num_succs; s++) {
+            int header = bb->succs[s];
+            if (!block_dominates(ssa, header, latch)) continue;
+
+            if (loop_of_header[header] < 0) {
+                Loop *loop = &nest->loops[nest->num_loops];
+                loop->header = header;
+                bitset_init(&loop->body, nb);
+                bitset_set(&loop->body, header);
+                loop->latches = df_alloc(cfg->blocks[header].num_preds, sizeof(int));
+                loop->num_latches = 0;
+                loop_of_header[header] = nest->num_loops++;
+            }
+            Loop *loop = &nest->loops[loop_of_header[header]];
+            loop->latches[loop->num_latches++] = latch;
+
+            int sp = 0;
+            if (!bitset_test(&loop->body, latch)) {
+                bitset_set(&loop->body, latch);
+                stack[sp++] = latch;
+            }
+            while (sp > 0) {
+                BasicBlock *block = &cfg->blocks[stack[--sp]];
+                for (int p = 0; p < block->num_preds; p++) {
+                    int pred = block->preds[p];
+                    if (cfg->blocks[pred].rpo >= 0 && !bitset_test(&loop->body, pred)) {
+                        bitset_set(&loop->body, pred);
+                        stack[sp++] = pred;
+                    }
+                }
+            }
+        }
+    }
+    free(loop_of_header);
+    free(stack);
+
+    for (int l = 0; l < nest->num_loops; l++) {
+        Loop *loop = &nest->loops[l];
+        loop->num_blocks = bitset_count(&loop->body);
+        loop->blocks = df_alloc(loop->num_blocks, sizeof(int));
+        int k = 0;
+        for (int r = 0; r < cfg->num_reachable; r++) {
+            if (bitset_test(&loop->body, cfg->rpo_order[r])) loop->blocks[k++] = cfg->rpo_order[r];
+        }
+    }
+
+    // De afuera hacia adentro: un loop contenido en otro tiene menos bloques
+    qsort(nest->loops, nest->num_loops, sizeof(Loop), compare_loops);
+    for (int b = 0; b < nb; b++) nest->innermost[b] = -1;
+    for (int l = 0; l < nest->num_loops; l++) {
+        Loop *loop = &nest->loops[l];
+        loop->parent = nest->innermost[loop->header];
+        loop->depth = loop->parent < 0 ? 1 : nest->loops[loop->parent].depth + 1;
+        for (int k = 0; k < loop->num_blocks; k++) {
+            nest->innermost[loop->blocks[k]] = l;
+        }
+    }
+}
+
+void loop_nest_free(LoopNest *nest) {
+    for (int l = 0; l < nest->num_loops; l++) {
+        bitset_free(&nest->loops[l].body);
+        free(nest->loops[l].blocks);
+        free(nest->loops[l].latches);
+    }
+    free(nest->loops);
+    free(nest->innermost);
+    nest->loops = NULL;
+    nest->num_loops = 0;
+}
+
+static void loop_editor_add(LoopEditor *ed, int pos, LoopEditKind kind, IRCode code) {
+    if (ed->count == ed->capacity) {
+        ed->capacity = ed->capacity ? ed->capacity * 2 : 16;
+        ed->edits = realloc(ed->edits, ed->capacity * sizeof(LoopEdit));
+        if (!ed->edits) {
+            fprintf(stderr, "Error: no se pudo asignar memoria para el análisis de loops\n");
+            exit(1);
+        }
+    }
+    ed->edits[ed->count] = (LoopEdit){pos, kind, ed->count, code};
+    ed->count++;
+}
+
+void loop_editor_init(LoopEditor *ed, LoopNest *nest) {
+    ed->nest = nest;
+    ed->edits = NULL;
+    ed->count = 0;
+    ed->capacity = 0;
+    ed->preheader_ready = df_alloc(nest->num_loops, sizeof(bool));
+    ed->preheader_label = df_alloc(nest->num_loops, sizeof(IRSymbol *));
+    ed->redirect = df_alloc(nest->cfg->end - nest->cfg->start, sizeof(IRSymbol *));
+    ed->num_preheaders = 0;
+    ed->num_new_labels = 0;
+}
+
+void loop_editor_free(LoopEditor *ed) {
+    free(ed->edits);
+    free(ed->preheader_ready);
+    free(ed->preheader_label);
+    free(ed->redirect);
+    ed->edits = NULL;
+    ed->count = 0;
+}
+
+void loop_editor_insert_before(LoopEditor *ed, int pos, IRCode code) {
+    loop_editor_add(ed, pos, LOOP_EDIT_BEFORE, code);
+}
+
+void loop_editor_insert_after(LoopEditor *ed, int pos, IRCode code) {
+    loop_editor_add(ed, pos, LOOP_EDIT_AFTER, code);
+}
+
+void loop_editor_replace(LoopEditor *ed, int pos, IRCode code) {
+    loop_editor_add(ed, pos, LOOP_EDIT_REPLACE, code);
+}
+
+void loop_editor_remove(LoopEditor *ed, int pos) {
+    loop_editor_add(ed, pos, LOOP_EDIT_REPLACE, (IRCode){IR_LABEL, NULL, NULL, NULL});
+}
+
+/*
+ * Un loop admite preheader si su header empieza con una etiqueta y se entra a él
+ * desde fuera del loop.
+ */
+bool loop_has_preheader_slot(LoopNest *nest, int loop_index) {
+    CFG *cfg = nest->cfg;
+    Loop *loop = &nest->loops[loop_index];
+    BasicBlock *header = &cfg->blocks[loop->header];
+    IRCode *first = &cfg->list->codes[header->start];
+    if (loop->header == 0 || first->op != IR_LABEL || !first->result) return false;
+    for (int p = 0; p < header->num_preds; p++) {
+        if (!loop_contains(loop, header->preds[p])) return true;
+    }
+    return false;
+}
+
+/*
+ * Agrega una instrucción al preheader del loop, que se arma delante del header:
+ * si el bloque anterior es del loop y cae en el header, ahora tiene que saltar a
+ * él, y los saltos desde fuera del loop al header pasan a una etiqueta nueva.
+ */
+void loop_editor_preheader(LoopEditor *ed, int loop_index, IRCode code) {
+    CFG *cfg = ed->nest->cfg;
+    Loop *loop = &ed->nest->loops[loop_index];
+    BasicBlock *header = &cfg->blocks[loop->header];
+    int pos = header->start - cfg->start;
+
+    if (!ed->preheader_ready[loop_index]) {
+        ed->preheader_ready[loop_index] = true;
+        ed->num_preheaders++;
+        IRSymbol *header_label = cfg->list->codes[header->start].result;
+
+        int prev = loop->header - 1;
+        if (prev >= 0 && loop_contains(loop, prev) &&
+            cfg->blocks[prev].num_succs > 0 && cfg->blocks[prev].succs[0] == loop->header) {
+            loop_editor_add(ed, pos, LOOP_EDIT_BEFORE, (IRCode){IR_GOTO, NULL, NULL, header_label});
+        }
+
+        for (int p = 0; p < header->num_preds; p++) {
+            int pred = header->preds[p];
+            IRCode *last = &cfg->list->codes[cfg->blocks[pred].end - 1];
+            if (loop_contains(loop, pred) || !last->result ||
+                (last->op != IR_GOTO && !ir_is_cond_branch(last)) ||
+                strcmp(last->result->name, header_label->name) != 0) continue;
+            if (!ed->preheader_label[loop_index]) {
+                ed->preheader_label[loop_index] = new_label_symbol();
+                ed->num_new_labels++;
+                loop_editor_add(ed, pos, LOOP_EDIT_BEFORE,
+                                (IRCode){IR_LABEL, NULL, NULL, ed->preheader_label[loop_index]});
+            }
+            ed->redirect[cfg->blocks[pred].end - 1 - cfg->start] = ed->preheader_label[loop_index];
+        }
+    }
+    loop_editor_add(ed, pos, LOOP_EDIT_BEFORE, code);
+}
+
+static int compare_edits(const void *a, const void *b) {
+    const LoopEdit *x = a, *y = b;
+    if (x->pos != y->pos) return x->pos - y->pos;
+    if (x->kind != y->kind) return (int)x->kind - (int)y->kind;
+    return x->seq - y->seq;
+}
+
+/*
+ * Reescribe la función con los cambios pendientes. Devuelve el nuevo fin de la
+ * función; el CFG y el SSA del LoopNest dejan de ser válidos.
+ */
+int loop_editor_apply(LoopEditor *ed) {
+    CFG *cfg = ed->nest->cfg;
+    IRList *list = cfg->list;
+    if (ed->count == 0) return cfg->end;
+
+    qsort(ed->edits, ed->count, sizeof(LoopEdit), compare_edits);
+    int n = cfg->end - cfg->start;
+    IRCode *codes = df_alloc(n + ed->count, sizeof(IRCode));
+    int count = 0;
+    int e = 0;
+
+    for (int rel = 0; rel < n; rel++) {
+        while (e < ed->count && ed->edits[e].pos == rel && ed->edits[e].kind == LOOP_EDIT_BEFORE) {
+            codes[count++] = ed->edits[e++].code;
+        }
+        IRCode code = list->codes[cfg->start + rel];
+        while (e < ed->count && ed->edits[e].pos == rel && ed->edits[e].kind == LOOP_EDIT_REPLACE) {
+            code = ed->edits[e++].code;
+        }
+        if (!ir_is_nop(&code)) {
+            if (ed->redirect[rel] && (code.op == IR_GOTO || ir_is_cond_branch(&code))) {
+                code.result = ed->redirect[rel];
+            }
+            codes[count++] = code;
+        }
+        while (e < ed->count && ed->edits[e].pos == rel && ed->edits[e].kind == LOOP_EDIT_AFTER) {
+            codes[count++] = ed->edits[e++].code;
+        }
+    }
+
+    ir_replace_range(list, cfg->start, cfg->end, codes, count);
+    free(codes);
+    return cfg->start + count;
+}
+
+/*
+ * Temporales propios de una iteración del loop: una sola definición en la
+ * función, dentro del loop, y todos sus usos en el loop y alcanzados sólo por
+ * ella. Al duplicar el cuerpo se pueden renombrar en cada copia.
+ */
+void loop_local_temps(LoopNest *nest, int loop_index, bool *local) {
+    CFG *cfg = nest->cfg;
+    SSAGraph *ssa = nest->ssa;
+    Loop *loop = &nest->loops[loop_index];
+    int n = ssa->num_instrs;
+    int *defs = df_alloc(cfg->num_syms, sizeof(int));
+    for (int rel = 0; rel < n; rel++) {
+        if (cfg->def_of[rel] >= 0) defs[cfg->def_of[rel]]++;
+    }
+    memset(local, 0, cfg->num_syms * sizeof(bool));
+    for (int k = 0; k < loop->num_blocks; k++) {
+        BasicBlock *bb = &cfg->blocks[loop->blocks[k]];
+        for (int rel = bb->start - cfg->start; rel < bb->end - cfg->start; rel++) {
+            int sym = cfg->def_of[rel];
+            IRSymbol *result = cfg->list->codes[cfg->start + rel].result;
+            if (sym < 0 || defs[sym] != 1 || !result || result->type != IR_SYM_TEMP) continue;
+            bool inside = true;
+            for (int u = ssa->user_start[rel]; u < ssa->user_start[rel + 1] && inside; u++) {
+                int user = ssa->users[u];
+                inside = user < n && loop_contains(loop, cfg->block_of[user]);
+            }
+            local[sym] = inside;
+        }
+    }
+    free(defs);
+}
+
+/*
+ * Movimiento de código invariante (LICM).
+ *
+ * Una instrucción de un loop es invariante si cada operando es una constante o un
+ * valor SSA definido fuera del loop (o por otra instrucción invariante). Los loops
+ * se recorren de afuera hacia adentro, así que cada instrucción sale del loop más
+ * externo respecto del cual es invariante.
+ *
+ * Sólo se mueven cálculos sin efectos que no pueden fallar: ejecutarlos aunque el
+ * cuerpo no corra es inofensivo. Un DIV o MOD sólo se mueve con divisor constante
+ * distinto de 0 y de -1 (idivq falla también con el mínimo entero dividido por -1).
+ */
+static bool is_hoistable(IRCode *code) {
+    if (!code->result || code->result->type != IR_SYM_TEMP) return false;
+    switch (code->op) {
+        case IR_LOAD:
+            return code->arg1 && !is_constant_symbol(code->arg1);
+        case IR_DIV:
+        case IR_MOD:
+            return is_constant_symbol(code->arg2) &&
+                   get_constant_value(code->arg2) != 0 && get_constant_value(code->arg2) != -1;
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_AND:
+        case IR_OR:
+        case IR_NOT:
+        case IR_UMINUS:
+        case IR_EQ:
+        case IR_NEQ:
+        case IR_LT:
+        case IR_LE:
+        case IR_GT:
+        case IR_GE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * Un operando es invariante en el loop si su valor se define fuera de él, o lo
+ * define una instrucción que ya se marcó para salir del loop.
+ */
+static bool licm_operand_invariant(LoopNest *nest, Loop *loop, int *target, int rel, int slot) {
+    CFG *cfg = nest->cfg;
+    SSAGraph *ssa = nest->ssa;
+    if (cfg->use_of[2 * rel + slot] < 0) return true;
+
+    int value = ssa->use_value[2 * rel + slot];
+    if (value == SSA_ENTRY) return true;
+    if (value == SSA_CLOBBER) return false;
+    if (value < ssa->num_instrs) {
+        return !loop_contains(loop, cfg->block_of[value]) || target[value] >= 0;
+    }
+    return !loop_contains(loop, ssa->phis[value - ssa->num_instrs].block);
+}
+
+/*
+ * Aplica LICM a la función que empieza en start. Devuelve el nuevo fin de la función.
+ */
+static int licm_function(IRList *list, int start, int counts[3]) {
+    CFG cfg;
+    SSAGraph ssa;
+    LoopNest nest;
+    cfg_build(&cfg, list, start);
+    ssa_build(&ssa, &cfg);
+    loop_nest_build(&nest, &cfg, &ssa);
+
+    int n = cfg.end - cfg.start;
+    int end = cfg.end;
+    if (nest.num_loops == 0) {
+        loop_nest_free(&nest);
+        ssa_free(&ssa);
+        cfg_free(&cfg);
+        return end;
+    }
+
+    int *def_count = df_alloc(cfg.num_syms, sizeof(int));
+    for (int rel = 0; rel < n; rel++) {
+        if (cfg.def_of[rel] >= 0) def_count[cfg.def_of[rel]]++;
+    }
+
+    // Loop del que sale cada instrucción, -1 si se queda
+    int *target = df_alloc(n, sizeof(int));
+    for (int rel = 0; rel < n; rel++) target[rel] = -1;
+    LoopEditor ed;
+    loop_editor_init(&ed, &nest);
+    int num_hoisted = 0;
+
+    for (int l = 0; l < nest.num_loops; l++) {
+        Loop *loop = &nest.loops[l];
+        if (!loop_has_preheader_slot(&nest, l)) continue;
+
+        for (int k = 0; k < loop->num_blocks; k++) {
+            BasicBlock *bb = &cfg.blocks[loop->blocks[k]];
+            for (int i = bb->start; i < bb->end; i++) {
+                int rel = i - cfg.start;
+                IRCode *code = &list->codes[i];
+                if (target[rel] >= 0 || !is_hoistable(code) || def_count[cfg.def_of[rel]] != 1) continue;
+                if (!licm_operand_invariant(&nest, loop, target, rel, 0) ||
+                    !licm_operand_invariant(&nest, loop, target, rel, 1)) continue;
+
+                // En orden RPO, cada instrucción queda detrás de las que calculan sus operandos
+                target[rel] = l;
+                loop_editor_preheader(&ed, l, *code);
+                loop_editor_remove(&ed, rel);
+                num_hoisted++;
+                if (debug_mode) {
+                    printf("  [LICM] Línea %d: %s sale del loop de la línea %d\n",
+                           i, code->result->name, cfg.blocks[loop->header].start);
+                }
+            }
+        }
+    }
+
+    end = loop_editor_apply(&ed);
+    counts[0] += num_hoisted;
+    counts[1] += ed.num_preheaders;
+    counts[2] += ed.num_new_labels;
+    loop_editor_free(&ed);
+
+    free(def_count);
+    free(target);
+    loop_nest_free(&nest);
+    ssa_free(&ssa);
+    cfg_free(&cfg);
+    return end;
+}
+
+/*
+ * LICM función por función. counts: instrucciones movidas, preheaders usados y
+ * etiquetas de preheader nuevas.
+ */
+void optimize_loop_invariant_code_motion(IRList *list) {
+    int counts[3] = {0, 0, 0};
+
+    for (int start = 0; start < list->size; start++) {
+        if (list->codes[start].op != IR_METHOD) continue;
+        start = licm_function(list, start, counts) - 1;
+    }
+
+    if (counts[0] > 0 && debug_mode) {
+        printf("✓ Movimiento de código invariante (LICM): %d instrucciones fuera de %d loops "
+               "(%d preheaders con etiqueta nueva)\n", counts[0], counts[1], counts[2]);
+    }
+}
+
+/*
+ * Variables de inducción.
+ *
+ * Una variable de inducción básica es un símbolo con una phi en el header cuyo
+ * valor en todos los latches es phi + c (o phi - c): avanza c por iteración.
+ * add es la instrucción que calcula el valor nuevo y update la que lo guarda en
+ * el símbolo (el STORE, o el mismo ADD/SUB si escribe el símbolo directamente).
+ */
+typedef struct {
+    int phi;            // Valor SSA de la phi (n + k)
+    IRSymbol *sym;
+    int add;
+    int update;
+    int step;
+} InductionVar;
+
+/*
+ * Variable derivada: temp = iv * factor (o iv % factor). Se inicializa en el
+ * preheader y avanza detrás del update de su variable básica.
+ */
+typedef struct {
+    int iv;
+    IRInstr op;
+    IRSymbol *factor;
+    IRSymbol *temp;
+    IRSymbol *step;
+} DerivedIV;
+
+static bool iv_find_basic(LoopNest *nest, int loop_index, int phi_index, InductionVar *iv) {
+    CFG *cfg = nest->cfg;
+    SSAGraph *ssa = nest->ssa;
+    IRCode *codes = cfg->list->codes + cfg->start;
+    int n = ssa->num_instrs;
+    Loop *loop = &nest->loops[loop_index];
+    BasicBlock *header = &cfg->blocks[loop->header];
+    PhiNode *phi = &ssa->phis[phi_index];
+
+    int update = -1;
+    for (int p = 0; p < header->num_preds; p++) {
+        if (!loop_contains(loop, header->preds[p])) continue;
+        int arg = phi->args[p];
+        if (arg < 0 || arg >= n || (update >= 0 && arg != update)) return false;
+        update = arg;
+    }
+    if (update < 0) return false;
+
+    int add = update;
+    if (codes[update].op == IR_STORE) {
+        add = ssa->use_value[2 * update];
+        if (add < 0 || add >= n || !codes[add].result || codes[add].result->type != IR_SYM_TEMP) return false;
+    }
+    IRCode *code = &codes[add];
+    if (code->op != IR_ADD && code->op != IR_SUB) return false;
+
+    int value = n + phi_index;
+    int step;
+    if (cfg->use_of[2 * add] >= 0 && ssa->use_value[2 * add] == value && is_constant_symbol(code->arg2)) {
+        step = get_constant_value(code->arg2);
+    } else if (code->op == IR_ADD && cfg->use_of[2 * add + 1] >= 0 &&
+               ssa->use_value[2 * add + 1] == value && is_constant_symbol(code->arg1)) {
+        step = get_constant_value(code->arg1);
+    } else {
+        return false;
+    }
+    if (step == 0 || step == INT_MIN) return false;
+
+    iv->phi = value;
+    iv->sym = codes[update].result;
+    iv->add = add;
+    iv->update = update;
+    iv->step = code->op == IR_SUB ? -step : step;
+    return true;
+}
+
+/*
+ * Variable de inducción que lee el operando (directamente o a través de un LOAD).
+ * after queda en 1 si lee el valor ya actualizado de la iteración.
+ */
+static int iv_of_operand(LoopNest *nest, InductionVar *ivs, int num_ivs, int rel, int slot, int *after) {
+    CFG *cfg = nest->cfg;
+    SSAGraph *ssa = nest->ssa;
+    IRCode *codes = cfg->list->codes + cfg->start;
+    if (cfg->use_of[2 * rel + slot] < 0) return -1;
+
+    int value = ssa->use_value[2 * rel + slot];
+    if (value >= 0 && value < ssa->num_instrs && codes[value].op == IR_LOAD &&
+        cfg->use_of[2 * value] >= 0) {
+        value = ssa->use_value[2 * value];
+    }
+    for (int k = 0; k < num_ivs; k++) {
+        if (value == ivs[k].phi) {
+            *after = 0;
+            return k;
+        }
+        if (value == ivs[k].add || value == ivs[k].update) {
+            *after = 1;
+            return k;
+        }
+    }
+    return -1;
+}
+
+/*
+ * 1 si la instrucción se ejecuta después del update de la variable en cada
+ * iteración, 0 si antes, -1 si no se puede saber.
+ */
+static int iv_position(LoopNest *nest, InductionVar *iv, int rel) {
+    CFG *cfg = nest->cfg;
+    int block = cfg->block_of[rel];
+    int update_block = cfg->block_of[iv->update];
+    if (block == update_block) return rel > iv->update;
+    if (block_dominates(nest->ssa, update_block, block)) return 1;
+    if (block_dominates(nest->ssa, block, update_block)) return 0;
+    return -1;
+}
+
+static bool loop_operand_invariant(LoopNest *nest, Loop *loop, int rel, int slot) {
+    CFG *cfg = nest->cfg;
+    SSAGraph *ssa = nest->ssa;
+    if (cfg->use_of[2 * rel + slot] < 0) return true;
+
+    int value = ssa->use_value[2 * rel + slot];
+    if (value == SSA_ENTRY) return true;
+    if (value == SSA_CLOBBER) return false;
+    if (value < ssa->num_instrs) return !loop_contains(loop, cfg->block_of[value]);
+    return !loop_contains(loop, ssa->phis[value - ssa->num_instrs].block);
+}
+
+/*
+ * El valor inicial de la variable es una constante no negativa en todas las
+ * entradas al loop (necesario para llevar un módulo de forma incremental).
+ */
+static bool iv_starts_nonnegative(LoopNest *nest, int loop_index, InductionVar *iv) {
+    CFG *cfg = nest->cfg;
+    SSAGraph *ssa = nest->ssa;
+    IRCode *codes = cfg->list->codes + cfg->start;
+    Loop *loop = &nest->loops[loop_index];
+    BasicBlock *header = &cfg->blocks[loop->header];
+    PhiNode *phi = &ssa->phis[iv->phi - ssa->num_instrs];
+
+    for (int p = 0; p < header->num_preds; p++) {
+        if (loop_contains(loop, header->preds[p])) continue;
+        int arg = phi->args[p];
+        if (arg < 0 || arg >= ssa->num_instrs || codes[arg].op != IR_STORE ||
+            !is_constant_symbol(codes[arg].arg1) || get_constant_value(codes[arg].arg1) < 0) return false;
+    }
+    return true;
+}
+
+static bool same_factor(IRSymbol *a, IRSymbol *b) {
+    if (is_constant_symbol(a) || is_constant_symbol(b)) {
+        return is_constant_symbol(a) && is_constant_symbol(b) && get_constant_value(a) == get_constant_value(b);
+    }
+    return strcmp(a->name, b->name) == 0;
+}
+
+static DerivedIV *iv_find_derived(DerivedIV *derived, int num_derived, int iv_index,
+                                  IRInstr op, IRSymbol *factor) {
+    for (int d = 0; d < num_derived; d++) {
+        if (derived[d].iv == iv_index && derived[d].op == op && same_factor(derived[d].factor, factor)) {
+            return &derived[d];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Crea la variable derivada iv op factor del loop, guardada en temp.
+ */
+static DerivedIV *iv_new_derived(LoopEditor *ed, int loop_index, InductionVar *ivs, int iv_index,
+                                 IRInstr op, IRSymbol *factor, IRSymbol *temp,
+                                 DerivedIV *derived, int *num_derived) {
+    InductionVar *iv = &ivs[iv_index];
+    DerivedIV *dv = &derived[(*num_derived)++];
+    dv->iv = iv_index;
+    dv->op = op;
+    dv->factor = factor;
+    dv->temp = temp;
+    loop_editor_preheader(ed, loop_index, (IRCode){op, iv->sym, factor, dv->temp});
+
+    if (op == IR_MOD) {
+        // r = r + c; si r >= m, r = r - m (0 < c < m)
+        IRSymbol *skip = new_label_symbol();
+        dv->step = new_const_symbol(iv->step, 0);
+        loop_editor_insert_after(ed, iv->update, (IRCode){IR_ADD, dv->temp, dv->step, dv->temp});
+        loop_editor_insert_after(ed, iv->update, (IRCode){IR_IF_LT, dv->temp, factor, skip});
+        loop_editor_insert_after(ed, iv->update, (IRCode){IR_SUB, dv->temp, factor, dv->temp});
+        loop_editor_insert_after(ed, iv->update, (IRCode){IR_LABEL, NULL, NULL, skip});
+        return dv;
+    }
+
+    if (is_constant_symbol(factor)) {
+        dv->step = new_const_symbol(iv->step * get_constant_value(factor), 0);
+    } else if (iv->step == 1) {
+        dv->step = factor;
+    } else {
+        dv->step = new_temp_symbol();
+        loop_editor_preheader(ed, loop_index,
+                              (IRCode){IR_MUL, factor, new_const_symbol(iv->step, 0), dv->step});
+    }
+    loop_editor_insert_after(ed, iv->update, (IRCode){IR_ADD, dv->temp, dv->step, dv->temp});
+    return dv;
+}
+
+/*
+ * Los usos del resultado de la instrucción están en su bloque y antes de que
+ * avance la variable básica, así que el resultado puede ser la variable derivada.
+ */
+static bool iv_uses_local(LoopNest *nest, InductionVar *iv, int rel) {
+    CFG *cfg = nest->cfg;
+    SSAGraph *ssa = nest->ssa;
+    int block = cfg->block_of[rel];
+    int limit = cfg->block_of[iv->update] == block && rel < iv->update ? iv->update : INT_MAX;
+    for (int u = ssa->user_start[rel]; u < ssa->user_start[rel + 1]; u++) {
+        int user = ssa->users[u];
+        if (user >= ssa->num_instrs || cfg->block_of[user] != block || user > limit) return false;
+    }
+    return true;
+}
+
+/*
+ * Reducción de fuerza de una multiplicación o módulo por una variable de inducción.
+ */
+static bool iv_reduce(LoopEditor *ed, int loop_index, InductionVar *ivs, int num_ivs,
+                      DerivedIV *derived, int *num_derived, int rel, int *def_count) {
+    LoopNest *nest = ed->nest;
+    CFG *cfg = nest->cfg;
+    Loop *loop = &nest->loops[loop_index];
+    IRCode *code = &cfg->list->codes[cfg->start + rel];
+    if ((code->op != IR_MUL && code->op != IR_MOD) || !code->result ||
+        code->result->type != IR_SYM_TEMP || def_count[cfg->def_of[rel]] != 1) return false;
+
+    int after = 0;
+    int slot = 0;
+    int iv_index = iv_of_operand(nest, ivs, num_ivs, rel, 0, &after);
+    if (iv_index < 0 && code->op == IR_MUL) {
+        slot = 1;
+        iv_index = iv_of_operand(nest, ivs, num_ivs, rel, 1, &after);
+    }
+    if (iv_index < 0 || !loop_operand_invariant(nest, loop, rel, 1 - slot)) return false;
+
+    InductionVar *iv = &ivs[iv_index];
+    IRSymbol *factor = slot == 0 ? code->arg2 : code->arg1;
+    int position = iv_position(nest, iv, rel);
+    if (position < 0) return false;
+    int delta = after - position;
+
+    if (code->op == IR_MOD) {
+        if (!is_constant_symbol(factor) || delta != 0 || iv->step <= 0 ||
+            iv->step >= get_constant_value(factor) || !iv_starts_nonnegative(nest, loop_index, iv)) return false;
+    } else if (is_constant_symbol(factor)) {
+        int k = get_constant_value(factor);
+        if (k == 0 || k == 1 || !fits_int((long long)iv->step * k)) return false;
+    }
+
+    // El primer resultado que se usa sólo en su bloque pasa a ser la variable derivada
+    DerivedIV *dv = iv_find_derived(derived, *num_derived, iv_index, code->op, factor);
+    if (!dv && delta == 0 && iv_uses_local(nest, iv, rel)) {
+        dv = iv_new_derived(ed, loop_index, ivs, iv_index, code->op, factor, code->result,
+                            derived, num_derived);
+        loop_editor_remove(ed, rel);
+    } else {
+        if (!dv) {
+            dv = iv_new_derived(ed, loop_index, ivs, iv_index, code->op, factor, new_temp_symbol(),
+                                derived, num_derived);
+        }
+        IRCode replacement = {IR_LOAD, dv->temp, NULL, code->result};
+        if (delta > 0) replacement = (IRCode){IR_ADD, dv->temp, dv->step, code->result};
+        if (delta < 0) replacement = (IRCode){IR_SUB, dv->temp, dv->step, code->result};
+        loop_editor_replace(ed, rel, replacement);
+    }
+
+    if (debug_mode) {
+        printf("  [IV] Línea %d: %s %s, %s reemplazado por %s (avanza %s por iteración)\n",
+               cfg->start + rel, code->op == IR_MUL ? "MUL" : "MOD",
+               code->arg1->name, code->arg2->name, dv->temp->name, dv->step->name);
+    }
+    return true;
+}
+
+static bool is_fused_branch(IRCode *code) {
+    return code->op >= IR_IF_EQ && code->op <= IR_IF_GE;
+}
+
+/*
+ * Reemplazo de la condición de salida: si la variable básica sólo se usa en su
+ * propio incremento y en un salto contra un invariante, el salto pasa a comparar
+ * una variable derivada iv * k (k > 0) contra invariante * k y la básica queda
+ * muerta para DCE.
+ */
+static bool iv_replace_test(LoopEditor *ed, int loop_index, InductionVar *ivs, int iv_index,
+                            DerivedIV *derived, int num_derived, bool *claimed) {
+    LoopNest *nest = ed->nest;
+    CFG *cfg = nest->cfg;
+    SSAGraph *ssa = nest->ssa;
+    IRCode *codes = cfg->list->codes + cfg->start;
+    Loop *loop = &nest->loops[loop_index];
+    InductionVar *iv = &ivs[iv_index];
+    int n = ssa->num_instrs;
+    if (iv->sym->type != IR_SYM_VAR || ir_is_global(iv->sym->name)) return false;
+
+    DerivedIV *dv = NULL;
+    for (int d = 0; d < num_derived && !dv; d++) {
+        if (derived[d].iv == iv_index && derived[d].op == IR_MUL &&
+            is_constant_symbol(derived[d].factor) && get_constant_value(derived[d].factor) > 0) {
+            dv = &derived[d];
+        }
+    }
+    if (!dv) return false;
+
+    // Fuera de las instrucciones ya reducidas, la phi sólo la leen el incremento y
+    // el salto; el valor nuevo, sólo la phi
+    int branch = -1;
+    for (int u = ssa->user_start[iv->phi]; u < ssa->user_start[iv->phi + 1]; u++) {
+        int user = ssa->users[u];
+        if (user == iv->add || (user < n && claimed[user])) continue;
+        if (user >= n || branch >= 0 || !is_fused_branch(&codes[user])) return false;
+        branch = user;
+    }
+    if (branch < 0 || claimed[branch]) return false;
+    if (iv->add != iv->update) {
+        for (int u = ssa->user_start[iv->add]; u < ssa->user_start[iv->add + 1]; u++) {
+            int user = ssa->users[u];
+            if (user != iv->update && (user >= n || !claimed[user])) return false;
+        }
+    }
+    for (int u = ssa->user_start[iv->update]; u < ssa->user_start[iv->update + 1]; u++) {
+        int user = ssa->users[u];
+        if (user != iv->phi && (user >= n || !claimed[user])) return false;
+    }
+
+    int slot = cfg->use_of[2 * branch] >= 0 && ssa->use_value[2 * branch] == iv->phi ? 0 : 1;
+    if (cfg->use_of[2 * branch + slot] < 0 || ssa->use_value[2 * branch + slot] != iv->phi ||
+        !loop_operand_invariant(nest, loop, branch, 1 - slot) || iv_position(nest, iv, branch) != 0) return false;
+
+    IRCode *code = &codes[branch];
+    IRSymbol *bound = slot == 0 ? code->arg2 : code->arg1;
+    int k = get_constant_value(dv->factor);
+    IRSymbol *scaled;
+    if (is_constant_symbol(bound)) {
+        long long value = (long long)get_constant_value(bound) * k;
+        if (!fits_int(value)) return false;
+        scaled = new_const_symbol((int)value, 0);
+    } else {
+        scaled = new_temp_symbol();
+        loop_editor_preheader(ed, loop_index, (IRCode){IR_MUL, bound, dv->factor, scaled});
+    }
+
+    IRCode replacement = *code;
+    if (slot == 0) {
+        replacement.arg1 = dv->temp;
+        replacement.arg2 = scaled;
+    } else {
+        replacement.arg1 = scaled;
+        replacement.arg2 = dv->temp;
+    }
+    loop_editor_replace(ed, branch, replacement);
+    claimed[branch] = true;
+
+    if (debug_mode) {
+        printf("  [IV] Línea %d: %s sólo se usa en la condición, ahora se compara %s con %s\n",
+               cfg->start + branch, iv->sym->name, dv->temp->name, scaled->name);
+    }
+    return true;
+}
+
+/*
+ * Variables de inducción de la función que empieza en start. Devuelve el nuevo
+ * fin de la función.
+ */
+static int iv_function(IRList *list, int start, int counts[3]) {
+    CFG cfg;
+    SSAGraph ssa;
+    LoopNest nest;
+    cfg_build(&cfg, list, start);
+    ssa_build(&ssa, &cfg);
+    loop_nest_build(&nest, &cfg, &ssa);
+
+    int n = cfg.end - cfg.start;
+    int end = cfg.end;
+    if (nest.num_loops > 0) {
+        int *def_count = df_alloc(cfg.num_syms, sizeof(int));
+        for (int rel = 0; rel < n; rel++) {
+            if (cfg.def_of[rel] >= 0) def_count[cfg.def_of[rel]]++;
+        }
+        bool *claimed = df_alloc(n, sizeof(bool));
+        InductionVar *ivs = df_alloc(ssa.num_phis, sizeof(InductionVar));
+        DerivedIV *derived = df_alloc(n, sizeof(DerivedIV));
+        LoopEditor ed;
+        loop_editor_init(&ed, &nest);
+
+        // De adentro hacia afuera: cada instrucción se reduce respecto de su loop más interno
+        for (int l = nest.num_loops - 1; l >= 0; l--) {
+            Loop *loop = &nest.loops[l];
+            if (!loop_has_preheader_slot(&nest, l)) continue;
+
+            int num_ivs = 0;
+            for (int k = ssa.block_phi_start[loop->header]; k < ssa.block_phi_start[loop->header + 1]; k++) {
+                if (iv_find_basic(&nest, l, k, &ivs[num_ivs])) num_ivs++;
+            }
+            if (num_ivs == 0) continue;
+
+            int num_derived = 0;
+            for (int b = 0; b < loop->num_blocks; b++) {
+                BasicBlock *bb = &cfg.blocks[loop->blocks[b]];
+                for (int rel = bb->start - cfg.start; rel < bb->end - cfg.start; rel++) {
+                    if (claimed[rel]) continue;
+                    if (iv_reduce(&ed, l, ivs, num_ivs, derived, &num_derived, rel, def_count)) {
+                        claimed[rel] = true;
+                        counts[list->codes[cfg.start + rel].op == IR_MOD ? 1 : 0]++;
+                    }
+                }
+            }
+            for (int k = 0; k < num_ivs; k++) {
+                if (iv_replace_test(&ed, l, ivs, k, derived, num_derived, claimed)) counts[2]++;
+            }
+        }
+
+        end = loop_editor_apply(&ed);
+        loop_editor_free(&ed);
+        free(def_count);
+        free(claimed);
+        free(ivs);
+        free(derived);
+    }
+
+    loop_nest_free(&nest);
+    ssa_free(&ssa);
+    cfg_free(&cfg);
+    return end;
+}
+
+/*
+ * Reducción de fuerza sobre variables de inducción. counts: multiplicaciones y
+ * módulos reducidos, y variables reemplazadas en la condición de salida.
+ */
+void optimize_induction_variables(IRList *list) {
+    int counts[3] = {0, 0, 0};
+
+    for (int start = 0; start < list->size; start++) {
+        if (list->codes[start].op != IR_METHOD) continue;
+        start = iv_function(list, start, counts) - 1;
+    }
+
+    if (counts[0] + counts[1] + counts[2] > 0 && debug_mode) {
+        printf("✓ Variables de inducción: %d multiplicaciones y %d módulos reducidos, "
+               "%d variables reemplazadas en la condición de salida\n", counts[0], counts[1], counts[2]);
+    }
+}
+
+/*
+ * Unswitching.
+ *
+ * Un salto condicional dentro del loop cuyos operandos son invariantes toma
+ * siempre el mismo camino. El loop se duplica en dos versiones, una por cada
+ * resultado de la condición, y la condición se evalúa una sola vez al entrar:
+ *
+ *   Lh: IF c, Lv; <loop sin el salto>; Lv: <loop con GOTO al destino del salto>
+ *
+ * Cada versión deja afuera los bloques que no alcanza. Los temporales propios de
+ * una iteración y las etiquetas internas se renombran en cada versión. Se elige
+ * un loop por ronda, de afuera hacia adentro, mientras alcance el presupuesto de
+ * instrucciones nuevas de la función (-unswitch-budget).
+ */
+typedef struct {
+    CFG *cfg;
+    Loop *loop;
+    bool *local;                // Por símbolo: temporal propio de una iteración
+    IRSymbol **temp_map;        // Por símbolo: nombre del temporal en la versión
+    IRSymbol **labels;          // Etiquetas definidas en el loop
+    IRSymbol **label_map;
+    int num_labels;
+} UnswitchCopier;
+
+static IRSymbol *unswitch_operand(UnswitchCopier *c, IRSymbol *sym) {
+    if (!sym) return NULL;
+    if (sym->type == IR_SYM_LABEL) {
+        for (int l = 0; l < c->num_labels; l++) {
+            if (strcmp(sym->name, c->labels[l]->name) != 0) continue;
+            if (!c->label_map[l]) c->label_map[l] = new_label_symbol();
+            return c->label_map[l];
+        }
+        return sym;
+    }
+    if (sym->type != IR_SYM_TEMP) return sym;
+    int index = cfg_sym_index(c->cfg, sym->name);
+    if (index < 0 || !c->local[index]) return sym;
+    if (!c->temp_map[index]) {
+        c->temp_map[index] = new_temp_symbol();
+        c->temp_map[index]->data_type = sym->data_type;
+    }
+    return c->temp_map[index];
+}
+
+/*
+ * Primer salto del loop (fuera del test del header) con ambos destinos dentro
+ * del loop y operandos invariantes. Devuelve su instrucción relativa o -1.
+ */
+static int unswitch_find_branch(LoopNest *nest, Loop *loop) {
+    CFG *cfg = nest->cfg;
+    for (int b = loop->header + 1; b < loop->header + loop->num_blocks; b++) {
+        BasicBlock *bb = &cfg->blocks[b];
+        int rel = bb->end - 1 - cfg->start;
+        IRCode *code = &cfg->list->codes[bb->end - 1];
+        if (!ir_is_cond_branch(code) || bb->num_succs != 2) continue;
+        if (!loop_contains(loop, bb->succs[0]) || !loop_contains(loop, bb->succs[1])) continue;
+        if (bb->succs[0] == bb->succs[1]) continue;
+        if (!loop_operand_invariant(nest, loop, rel, 0) || !loop_operand_invariant(nest, loop, rel, 1)) continue;
+        return rel;
+    }
+    return -1;
+}
+
+// Bloques del loop alcanzables desde el header cuando el salto va siempre a un lado
+static void unswitch_reachable(CFG *cfg, Loop *loop, int branch_block, bool taken, bool *kept, int *stack) {
+    int top = 0;
+    memset(kept, 0, cfg->num_blocks * sizeof(bool));
+    kept[loop->header] = true;
+    stack[top++] = loop->header;
+    while (top > 0) {
+        int b = stack[--top];
+        BasicBlock *bb = &cfg->blocks[b];
+        for (int s = 0; s < bb->num_succs; s++) {
+            if (b == branch_block && s != (taken ? 1 : 0)) continue;
+            int succ = bb->succs[s];
+            if (kept[succ] || !loop_contains(loop, succ)) continue;
+            kept[succ] = true;
+            stack[top++] = succ;
+        }
+    }
+}
+
+static void unswitch_version(LoopEditor *ed, UnswitchCopier *c, int pos, int branch, bool taken,
+                             bool *kept, int *stack) {
+    CFG *cfg = c->cfg;
+    Loop *loop = c->loop;
+    memset(c->temp_map, 0, cfg->num_syms * sizeof(IRSymbol *));
+    memset(c->label_map, 0, (c->num_labels > 0 ? c->num_labels : 1) * sizeof(IRSymbol *));
+    unswitch_reachable(cfg, loop, cfg->block_of[branch], taken, kept, stack);
+
+    for (int b = loop->header; b < loop->header + loop->num_blocks; b++) {
+        if (!kept[b]) continue;
+        BasicBlock *bb = &cfg->blocks[b];
+        for (int rel = bb->start - cfg->start; rel < bb->end - cfg->start; rel++) {
+            IRCode *code = &cfg->list->codes[cfg->start + rel];
+            if (ir_is_nop(code)) continue;
+            if (rel == branch) {
+                if (taken) {
+                    loop_editor_insert_after(ed, pos, (IRCode){IR_GOTO, NULL, NULL, unswitch_operand(c, code->result)});
+                }
+                continue;
+            }
+            IRCode copy = {code->op, unswitch_operand(c, code->arg1), unswitch_operand(c, code->arg2),
+                           unswitch_operand(c, code->result)};
+            loop_editor_insert_after(ed, pos, copy);
+        }
+    }
+}
+
+static int unswitch_size(CFG *cfg, Loop *loop) {
+    int size = 0;
+    for (int b = loop->header; b < loop->header + loop->num_blocks; b++) {
+        for (int i = cfg->blocks[b].start; i < cfg->blocks[b].end; i++) {
+            if (!ir_is_nop(&cfg->list->codes[i])) size++;
+        }
+    }
+    return size;
+}
+
+/*
+ * Una ronda sobre la función que empieza en start. counts: loops desdoblados,
+ * condiciones invariantes que no entraron en el presupuesto e instrucciones
+ * nuevas. Devuelve si se cambió algo.
+ */
+static bool unswitch_function(IRList *list, int start, int *end, int *budget, int counts[3]) {
+    CFG cfg;
+    SSAGraph ssa;
+    LoopNest nest;
+    cfg_build(&cfg, list, start);
+    ssa_build(&ssa, &cfg);
+    loop_nest_build(&nest, &cfg, &ssa);
+
+    bool changed = false;
+    int rejected = 0;
+    *end = cfg.end;
+    for (int l = 0; l < nest.num_loops && !changed; l++) {
+        Loop *loop = &nest.loops[l];
+        int last_block = loop->header + loop->num_blocks - 1;
+        bool contiguous = last_block < cfg.num_blocks;
+        for (int b = loop->header; b <= last_block && contiguous; b++) contiguous = loop_contains(loop, b);
+        if (!contiguous) continue;
+        IRCode *label = &list->codes[cfg.blocks[loop->header].start];
+        IRCode *tail = &list->codes[cfg.blocks[last_block].end - 1];
+        if (label->op != IR_LABEL || !label->result || (tail->op != IR_GOTO && tail->op != IR_RETURN)) continue;
+
+        int branch = unswitch_find_branch(&nest, loop);
+        if (branch < 0) continue;
+        int size = unswitch_size(&cfg, loop);
+        if (size + 1 > *budget) {
+            rejected++;
+            continue;
+        }
+
+        UnswitchCopier c = {&cfg, loop, NULL, NULL, NULL, NULL, 0};
+        c.local = df_alloc(cfg.num_syms, sizeof(bool));
+        c.temp_map = df_alloc(cfg.num_syms, sizeof(IRSymbol *));
+        c.labels = df_alloc(size, sizeof(IRSymbol *));
+        c.label_map = df_alloc(size, sizeof(IRSymbol *));
+        bool *kept = df_alloc(cfg.num_blocks, sizeof(bool));
+        int *stack = df_alloc(cfg.num_blocks, sizeof(int));
+        loop_local_temps(&nest, l, c.local);
+        for (int b = loop->header; b <= last_block; b++) {
+            IRCode *code = &list->codes[cfg.blocks[b].start];
+            if (code->op == IR_LABEL && code->result) c.labels[c.num_labels++] = code->result;
+        }
+
+        // La etiqueta original queda como entrada y detrás va la condición
+        int first = cfg.blocks[loop->header].start - cfg.start;
+        int last = cfg.blocks[last_block].end - cfg.start;
+        IRCode *test = &list->codes[cfg.start + branch];
+        IRSymbol *taken_label = new_label_symbol();
+        LoopEditor ed;
+        loop_editor_init(&ed, &nest);
+        for (int rel = first + 1; rel < last; rel++) loop_editor_remove(&ed, rel);
+        loop_editor_insert_after(&ed, first, (IRCode){test->op, test->arg1, test->arg2, taken_label});
+        unswitch_version(&ed, &c, first, branch, false, kept, stack);
+        loop_editor_insert_after(&ed, first, (IRCode){IR_LABEL, NULL, NULL, taken_label});
+        unswitch_version(&ed, &c, first, branch, true, kept, stack);
+        int growth = ed.count - (last - first - 1);
+
+        if (debug_mode) {
+            printf("  [UNSWITCH] Línea %d: la condición invariante de la línea %d se evalúa antes del loop "
+                   "(%d instrucciones por versión)\n", cfg.start + first, cfg.start + branch, size);
+        }
+
+        *end = loop_editor_apply(&ed);
+        loop_editor_free(&ed);
+        free(c.local);
+        free(c.temp_map);
+        free(c.labels);
+        free(c.label_map);
+        free(kept);
+        free(stack);
+        *budget -= growth;
+        counts[0]++;
+        counts[2] += growth;
+        changed = true;
+    }
+    // Las condiciones que no entraron se cuentan sólo en la última ronda
+    if (!changed) counts[1] += rejected;
+
+    loop_nest_free(&nest);
+    ssa_free(&ssa);
+    cfg_free(&cfg);
+    return changed;
+}
+
+void optimize_loop_unswitching(IRList *list) {
+    int counts[3] = {0, 0, 0};
+
+    for (int start = 0; start < list->size; start++) {
+        if (list->codes[start].op != IR_METHOD) continue;
+        int end;
+        int budget = unswitch_budget;
+        for (int round = 0; round < UNSWITCH_MAX_ROUNDS && unswitch_function(list, start, &end, &budget, counts); round++);
+        start = end - 1;
+    }
+
+    if (counts[0] + counts[1] > 0 && debug_mode) {
+        printf("✓ Unswitching: %d loops desdoblados por una condición invariante, +%d instrucciones "
+               "(%d condiciones fuera del presupuesto)\n", counts[0], counts[2], counts[1]);
+    }
+}
+
+/*
+ * Rotación de loops.
+ *
+ * El frontend genera los while con la condición al principio y un GOTO al header
+ * al final, así que cada vuelta ejecuta un salto incondicional además del
+ * condicional. Rotado, el test original queda como guarda y el cuerpo termina
+ * repitiendo la condición negada con un salto de vuelta a su comienzo:
+ *
+ *   Lh: H; IF c, Lexit; B; GOTO Lh   =>   Lh: H; IF c, Lexit; Lb: B; H'; IF !c, Lb
+ *
+ * H' es la copia del cálculo de la condición; los temporales que sólo se usan en
+ * el header se renombran. Se rota cuando los bloques del loop son contiguos, el
+ * header sale del loop con su salto y cae al cuerpo, y el único latch es el
+ * último bloque.
+ */
+static bool rotate_candidate(LoopNest *nest, Loop *loop) {
+    CFG *cfg = nest->cfg;
+    BasicBlock *header = &cfg->blocks[loop->header];
+    int last_block = loop->header + loop->num_blocks - 1;
+
+    if (loop->num_blocks < 2 || loop->num_latches != 1 || loop->latches[0] != last_block) return false;
+    for (int b = loop->header; b <= last_block; b++) {
+        if (b >= cfg->num_blocks || !loop_contains(loop, b)) return false;
+    }
+    IRCode *label = &cfg->list->codes[header->start];
+    IRCode *branch = &cfg->list->codes[header->end - 1];
+    IRCode *latch_jump = &cfg->list->codes[cfg->blocks[last_block].end - 1];
+    if (label->op != IR_LABEL || !label->result || latch_jump->op != IR_GOTO) return false;
+    if (!ir_is_cond_branch(branch) || header->num_succs != 2) return false;
+    return header->succs[0] == loop->header + 1 && !loop_contains(loop, header->succs[1]);
+}
+
+static bool rotate_loop(LoopEditor *ed, int loop_index, IRSymbol **temp_map) {
+    LoopNest *nest = ed->nest;
+    CFG *cfg = nest->cfg;
+    SSAGraph *ssa = nest->ssa;
+    Loop *loop = &nest->loops[loop_index];
+    if (!rotate_candidate(nest, loop)) return false;
+
+    BasicBlock *header = &cfg->blocks[loop->header];
+    int last_block = loop->header + loop->num_blocks - 1;
+    int first = header->start - cfg->start;
+    int branch = header->end - 1 - cfg->start;
+    int latch = cfg->blocks[last_block].end - 1 - cfg->start;
+    int n = ssa->num_instrs;
+
+    // Temporales del header que no salen de él: la copia usa nombres nuevos
+    memset(temp_map, 0, cfg->num_syms * sizeof(IRSymbol *));
+    for (int rel = first + 1; rel < branch; rel++) {
+        IRCode *code = &cfg->list->codes[cfg->start + rel];
+        int sym = cfg->def_of[rel];
+        if (sym < 0 || !code->result || code->result->type != IR_SYM_TEMP) continue;
+        bool local = true;
+        for (int u = ssa->user_start[rel]; u < ssa->user_start[rel + 1] && local; u++) {
+            int user = ssa->users[u];
+            local = user < n && cfg->block_of[user] == loop->header;
+        }
+        if (local) {
+            temp_map[sym] = new_temp_symbol();
+            temp_map[sym]->data_type = code->result->data_type;
+        }
+    }
+
+    IRSymbol *body_label = new_label_symbol();
+    loop_editor_insert_after(ed, branch, (IRCode){IR_LABEL, NULL, NULL, body_label});
+    loop_editor_remove(ed, latch);
+    for (int rel = first + 1; rel <= branch; rel++) {
+        IRCode code = cfg->list->codes[cfg->start + rel];
+        if (ir_is_nop(&code)) continue;
+        IRSymbol **operands[3] = {&code.arg1, &code.arg2, &code.result};
+        for (int k = 0; k < 3; k++) {
+            IRSymbol *sym = *operands[k];
+            if (!sym || sym->type != IR_SYM_TEMP) continue;
+            int index = cfg_sym_index(cfg, sym->name);
+            if (index >= 0 && temp_map[index]) *operands[k] = temp_map[index];
+        }
+        if (rel == branch) {
+            code.op = negate_branch_op(code.op);
+            code.result = body_label;
+        }
+        loop_editor_insert_after(ed, latch, code);
+    }
+    int exit = cfg->blocks[loop->header].succs[1];
+    if (exit != last_block + 1) {
+        IRSymbol *exit_label = cfg->list->codes[cfg->start + branch].result;
+        loop_editor_insert_after(ed, latch, (IRCode){IR_GOTO, NULL, NULL, exit_label});
+    }
+
+    if (debug_mode) {
+        printf("  [ROT] Línea %d: loop rotado, la condición se repite al final del cuerpo (%s)\n",
+               cfg->start + first, body_label->name);
+    }
+    return true;
+}
+
+static int rotate_function(IRList *list, int start, int *count) {
+    CFG cfg;
+    SSAGraph ssa;
+    LoopNest nest;
+    cfg_build(&cfg, list, start);
+    ssa_build(&ssa, &cfg);
+    loop_nest_build(&nest, &cfg, &ssa);
+
+    int end = cfg.end;
+    if (nest.num_loops > 0) {
+        IRSymbol **temp_map = df_alloc(cfg.num_syms, sizeof(IRSymbol *));
+        LoopEditor ed;
+        loop_editor_init(&ed, &nest);
+        for (int l = 0; l < nest.num_loops; l++) {
+            if (rotate_loop(&ed, l, temp_map)) (*count)++;
+        }
+        end = loop_editor_apply(&ed);
+        loop_editor_free(&ed);
+        free(temp_map);
+    }
+
+    loop_nest_free(&nest);
+    ssa_free(&ssa);
+    cfg_free(&cfg);
+    return end;
+}
+
+void optimize_loop_rotation(IRList *list) {
+    int count = 0;
+
+    for (int start = 0; start < list->size; start++) {
+        if (list->codes[start].op != IR_METHOD) continue;
+        start = rotate_function(list, start, &count) - 1;
+    }
+
+    if (count > 0 && debug_mode) {
+        printf("✓ Rotación de loops: %d loops con la condición al final\n", count);
+    }
+}
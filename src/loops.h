@@ -0,0 +1,93 @@
+#ifndef LOOPS_H
+#define LOOPS_H
+
+#include "intermediate.h"
+#include "dataflow.h"
+
+/*
+ * Loop natural: un header que domina a todos sus bloques y al menos una arista
+ * de vuelta (latch -> header). Los loops con el mismo header se unen en uno.
+ */
+typedef struct {
+    int header;
+    BitSet body;            // Bloques del loop, indexados por bloque del CFG
+    int *blocks;            // Los mismos bloques, en orden RPO
+    int num_blocks;
+    int *latches;           // Bloques con una arista de vuelta al header
+    int num_latches;
+    int parent;             // Loop que lo contiene directamente, -1 si es externo
+    int depth;              // 1 para los loops externos
+} Loop;
+
+/*
+ * Loops de una función, ordenados de afuera hacia adentro: un loop siempre
+ * aparece antes que los que contiene.
+ */
+typedef struct {
+    CFG *cfg;
+    SSAGraph *ssa;
+    Loop *loops;
+    int num_loops;
+    int *innermost;         // Loop más interno de cada bloque, -1 si no está en ninguno
+} LoopNest;
+
+void loop_nest_build(LoopNest *nest, CFG *cfg, SSAGraph *ssa);
+void loop_nest_free(LoopNest *nest);
+bool loop_contains(Loop *loop, int block);
+bool block_dominates(SSAGraph *ssa, int a, int b);
+void loop_local_temps(LoopNest *nest, int loop, bool *local);
+
+/*
+ * Cambios pendientes sobre la función del LoopNest. Las posiciones son índices
+ * relativos al METHOD; los cambios en una misma posición se aplican en el orden
+ * en que se pidieron. Reemplazar por un NOP borra la instrucción.
+ */
+typedef enum {
+    LOOP_EDIT_BEFORE,
+    LOOP_EDIT_REPLACE,
+    LOOP_EDIT_AFTER
+} LoopEditKind;
+
+typedef struct {
+    int pos;
+    LoopEditKind kind;
+    int seq;
+    IRCode code;
+} LoopEdit;
+
+typedef struct {
+    LoopNest *nest;
+    LoopEdit *edits;
+    int count;
+    int capacity;
+    bool *preheader_ready;      // Por loop: ya se preparó la entrada al preheader
+    IRSymbol **preheader_label; // Por loop: etiqueta nueva del preheader, NULL si no hizo falta
+    IRSymbol **redirect;        // Por instrucción: nuevo destino del salto al header
+    int num_preheaders;
+    int num_new_labels;
+} LoopEditor;
+
+void loop_editor_init(LoopEditor *ed, LoopNest *nest);
+void loop_editor_free(LoopEditor *ed);
+void loop_editor_insert_before(LoopEditor *ed, int pos, IRCode code);
+void loop_editor_insert_after(LoopEditor *ed, int pos, IRCode code);
+void loop_editor_replace(LoopEditor *ed, int pos, IRCode code);
+void loop_editor_remove(LoopEditor *ed, int pos);
+bool loop_has_preheader_slot(LoopNest *nest, int loop);
+void loop_editor_preheader(LoopEditor *ed, int loop, IRCode code);
+int loop_editor_apply(LoopEditor *ed);
+
+/*
+ * Rondas de unswitching por función: cada una desdobla un loop
+ */
+#define UNSWITCH_MAX_ROUNDS 8
+
+/*
+ * Pases sobre loops
+ */
+void optimize_loop_invariant_code_motion(IRList *list);
+void optimize_induction_variables(IRList *list);
+void optimize_loop_unswitching(IRList *list);
+void optimize_loop_rotation(IRList *list);
+
+#endif
@@ -0,0 +1,196 @@
+#include "memo.h"
+#include "optimizer.h"
+#include "dataflow.h"
+#include "callgraph.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Memoización automática.
+ *
+ * Una función es pura si su resultado depende sólo de sus argumentos: no llama
+ * a externos, no escribe globales y sólo lee las que ningún método modifica,
+ * contando todo lo que llama. La pureza y la recursión salen del grafo de
+ * llamadas.
+ *
+ * Las funciones puras, recursivas y de un solo parámetro reciben una tabla
+ * propia. Al entrar se busca la clave (el valor del parámetro) y si está se
+ * devuelve el resultado guardado; si no, cada RETURN guarda su valor antes de
+ * salir. La tabla es de tamaño fijo y cada entrada guarda su clave, así que una
+ * colisión sólo pisa un resultado anterior.
+ *
+ * Si todas las llamadas recursivas son de la forma f(n ± c) con c chico, las
+ * claves son un rango de enteros consecutivos y la tabla se indexa directamente
+ * con la clave; si no, con un hash multiplicativo sobre una tabla más grande.
+ *
+ * Corre al final del pipeline: ningún pase ve las instrucciones MEMO_*, que el
+ * backend traduce a accesos a una tabla en .bss.
+ */
+
+typedef struct {
+    const char *name;
+    int start;
+    int end;
+    int num_params;
+} MemoFunc;
+
+/*
+ * Indica si sym es param ± c con |c| <= MEMO_MAX_STEP, buscando su definición
+ * en la función.
+ */
+static bool is_small_step(IRList *list, MemoFunc *f, IRSymbol *sym, IRSymbol *param) {
+    if (!sym) return false;
+    if (strcmp(sym->name, param->name) == 0) return true;
+    if (sym->type != IR_SYM_TEMP) return false;
+
+    IRCode *def = NULL;
+    for (int i = f->start + 1; i < f->end; i++) {
+        IRSymbol *d = ir_def_symbol(&list->codes[i]);
+        if (!d || strcmp(d->name, sym->name) != 0) continue;
+        if (def) return false;
+        def = &list->codes[i];
+    }
+    if (!def || (def->op != IR_ADD && def->op != IR_SUB)) return false;
+
+    IRSymbol *var = def->arg1, *step = def->arg2;
+    if (def->op == IR_ADD && is_constant_symbol(var)) {
+        var = def->arg2;
+        step = def->arg1;
+    }
+    if (!var || strcmp(var->name, param->name) != 0 || !is_constant_symbol(step)) return false;
+    int c = get_constant_value(step);
+    return c >= -MEMO_MAX_STEP && c <= MEMO_MAX_STEP;
+}
+
+/*
+ * Las claves forman un rango chico si el parámetro es bool o si cada llamada
+ * recursiva directa pasa el parámetro desplazado en una constante chica.
+ */
+static bool keys_in_small_range(IRList *list, MemoFunc *f, StrMap *arities, IRSymbol *param) {
+    if (param->data_type == TYPE_BOOL) return true;
+
+    int n = f->end - f->start;
+    int *call_of = df_alloc(n, sizeof(int));
+    ir_match_call_params(&list->codes[f->start], n, arities, call_of);
+
+    bool small = true;
+    int self_calls = 0;
+    for (int j = 0; j < n && small; j++) {
+        IRCode *code = &list->codes[f->start + j];
+        if (code->op == IR_CALL && code->arg1 && strcmp(code->arg1->name, f->name) == 0) {
+            self_calls++;
+            bool matched = false;
+            for (int a = 0; a < j; a++) {
+                if (call_of[a] != j) continue;
+                matched = true;
+                if (!is_small_step(list, f, list->codes[f->start + a].arg1, param)) small = false;
+            }
+            if (!matched) small = false;
+        }
+    }
+    free(call_of);
+    return small && self_calls > 0;
+}
+
+/*
+ * Envuelve el cuerpo de la función con la búsqueda en la tabla y guarda el
+ * resultado en cada RETURN. Devuelve cuántas instrucciones agrega.
+ */
+static int memoize_function(IRList *list, MemoFunc *f, bool direct) {
+    IRCode *codes = list->codes;
+    IRSymbol *param = codes[f->start + 1].result;
+    int body = f->start + 1 + f->num_params;
+    int n = f->end - f->start;
+
+    IRSymbol *key = new_temp_symbol();
+    key->data_type = param->data_type;
+    IRSymbol *hit = new_temp_symbol();
+    hit->data_type = TYPE_BOOL;
+    IRSymbol *cached = new_temp_symbol();
+    IRSymbol *miss = new_label_symbol();
+
+    IRCode *out = df_alloc(2 * n + 8, sizeof(IRCode));
+    int count = 0;
+    for (int i = f->start; i < body; i++) out[count++] = codes[i];
+    out[count++] = (IRCode){direct ? IR_MEMO_DIRECT : IR_MEMO_HASH,
+                            new_const_symbol(direct ? MEMO_DIRECT_ENTRIES : MEMO_HASH_ENTRIES, 0), NULL, NULL};
+    out[count++] = (IRCode){IR_LOAD, param, NULL, key};
+    out[count++] = (IRCode){IR_MEMO_LOOKUP, key, NULL, hit};
+    out[count++] = (IRCode){IR_IF_FALSE, hit, NULL, miss};
+    out[count++] = (IRCode){IR_MEMO_GET, key, NULL, cached};
+    out[count++] = (IRCode){IR_RETURN, cached, NULL, NULL};
+    out[count++] = (IRCode){IR_LABEL, NULL, NULL, miss};
+    for (int i = body; i < f->end; i++) {
+        if (codes[i].op == IR_RETURN && codes[i].arg1) {
+            out[count++] = (IRCode){IR_MEMO_STORE, key, codes[i].arg1, NULL};
+        }
+        out[count++] = codes[i];
+    }
+
+    ir_replace_range(list, f->start, f->end, out, count);
+    free(out);
+    return count - n;
+}
+
+/*
+ * Indica si todos los RETURN de la función devuelven un valor.
+ */
+static bool returns_value(IRList *list, MemoFunc *f) {
+    for (int i = f->start + 1; i < f->end; i++) {
+        if (list->codes[i].op == IR_RETURN && !list->codes[i].arg1) return false;
+    }
+    return true;
+}
+
+void optimize_memoization(IRList *list) {
+    CallGraph cg;
+    callgraph_build(&cg, list);
+    MemoFunc *funcs = df_alloc(cg.num_nodes, sizeof(MemoFunc));
+    int num_funcs = cg.num_nodes;
+    for (int k = 0; k < num_funcs; k++) {
+        MemoFunc *f = &funcs[k];
+        f->name = cg.nodes[k].name;
+        f->start = cg.nodes[k].start;
+        f->end = cg.nodes[k].end;
+        while (f->start + 1 + f->num_params < f->end && list->codes[f->start + 1 + f->num_params].op == IR_PARAM) {
+            f->num_params++;
+        }
+    }
+
+    StrMap arities;
+    ir_method_arities(list, &arities);
+
+    // De atrás hacia adelante para que los índices de las funciones anteriores no cambien
+    int direct = 0, hashed = 0, growth = 0;
+    for (int k = num_funcs - 1; k >= 0; k--) {
+        MemoFunc *f = &funcs[k];
+        if (!cg.nodes[k].recursive) continue;
+        const char *reason = NULL;
+        if (!cg.nodes[k].pure) reason = "no es pura";
+        else if (!returns_value(list, f)) reason = "tiene un RETURN sin valor";
+        else if (f->num_params != 1) reason = "sólo se memoizan funciones de un parámetro";
+        if (reason) {
+            if (debug_mode) printf("  [MEMO] Línea %d: %s no se memoiza (%s)\n", f->start, f->name, reason);
+            continue;
+        }
+
+        bool small = keys_in_small_range(list, f, &arities, list->codes[f->start + 1].result);
+        growth += memoize_function(list, f, small);
+        if (small) direct++;
+        else hashed++;
+        if (debug_mode) {
+            printf("  [MEMO] Línea %d: %s memoizada con una tabla %s de %d entradas\n", f->start, f->name,
+                   small ? "directa" : "hash", small ? MEMO_DIRECT_ENTRIES : MEMO_HASH_ENTRIES);
+        }
+    }
+
+    if (direct + hashed > 0 && debug_mode) {
+        printf("✓ Memoización: %d funciones (%d con tabla directa, %d con hash), +%d instrucciones\n",
+               direct + hashed, direct, hashed, growth);
+    }
+
+    free(funcs);
+    strmap_free(&arities);
+    callgraph_free(&cg);
+}
@@ -0,0 +1,25 @@
+#ifndef MEMO_H
+#define MEMO_H
+
+#include "intermediate.h"
+
+/*
+ * Entradas de la tabla de memoización de cada función: directa cuando las
+ * claves recorren un rango chico, con hash si no.
+ */
+#define MEMO_DIRECT_ENTRIES     4096
+#define MEMO_HASH_ENTRIES       16384
+
+/*
+ * Distancia máxima entre el parámetro y el argumento de una llamada recursiva
+ * (f(n - 1), f(n - 2), ...) para considerar que las claves forman un rango chico.
+ */
+#define MEMO_MAX_STEP           16
+
+/*
+ * Memoización de funciones puras y recursivas de un parámetro (-memoize): el
+ * resultado de cada llamada se guarda en una tabla propia de la función.
+ */
+void optimize_memoization(IRList *list);
+
+#endif
@@ -0,0 +1,454 @@
+#include "mir.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Detectar la plataforma en tiempo de compilación */
+#ifdef __APPLE__
+    #define PLATFORM_MACOS 1
+    #define SYM_PREFIX "_"
+#else
+    #define PLATFORM_MACOS 0
+    #define SYM_PREFIX ""
+#endif
+
+/*
+ * Agranda un arreglo dinámico o termina el programa con un error.
+ */
+static void *mir_grow(void *ptr, int *capacity, int initial, size_t elem_size) {
+    *capacity = (*capacity == 0) ? initial : *capacity * 2;
+    ptr = realloc(ptr, (size_t)*capacity * elem_size);
+    if (!ptr) {
+        fprintf(stderr, "Error: no se pudo redimensionar el código de máquina\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+/*
+ * Inicializa un módulo vacío.
+ */
+void mir_module_init(MModule *m) {
+    m->functions = NULL;
+    m->num_functions = 0;
+    m->capacity = 0;
+    m->data = NULL;
+    m->num_data = 0;
+    m->data_capacity = 0;
+    m->strings = NULL;
+    m->num_strings = 0;
+    m->strings_capacity = 0;
+}
+
+/*
+ * Libera el módulo con todas sus funciones, bloques e instrucciones.
+ */
+void mir_module_free(MModule *m) {
+    for (int i = 0; i < m->num_functions; i++) {
+        MFunction *f = m->functions[i];
+        for (int b = 0; b < f->num_blocks; b++) {
+            free(f->blocks[b].instrs);
+        }
+        free(f->blocks);
+        free(f);
+    }
+    free(m->functions);
+    free(m->data);
+    for (int i = 0; i < m->num_strings; i++) {
+        free(m->strings[i]);
+    }
+    free(m->strings);
+    mir_module_init(m);
+}
+
+/*
+ * Copia un nombre dentro del módulo; la copia vive hasta mir_module_free().
+ */
+const char *mir_intern(MModule *m, const char *s) {
+    if (m->num_strings >= m->strings_capacity) {
+        m->strings = mir_grow(m->strings, &m->strings_capacity, 64, sizeof(char*));
+    }
+    char *copy = strdup(s);
+    m->strings[m->num_strings++] = copy;
+    return copy;
+}
+
+/*
+ * Agrega una función al final del módulo, con su bloque de entrada vacío.
+ */
+MFunction *mir_begin_function(MModule *m, const char *name) {
+    if (m->num_functions >= m->capacity) {
+        m->functions = mir_grow(m->functions, &m->capacity, 8, sizeof(MFunction*));
+    }
+    MFunction *f = calloc(1, sizeof(MFunction));
+    if (!f) {
+        fprintf(stderr, "Error: no se pudo asignar memoria para MFunction\n");
+        exit(1);
+    }
+    f->module = m;
+    f->name = name ? mir_intern(m, name) : NULL;
+    m->functions[m->num_functions++] = f;
+    mir_begin_block(f, NULL);
+    return f;
+}
+
+/*
+ * Abre un bloque nuevo que empieza en la etiqueta dada.
+ */
+void mir_begin_block(MFunction *f, const char *label) {
+    if (f->num_blocks >= f->capacity) {
+        f->blocks = mir_grow(f->blocks, &f->capacity, 8, sizeof(MBlock));
+    }
+    MBlock *block = &f->blocks[f->num_blocks++];
+    block->label = label ? mir_intern(f->module, label) : NULL;
+    block->instrs = NULL;
+    block->num_instrs = 0;
+    block->capacity = 0;
+}
+
+/*
+ * Cantidad total de instrucciones del módulo.
+ */
+int mir_instr_count(MModule *m) {
+    int count = 0;
+    for (int i = 0; i < m->num_functions; i++) {
+        for (int b = 0; b < m->functions[i]->num_blocks; b++) {
+            count += m->functions[i]->blocks[b].num_instrs;
+        }
+    }
+    return count;
+}
+
+/*
+ * Cantidad de instrucciones del módulo con el opcode dado.
+ */
+int mir_opcode_count(MModule *m, MOpcode op) {
+    int count = 0;
+    for (int i = 0; i < m->num_functions; i++) {
+        for (int b = 0; b < m->functions[i]->num_blocks; b++) {
+            MBlock *block = &m->functions[i]->blocks[b];
+            for (int k = 0; k < block->num_instrs; k++) {
+                if (block->instrs[k].op == op) count++;
+            }
+        }
+    }
+    return count;
+}
+
+/*
+ * Reserva size bytes sin inicializar con el nombre dado; si ya estaba reservado
+ * se conserva el tamaño mayor.
+ */
+void mir_reserve_data(MModule *m, const char *name, int size) {
+    for (int i = 0; i < m->num_data; i++) {
+        if (strcmp(m->data[i].name, name) == 0) {
+            if (size > m->data[i].size) m->data[i].size = size;
+            return;
+        }
+    }
+    if (m->num_data >= m->data_capacity) {
+        m->data = mir_grow(m->data, &m->data_capacity, 4, sizeof(MData));
+    }
+    m->data[m->num_data].name = mir_intern(m, name);
+    m->data[m->num_data].size = size;
+    m->num_data++;
+}
+
+MOperand mir_none(void) {
+    MOperand op = {MOP_NONE, 0, MREG_NONE, -1, 0, NULL};
+    return op;
+}
+
+MOperand mir_reg(MReg reg, int size) {
+    MOperand op = {MOP_REG, size, reg, -1, 0, NULL};
+    return op;
+}
+
+/*
+ * Registro virtual; assigned es el registro físico elegido, o MREG_NONE.
+ */
+MOperand mir_vreg(int vreg, MReg assigned) {
+    MOperand op = {MOP_REG, 8, assigned, vreg, 0, NULL};
+    return op;
+}
+
+MOperand mir_imm(long value) {
+    MOperand op = {MOP_IMM, 8, MREG_NONE, -1, value, NULL};
+    return op;
+}
+
+MOperand mir_mem(MReg base, int offset) {
+    MOperand op = {MOP_MEM, 8, base, -1, offset, NULL};
+    return op;
+}
+
+MOperand mir_label(MFunction *f, const char *name) {
+    MOperand op = {MOP_LABEL, 0, MREG_NONE, -1, 0, mir_intern(f->module, name)};
+    return op;
+}
+
+MOperand mir_symbol(MFunction *f, const char *name) {
+    MOperand op = {MOP_SYMBOL, 0, MREG_NONE, -1, 0, mir_intern(f->module, name)};
+    return op;
+}
+
+MOperand mir_data(MFunction *f, const char *name) {
+    MOperand op = {MOP_DATA, 0, MREG_NONE, -1, 0, mir_intern(f->module, name)};
+    return op;
+}
+
+/*
+ * Indica si dos operandos denotan la misma ubicación o el mismo valor.
+ * Los registros se comparan por el registro físico asignado.
+ */
+int mir_same_operand(MOperand a, MOperand b) {
+    if (a.kind != b.kind) return 0;
+    switch (a.kind) {
+        case MOP_NONE:
+            return 1;
+        case MOP_REG:
+            if (a.reg == MREG_NONE || b.reg == MREG_NONE) return a.vreg == b.vreg;
+            return a.reg == b.reg && a.size == b.size;
+        case MOP_IMM:
+            return a.imm == b.imm;
+        case MOP_MEM:
+            return a.reg == b.reg && a.imm == b.imm;
+        case MOP_LABEL:
+        case MOP_SYMBOL:
+        case MOP_DATA:
+            return strcmp(a.name, b.name) == 0;
+    }
+    return 0;
+}
+
+/*
+ * Agrega una instrucción al último bloque de la función.
+ */
+static MInstr *mir_append(MFunction *f, MOpcode op) {
+    MBlock *block = &f->blocks[f->num_blocks - 1];
+    if (block->num_instrs >= block->capacity) {
+        block->instrs = mir_grow(block->instrs, &block->capacity, 16, sizeof(MInstr));
+    }
+    MInstr *instr = &block->instrs[block->num_instrs++];
+    instr->op = op;
+    instr->cond = MCC_E;
+    instr->src = mir_none();
+    instr->dst = mir_none();
+    instr->text = NULL;
+    return instr;
+}
+
+void mir_emit(MFunction *f, MOpcode op, MOperand src, MOperand dst) {
+    MInstr *instr = mir_append(f, op);
+    instr->src = src;
+    instr->dst = dst;
+}
+
+/*
+ * Inserta una instrucción en una posición de un bloque ya emitido (por ejemplo,
+ * el guardado de registros callee-saved al principio de la función).
+ */
+void mir_insert(MFunction *f, int block_index, int position, MOpcode op, MOperand src, MOperand dst) {
+    MBlock *block = &f->blocks[block_index];
+    if (block->num_instrs >= block->capacity) {
+        block->instrs = mir_grow(block->instrs, &block->capacity, 16, sizeof(MInstr));
+    }
+    memmove(&block->instrs[position + 1], &block->instrs[position],
+            (block->num_instrs - position) * sizeof(MInstr));
+    block->num_instrs++;
+
+    MInstr *instr = &block->instrs[position];
+    instr->op = op;
+    instr->cond = MCC_E;
+    instr->src = src;
+    instr->dst = dst;
+    instr->text = NULL;
+}
+
+void mir_emit_setcc(MFunction *f, MCond cond, MOperand dst) {
+    MInstr *instr = mir_append(f, MIR_SETCC);
+    instr->cond = cond;
+    instr->dst = dst;
+}
+
+void mir_emit_jcc(MFunction *f, MCond cond, MOperand target) {
+    MInstr *instr = mir_append(f, MIR_JCC);
+    instr->cond = cond;
+    instr->src = target;
+}
+
+void mir_emit_comment(MFunction *f, const char *text) {
+    MInstr *instr = mir_append(f, MIR_COMMENT);
+    instr->text = mir_intern(f->module, text);
+}
+
+/*
+ * Impresión
+ */
+
+static const char *reg_names_64[] = {
+    "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+    "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"
+};
+static const char *reg_names_32[] = {
+    "eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi",
+    "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d"
+};
+static const char *reg_names_8[] = {
+    "al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil",
+    "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b"
+};
+static const char *cond_names[] = {"e", "ne", "l", "le", "g", "ge"};
+
+static void print_operand(FILE *out, MOperand op) {
+    switch (op.kind) {
+        case MOP_NONE:
+            break;
+        case MOP_REG:
+            if (op.reg == MREG_NONE) {
+                fprintf(out, "%%v%d", op.vreg);
+            } else if (op.size == 1) {
+                fprintf(out, "%%%s", reg_names_8[op.reg]);
+            } else if (op.size == 4) {
+                fprintf(out, "%%%s", reg_names_32[op.reg]);
+            } else {
+                fprintf(out, "%%%s", reg_names_64[op.reg]);
+            }
+            break;
+        case MOP_IMM:
+            fprintf(out, "$%ld", op.imm);
+            break;
+        case MOP_MEM:
+            fprintf(out, "%ld(%%%s)", op.imm, reg_names_64[op.reg]);
+            break;
+        case MOP_LABEL:
+            fputs(op.name, out);
+            break;
+        case MOP_SYMBOL:
+            fprintf(out, "%s%s", SYM_PREFIX, op.name);
+            break;
+        case MOP_DATA:
+            fprintf(out, "%s%s(%%rip)", SYM_PREFIX, op.name);
+            break;
+    }
+}
+
+/*
+ * Sufijo de tamaño: el del registro destino, o el del origen si el destino
+ * no es un registro; q por defecto.
+ */
+static char size_suffix(MInstr *instr) {
+    int size = 8;
+    if (instr->dst.kind == MOP_REG) size = instr->dst.size;
+    else if (instr->src.kind == MOP_REG) size = instr->src.size;
+    return size == 1 ? 'b' : size == 4 ? 'l' : 'q';
+}
+
+static void print_instr(FILE *out, MInstr *instr) {
+    static const char *names[] = {
+        [MIR_MOV] = "mov", [MIR_ADD] = "add", [MIR_SUB] = "sub", [MIR_IMUL] = "imul",
+        [MIR_SHR] = "shr", [MIR_LEA] = "lea",
+        [MIR_AND] = "and", [MIR_OR] = "or", [MIR_XOR] = "xor", [MIR_NEG] = "neg",
+        [MIR_CMP] = "cmp", [MIR_IDIV] = "idiv", [MIR_PUSH] = "push", [MIR_POP] = "pop"
+    };
+
+    switch (instr->op) {
+        case MIR_COMMENT:
+            fprintf(out, "\t# %s\n", instr->text);
+            return;
+        case MIR_CQTO:
+            fputs("\tcqto\n", out);
+            return;
+        case MIR_LEAVE:
+            fputs("\tleave\n", out);
+            return;
+        case MIR_RET:
+            fputs("\tret\n", out);
+            return;
+        case MIR_MOVZB:
+            fprintf(out, "\tmovzb%c\t", size_suffix(instr));
+            break;
+        case MIR_SETCC:
+            fprintf(out, "\tset%s\t", cond_names[instr->cond]);
+            break;
+        case MIR_JCC:
+            fprintf(out, "\tj%s\t", cond_names[instr->cond]);
+            break;
+        case MIR_JMP:
+            fputs("\tjmp\t", out);
+            break;
+        case MIR_CALL:
+            fputs("\tcall\t", out);
+            break;
+        default:
+            fprintf(out, "\t%s%c\t", names[instr->op], size_suffix(instr));
+            break;
+    }
+
+    if (instr->src.kind != MOP_NONE && instr->dst.kind != MOP_NONE) {
+        print_operand(out, instr->src);
+        fputs(", ", out);
+        print_operand(out, instr->dst);
+    } else if (instr->src.kind != MOP_NONE) {
+        print_operand(out, instr->src);
+    } else {
+        print_operand(out, instr->dst);
+    }
+    fputc('\n', out);
+}
+
+/*
+ * Directivas y prólogo estándar de una función.
+ */
+static void print_function_header(FILE *out, MFunction *f) {
+    #if PLATFORM_MACOS
+    /* macOS usa sintaxis diferente para directivas */
+    fprintf(out, ".globl %s%s\n", SYM_PREFIX, f->name);
+    fprintf(out, "%s%s:\n", SYM_PREFIX, f->name);
+    #else
+    /* Linux usa .globl y .type */
+    fprintf(out, ".globl %s\n", f->name);
+    fprintf(out, ".type %s, @function\n", f->name);
+    fprintf(out, "%s:\n", f->name);
+    #endif
+
+    fputs("\tpushq\t%rbp\n", out);
+    fputs("\tmovq\t%rsp, %rbp\n", out);
+    fprintf(out, "\tsubq\t$%d, %%rsp\n", f->frame_size);
+}
+
+/*
+ * Imprime el módulo completo en sintaxis AT&T.
+ */
+void mir_print_module(MModule *m, FILE *out) {
+    fputs(".text\n", out);
+
+    for (int i = 0; i < m->num_functions; i++) {
+        MFunction *f = m->functions[i];
+        if (f->name) {
+            print_function_header(out, f);
+        }
+        for (int b = 0; b < f->num_blocks; b++) {
+            MBlock *block = &f->blocks[b];
+            if (block->label) {
+                fprintf(out, "%s:\n", block->label);
+            }
+            for (int k = 0; k < block->num_instrs; k++) {
+                print_instr(out, &block->instrs[k]);
+            }
+        }
+    }
+
+    // Tablas en .bss, alineadas a 32 bytes (en macOS la alineación va como potencia de 2)
+    for (int i = 0; i < m->num_data; i++) {
+        #if PLATFORM_MACOS
+        fprintf(out, ".comm %s%s,%d,5\n", SYM_PREFIX, m->data[i].name, m->data[i].size);
+        #else
+        fprintf(out, ".comm %s,%d,32\n", m->data[i].name, m->data[i].size);
+        #endif
+    }
+
+    #if !PLATFORM_MACOS
+    /* Solo en Linux - macOS no necesita esta sección */
+    fputs(".section\t.note.GNU-stack,\"\",@progbits\n", out);
+    #endif
+}
@@ -0,0 +1,191 @@
+#ifndef MIR_H
+#define MIR_H
+
+#include <stdio.h>
+
+/*
+ * IR de máquina (MIR): instrucciones x86-64 ya seleccionadas, con operandos
+ * estructurados en lugar de texto. Cada función es una lista de bloques y cada
+ * bloque empieza en una etiqueta. Las pasadas posteriores a la selección de
+ * instrucciones (asignación de registros, peephole, layout) trabajan sobre estas
+ * estructuras; el texto AT&T se imprime recién al final con mir_print_module().
+ */
+
+/*
+ * Registros físicos, en el orden de su codificación en x86-64.
+ */
+typedef enum {
+    MREG_RAX,
+    MREG_RCX,
+    MREG_RDX,
+    MREG_RBX,
+    MREG_RSP,
+    MREG_RBP,
+    MREG_RSI,
+    MREG_RDI,
+    MREG_R8,
+    MREG_R9,
+    MREG_R10,
+    MREG_R11,
+    MREG_R12,
+    MREG_R13,
+    MREG_R14,
+    MREG_R15,
+    MREG_NONE           // Registro virtual todavía sin asignar
+} MReg;
+
+typedef enum {
+    MOP_NONE,
+    MOP_REG,            // Registro físico o virtual
+    MOP_IMM,            // Inmediato
+    MOP_MEM,            // offset(base)
+    MOP_LABEL,          // Destino de un salto
+    MOP_SYMBOL,         // Función externa o global
+    MOP_DATA            // Dirección de datos del módulo, relativa a %rip
+} MOperandKind;
+
+typedef struct {
+    MOperandKind kind;
+    int size;           // Tamaño en bytes de un registro: 8, 4 o 1
+    MReg reg;           // MOP_REG: registro físico; MOP_MEM: registro base
+    int vreg;           // MOP_REG: número de registro virtual, -1 si es físico
+    long imm;           // MOP_IMM: valor; MOP_MEM: desplazamiento
+    const char *name;   // MOP_LABEL, MOP_SYMBOL y MOP_DATA
+} MOperand;
+
+/*
+ * Condiciones de setcc y jcc.
+ */
+typedef enum {
+    MCC_E,
+    MCC_NE,
+    MCC_L,
+    MCC_LE,
+    MCC_G,
+    MCC_GE
+} MCond;
+
+/*
+ * Opcodes. El sufijo de tamaño (q, l, b) no forma parte del opcode: se deduce
+ * de los operandos al imprimir.
+ */
+typedef enum {
+    MIR_MOV,
+    MIR_MOVZB,          // movzbl: extiende un byte con ceros
+    MIR_ADD,
+    MIR_SUB,
+    MIR_IMUL,
+    MIR_SHR,
+    MIR_LEA,
+    MIR_AND,
+    MIR_OR,
+    MIR_XOR,
+    MIR_NEG,
+    MIR_CMP,
+    MIR_CQTO,
+    MIR_IDIV,
+    MIR_PUSH,
+    MIR_POP,
+    MIR_SETCC,
+    MIR_JMP,
+    MIR_JCC,
+    MIR_CALL,
+    MIR_LEAVE,
+    MIR_RET,
+    MIR_COMMENT
+} MOpcode;
+
+/*
+ * Instrucción en orden AT&T: op src, dst. Las de un solo operando usan dst si
+ * lo escriben (neg, pop, setcc) y src si sólo lo leen (push, idiv, saltos, call).
+ */
+typedef struct {
+    MOpcode op;
+    MCond cond;         // MIR_SETCC y MIR_JCC
+    MOperand src;
+    MOperand dst;
+    const char *text;   // MIR_COMMENT
+} MInstr;
+
+typedef struct {
+    const char *label;  // NULL en el bloque de entrada
+    MInstr *instrs;
+    int num_instrs;
+    int capacity;
+} MBlock;
+
+/*
+ * Función de máquina. Con name == NULL agrupa el código que aparece fuera de
+ * toda función y se imprime sin directivas ni prólogo.
+ */
+typedef struct MModule MModule;
+
+typedef struct {
+    MModule *module;
+    const char *name;
+    MBlock *blocks;
+    int num_blocks;
+    int capacity;
+    int frame_size;     // Bytes reservados en el prólogo (múltiplo de 16)
+} MFunction;
+
+/*
+ * Zona de datos sin inicializar (.bss) reservada por el módulo.
+ */
+typedef struct {
+    const char *name;
+    int size;           // Bytes
+} MData;
+
+struct MModule {
+    MFunction **functions;
+    int num_functions;
+    int capacity;
+    MData *data;
+    int num_data;
+    int data_capacity;
+    char **strings;     // Nombres copiados por mir_intern()
+    int num_strings;
+    int strings_capacity;
+};
+
+/*
+ * Módulo y funciones
+ */
+void mir_module_init(MModule *m);
+void mir_module_free(MModule *m);
+const char *mir_intern(MModule *m, const char *s);
+MFunction *mir_begin_function(MModule *m, const char *name);
+void mir_begin_block(MFunction *f, const char *label);
+int mir_instr_count(MModule *m);
+int mir_opcode_count(MModule *m, MOpcode op);
+void mir_reserve_data(MModule *m, const char *name, int size);
+
+/*
+ * Operandos
+ */
+MOperand mir_none(void);
+MOperand mir_reg(MReg reg, int size);
+MOperand mir_vreg(int vreg, MReg assigned);
+MOperand mir_imm(long value);
+MOperand mir_mem(MReg base, int offset);
+MOperand mir_label(MFunction *f, const char *name);
+MOperand mir_symbol(MFunction *f, const char *name);
+MOperand mir_data(MFunction *f, const char *name);
+int mir_same_operand(MOperand a, MOperand b);
+
+/*
+ * Emisión de instrucciones en el último bloque de la función
+ */
+void mir_emit(MFunction *f, MOpcode op, MOperand src, MOperand dst);
+void mir_emit_setcc(MFunction *f, MCond cond, MOperand dst);
+void mir_emit_jcc(MFunction *f, MCond cond, MOperand target);
+void mir_emit_comment(MFunction *f, const char *text);
+void mir_insert(MFunction *f, int block_index, int position, MOpcode op, MOperand src, MOperand dst);
+
+/*
+ * Impresión en sintaxis AT&T
+ */
+void mir_print_module(MModule *m, FILE *out);
+
+#endif
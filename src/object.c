@@ -1,41 +1,26 @@
 #include "object.h"
 #include "intermediate.h"
-
-/* Llevamos la cuenta de la cantidad de registros temporales. */
-static int temp_register_count = 0;
-
-/* Detectar la plataforma en tiempo de compilación */
-#ifdef __APPLE__
-    #define PLATFORM_MACOS 1
-    #define SYM_PREFIX "_"
-#else
-    #define PLATFORM_MACOS 0
-    #define SYM_PREFIX ""
-#endif
+#include "regalloc.h"
 
 /*
- * Inicializamos el buffer resultante.
+ * Registro físico de cada temporal de la función que se está traduciendo,
+ * calculado por regalloc_function() antes de traducir su cuerpo.
  */
-void object_init(ObjectCode *obj) {
-    obj->lines = NULL;
-    obj->size = 0;
-    obj->capacity = 0;
-}
+static RegAllocation allocation;
 
 /*
- * Liberamos el buffer (libera la memoria)
+ * Tabla de memoización de la función que se está traduciendo, fijada por el
+ * MEMO_DIRECT o MEMO_HASH del principio de su cuerpo. Cada entrada ocupa
+ * MEMO_ENTRY_SIZE bytes: el valor en 0, la marca de ocupada en 8 y la clave en 16.
  */
-void object_free(ObjectCode *obj) {
-    if (obj->lines) {
-        for (int i = 0; i < obj->size; i++) {
-            free(obj->lines[i]);
-        }
-        free(obj->lines);
-        obj->lines = NULL;
-    }
-    obj->size = 0;
-    obj->capacity = 0;
-}
+#define MEMO_ENTRY_SIZE         32
+#define MEMO_HASH_MULTIPLIER    0x9E3779B97F4A7C15L     // 2^64 / phi, hash de Fibonacci
+
+static struct {
+    char name[256];
+    int entries;            // Potencia de 2
+    int hashed;
+} memo_table;
 
 /*
  * Inicializador de la tabla de variables, la "symbol table" del stack frame.
@@ -62,21 +47,6 @@ void var_table_free(VarTable *table) {
     table->capacity = 0;
 }
 
-/*
- * Toma una instrucción del IR, la traduce a código objeto y la agrega al resultado.
- */
-void object_emit(ObjectCode *obj, const char *line) {
-    if (obj->size >= obj->capacity) {
-        obj->capacity = (obj->capacity == 0) ? 32 : obj->capacity * 2;
-        obj->lines = realloc(obj->lines, obj->capacity * sizeof(char*));
-        if (!obj->lines) {
-            fprintf(stderr, "Error: no se pudo redimensionar ObjectCode\n");
-            exit(1);
-        }
-    }
-    obj->lines[obj->size++] = strdup(line);
-}
-
 /*
  * Agrega una variable local a la tabla y le asigna un offset negativo desde %rbp.
  * Cada variable ocupa 8 bytes (qword)
@@ -87,7 +57,7 @@ int var_table_add(VarTable *table, const char *name) {
             return table->vars[i].offset;
         }
     }
-    
+
     if (table->count >= table->capacity) {
         table->capacity = (table->capacity == 0) ? 8 : table->capacity * 2;
         table->vars = realloc(table->vars, table->capacity * sizeof(VarInfo));
@@ -96,14 +66,14 @@ int var_table_add(VarTable *table, const char *name) {
             exit(1);
         }
     }
-    
+
     table->stack_size += 8;
     int offset = -table->stack_size;
-    
+
     table->vars[table->count].name = strdup(name);
     table->vars[table->count].offset = offset;
     table->count++;
-    
+
     return offset;
 }
 
@@ -132,523 +102,692 @@ int is_temp_var(const char *name) {
  */
 int is_constant(const char *name) {
     if (!name) return 0;
-    return (name[0] == '-' && name[1] >= '0' && name[1] <= '9') || 
+    return (name[0] == '-' && name[1] >= '0' && name[1] <= '9') ||
            (name[0] >= '0' && name[0] <= '9');
 }
 
 /*
  * Detecta si un nombre es una etiqueta.
- * Como "L1", "L2", entre otros. 
+ * Como "L1", "L2", entre otros.
  */
 int is_label(const char *name) {
     return name && name[0] == 'L' && (name[1] >= '0' && name[1] <= '9');
 }
 
 /*
- * Asigna un registro a cada variable temporal.
+ * Registro asignado a un temporal, MREG_NONE si vive en el stack frame.
  */
-const char* get_register_for_temp(const char *temp_name) {
-    static const char* registers[] = {"%rbx", "%rcx", "%rdx", "%rsi", "%rdi", "%r8", "%r9", "%rax"};
-    static int temp_to_reg[256];
-    static int initialized = 0;
-    
-    if (!initialized) {
-        memset(temp_to_reg, -1, sizeof(temp_to_reg));
-        initialized = 1;
+MReg get_register_for_temp(const char *temp_name) {
+    if (!is_temp_var(temp_name)) return MREG_RAX;
+    return regalloc_temp_register(&allocation, temp_name);
+}
+
+/*
+ * Operando de un temporal: su registro, o su lugar en el stack frame si la
+ * asignación de registros no le encontró uno. Un resultado que es una variable
+ * (v = a + b, tras la coalescencia de copias) se escribe en su lugar del frame.
+ */
+static MOperand temp_operand(const char *temp_name, VarTable *vars) {
+    MReg reg = is_temp_var(temp_name) ? get_register_for_temp(temp_name) : MREG_NONE;
+    if (reg == MREG_NONE) {
+        return mir_mem(MREG_RBP, var_table_add(vars, temp_name));
     }
-    
-    if (!is_temp_var(temp_name)) return "%rax";
-    
-    int temp_num = atoi(temp_name + 1);
-    if (temp_num < 0 || temp_num >= 256) return "%rax";
-    
-    if (temp_to_reg[temp_num] == -1) {
-        temp_to_reg[temp_num] = temp_register_count % 8;
-        temp_register_count++;
+    return mir_vreg(is_temp_var(temp_name) ? atoi(temp_name + 1) : -1, reg);
+}
+
+/*
+ * Función en la que se está emitiendo código: la última del módulo. El código
+ * previo al primer METHOD queda en una función sin nombre.
+ */
+static MFunction *active_function(MModule *module) {
+    if (module->num_functions == 0) {
+        return mir_begin_function(module, NULL);
     }
-    
-    return registers[temp_to_reg[temp_num]];
+    return module->functions[module->num_functions - 1];
 }
 
 /*
- * Genera el prologo de una función.
+ * Guarda los registros callee-saved que usa la función al principio del bloque
+ * de entrada y los restaura antes de cada leave. Cada uno ocupa un lugar en el
+ * stack frame, con un nombre que no puede chocar con una variable.
  */
-void translate_prologue(ObjectCode *obj, const char *func_name, VarTable *vars) {
-    char line[256];
-    
-    #if PLATFORM_MACOS
-    /* macOS usa sintaxis diferente para directivas */
-    snprintf(line, sizeof(line), ".globl %s%s", SYM_PREFIX, func_name);
-    object_emit(obj, line);
-    snprintf(line, sizeof(line), "%s%s:", SYM_PREFIX, func_name);
-    object_emit(obj, line);
-    #else
-    /* Linux usa .globl y .type */
-    snprintf(line, sizeof(line), ".globl %s", func_name);
-    object_emit(obj, line);
-    snprintf(line, sizeof(line), ".type %s, @function", func_name);
-    object_emit(obj, line);
-    snprintf(line, sizeof(line), "%s:", func_name);
-    object_emit(obj, line);
-    #endif
-    
-    /* Prólogo estándar - compatible en ambas plataformas */
-    snprintf(line, sizeof(line), "\tpushq\t%%rbp");
-    object_emit(obj, line);
-    snprintf(line, sizeof(line), "\tmovq\t%%rsp, %%rbp");
-    object_emit(obj, line);
-    snprintf(line, sizeof(line), "\tsubq\t$%d, %%rsp", 0);  // Se actualizará después
-    object_emit(obj, line);
+static void save_callee_saved(MFunction *f, VarTable *vars, unsigned registers) {
+    int position = 0;
+    for (int r = 0; r < MREG_NONE; r++) {
+        if (!(registers & (1u << r))) continue;
+
+        char slot_name[32];
+        snprintf(slot_name, sizeof(slot_name), "%%callee_saved%d", r);
+        MOperand slot = mir_mem(MREG_RBP, var_table_add(vars, slot_name));
+        MOperand reg = mir_reg((MReg)r, 8);
+
+        mir_insert(f, 0, position++, MIR_MOV, reg, slot);
+        for (int b = 0; b < f->num_blocks; b++) {
+            MBlock *block = &f->blocks[b];
+            for (int i = (b == 0 ? position : 0); i < block->num_instrs; i++) {
+                if (block->instrs[i].op == MIR_LEAVE) {
+                    mir_insert(f, b, i, MIR_MOV, slot, reg);
+                    i++;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Cierra el stack frame de la función actual: guarda los registros callee-saved
+ * que usa, fija su tamaño alineado a 16 bytes y vacía la tabla de variables para
+ * la función siguiente.
+ */
+static void close_frame(MModule *module, VarTable *vars) {
+    if (module->num_functions > 0) {
+        MFunction *f = active_function(module);
+        if (f->name && allocation.callee_saved) {
+            save_callee_saved(f, vars, allocation.callee_saved);
+        }
+        f->frame_size = ((vars->stack_size + 15) / 16) * 16;
+    }
+    var_table_free(vars);
+    var_table_init(vars);
+}
+
+/*
+ * Abre una función nueva con su propio stack frame. Las directivas y el prólogo
+ * se imprimen a partir de la MFunction, cuando ya se conoce el tamaño del frame.
+ */
+MFunction *translate_prologue(MModule *module, const char *func_name, VarTable *vars) {
+    close_frame(module, vars);
+    return mir_begin_function(module, func_name);
 }
 
 /*
  * Genera el epilogo de una función.
  */
-void translate_epilogue(ObjectCode *obj) {
-    object_emit(obj, "\tleave");
-    object_emit(obj, "\tret");
+void translate_epilogue(MFunction *f) {
+    mir_emit(f, MIR_LEAVE, mir_none(), mir_none());
+    mir_emit(f, MIR_RET, mir_none(), mir_none());
 }
 
 /*
- * Traduce de una instrucción IR a su equivalente en código objeto.
+ * Devuelve el operando de un nombre del IR: el registro de un temporal, un
+ * inmediato para las constantes o la dirección en el stack frame de una variable.
  */
-void translate_ir_instruction(ObjectCode *obj, IRCode *code, VarTable *vars) {
-    char line[512];
-    
+static MOperand operand_ref(const char *name, VarTable *vars) {
+    if (is_temp_var(name)) {
+        return temp_operand(name, vars);
+    }
+    if (is_constant(name)) {
+        return mir_imm(atol(name));
+    }
+    return mir_mem(MREG_RBP, var_table_add(vars, name));
+}
+
+/*
+ * Indica si un operando es un bool, es decir, vale 0 o 1 sin normalizar.
+ */
+static int is_bool_operand(IRSymbol *sym) {
+    if (sym->data_type == TYPE_BOOL) return 1;
+    return strcmp(sym->name, "0") == 0 || strcmp(sym->name, "1") == 0;
+}
+
+/*
+ * Copia un operando a otro, salvo que ya esté ahí. No hay movq de memoria a
+ * memoria: en ese caso el valor pasa por %r10.
+ */
+static void emit_move(MFunction *f, MOperand src, MOperand dst) {
+    if (mir_same_operand(src, dst)) return;
+    if (src.kind == MOP_MEM && dst.kind == MOP_MEM) {
+        mir_emit(f, MIR_MOV, src, mir_reg(MREG_R10, 8));
+        src = mir_reg(MREG_R10, 8);
+    }
+    mir_emit(f, MIR_MOV, src, dst);
+}
+
+/*
+ * Registro donde se calcula un resultado: el del temporal o, si el temporal vive
+ * en el stack, %r11 (imulq no acepta memoria como destino y las operaciones de
+ * dos operandos no admiten dos en memoria). store_result lo copia a su lugar.
+ */
+static MOperand result_register(MOperand result) {
+    return result.kind == MOP_MEM ? mir_reg(MREG_R11, 8) : result;
+}
+
+static void store_result(MFunction *f, MOperand value, MOperand result) {
+    emit_move(f, value, result);
+}
+
+/*
+ * Mueve a result el valor 0/1 que quedó en %al tras un setcc.
+ */
+static void emit_bool_result(MFunction *f, MOperand result) {
+    mir_emit(f, MIR_MOVZB, mir_reg(MREG_RAX, 1), mir_reg(MREG_RAX, 4));
+    emit_move(f, mir_reg(MREG_RAX, 8), result);
+}
+
+/*
+ * Operaciones de dos operandos que se resuelven sobre el registro resultado:
+ * addq, subq e imulq aceptan inmediatos y memoria como fuente.
+ */
+static void translate_arith(MFunction *f, MOpcode op, int commutative,
+                            IRCode *code, VarTable *vars) {
+    MOperand op1 = operand_ref(code->arg1->name, vars);
+    MOperand op2 = operand_ref(code->arg2->name, vars);
+    MOperand result = temp_operand(code->result->name, vars);
+    MOperand dst = result_register(result);
+
+    // Si el segundo operando vive en el registro destino, no puede pisarse
+    if (mir_same_operand(op2, dst) && !mir_same_operand(op1, dst)) {
+        if (commutative) {
+            MOperand tmp = op1;
+            op1 = op2;
+            op2 = tmp;
+        } else {
+            mir_emit(f, MIR_MOV, op2, mir_reg(MREG_R10, 8));
+            op2 = mir_reg(MREG_R10, 8);
+        }
+    }
+
+    emit_move(f, op1, dst);
+    mir_emit(f, op, op2, dst);
+    store_result(f, dst, result);
+}
+
+/*
+ * Deja op1 en un operando válido como destino de cmpq: cmpq no admite un
+ * inmediato como destino ni dos operandos en memoria, en esos casos el primer
+ * operando pasa antes por %r10.
+ */
+static MOperand compare_operands(MFunction *f, IRCode *code, VarTable *vars, MOperand *op2) {
+    MOperand op1 = operand_ref(code->arg1->name, vars);
+    *op2 = operand_ref(code->arg2->name, vars);
+
+    if (op1.kind == MOP_IMM || (op1.kind == MOP_MEM && op2->kind == MOP_MEM)) {
+        mir_emit(f, MIR_MOV, op1, mir_reg(MREG_R10, 8));
+        op1 = mir_reg(MREG_R10, 8);
+    }
+    return op1;
+}
+
+/*
+ * Comparaciones: cmpq, setcc sobre %al y extensión a 64 bits.
+ */
+static void translate_compare(MFunction *f, MCond cond, IRCode *code, VarTable *vars) {
+    MOperand op2;
+    MOperand op1 = compare_operands(f, code, vars, &op2);
+    MOperand result = temp_operand(code->result->name, vars);
+
+    mir_emit(f, MIR_CMP, op2, op1);
+    mir_emit_setcc(f, cond, mir_reg(MREG_RAX, 1));
+    emit_bool_result(f, result);
+}
+
+/*
+ * Salto condicional fusionado: un único cmpq seguido del jcc, que el procesador
+ * puede fusionar en una sola micro-operación. Mismas restricciones que translate_compare.
+ */
+static void translate_branch(MFunction *f, MCond cond, IRCode *code, VarTable *vars) {
+    MOperand op2;
+    MOperand op1 = compare_operands(f, code, vars, &op2);
+
+    mir_emit(f, MIR_CMP, op2, op1);
+    mir_emit_jcc(f, cond, mir_label(f, code->result->name));
+}
+
+/*
+ * Operando listo para compararse contra cero: los inmediatos pasan por %r10.
+ */
+static MOperand test_operand(MFunction *f, const char *name, VarTable *vars) {
+    MOperand op = operand_ref(name, vars);
+    if (is_constant(name)) {
+        mir_emit(f, MIR_MOV, op, mir_reg(MREG_R10, 8));
+        return mir_reg(MREG_R10, 8);
+    }
+    return op;
+}
+
+/*
+ * AND y OR lógicos: normalizan ambos operandos a 0/1 y combinan los bytes.
+ */
+static void translate_logical(MFunction *f, MOpcode op, IRCode *code, VarTable *vars) {
+    MOperand result = temp_operand(code->result->name, vars);
+
+    // El setcc sobre %al pisaría un segundo operando que viva en %rax, y el
+    // primero puede ocupar %r10: los casos conflictivos pasan por %r11
+    MOperand op2 = operand_ref(code->arg2->name, vars);
+    if (op2.kind == MOP_IMM || mir_same_operand(op2, mir_reg(MREG_RAX, 8))) {
+        mir_emit(f, MIR_MOV, op2, mir_reg(MREG_R11, 8));
+        op2 = mir_reg(MREG_R11, 8);
+    }
+
+    MOperand op1 = test_operand(f, code->arg1->name, vars);
+    mir_emit(f, MIR_CMP, mir_imm(0), op1);
+    mir_emit_setcc(f, MCC_NE, mir_reg(MREG_RAX, 1));
+
+    mir_emit(f, MIR_CMP, mir_imm(0), op2);
+    mir_emit_setcc(f, MCC_NE, mir_reg(MREG_RDX, 1));
+
+    mir_emit(f, op, mir_reg(MREG_RDX, 1), mir_reg(MREG_RAX, 1));
+    emit_bool_result(f, result);
+}
+
+/*
+ * DIV y MOD con idivq. %rax y %rdx se preservan en %r10/%r11; idivq no acepta
+ * inmediatos, así que un divisor constante se carga antes en un registro libre.
+ */
+static void translate_division(MFunction *f, MReg quotient_reg, IRCode *code, VarTable *vars) {
+    MOperand rax = mir_reg(MREG_RAX, 8), rdx = mir_reg(MREG_RDX, 8);
+    MOperand r10 = mir_reg(MREG_R10, 8), r11 = mir_reg(MREG_R11, 8);
+    MOperand dividend = operand_ref(code->arg1->name, vars);
+    MOperand divisor = operand_ref(code->arg2->name, vars);
+    MOperand result = temp_operand(code->result->name, vars);
+
+    mir_emit(f, MIR_MOV, rax, r10);
+    mir_emit(f, MIR_MOV, rdx, r11);
+
+    // Los valores originales de %rax y %rdx quedan en las copias
+    if (mir_same_operand(dividend, rax)) dividend = r10;
+    else if (mir_same_operand(dividend, rdx)) dividend = r11;
+    if (mir_same_operand(divisor, rax)) divisor = r10;
+    else if (mir_same_operand(divisor, rdx)) divisor = r11;
+
+    mir_emit(f, MIR_MOV, dividend, rax);
+    mir_emit(f, MIR_CQTO, mir_none(), mir_none());
+
+    if (is_constant(code->arg2->name)) {
+        mir_emit(f, MIR_PUSH, r11, mir_none());
+        mir_emit(f, MIR_MOV, divisor, r11);
+        mir_emit(f, MIR_IDIV, r11, mir_none());
+        mir_emit(f, MIR_POP, mir_none(), r11);
+    } else {
+        mir_emit(f, MIR_IDIV, divisor, mir_none());
+    }
+
+    emit_move(f, mir_reg(quotient_reg, 8), result);
+
+    if (!mir_same_operand(result, rdx)) mir_emit(f, MIR_MOV, r11, rdx);
+    if (!mir_same_operand(result, rax)) mir_emit(f, MIR_MOV, r10, rax);
+}
+
+/*
+ * Abre la tabla de memoización de la función actual y le reserva lugar en .bss.
+ */
+static void translate_memo_table(MModule *module, MFunction *f, IRCode *code) {
+    snprintf(memo_table.name, sizeof(memo_table.name), "memo.%s", f->name ? f->name : "global");
+    memo_table.entries = atoi(code->arg1->name);
+    memo_table.hashed = code->op == IR_MEMO_HASH;
+    mir_reserve_data(module, memo_table.name, memo_table.entries * MEMO_ENTRY_SIZE);
+}
+
+/*
+ * Deja en %r11 la dirección de la entrada de la clave. Con tabla directa el
+ * índice son los bits bajos de la clave; con hash, los altos de clave * phi.
+ */
+static void emit_memo_entry(MFunction *f, IRSymbol *key, VarTable *vars) {
+    MOperand r10 = mir_reg(MREG_R10, 8), r11 = mir_reg(MREG_R11, 8);
+    emit_move(f, operand_ref(key->name, vars), r10);
+    if (memo_table.hashed) {
+        int bits = 0;
+        while ((1 << bits) < memo_table.entries) bits++;
+        mir_emit(f, MIR_MOV, mir_imm(MEMO_HASH_MULTIPLIER), r11);
+        mir_emit(f, MIR_IMUL, r11, r10);
+        mir_emit(f, MIR_SHR, mir_imm(64 - bits), r10);
+    } else {
+        mir_emit(f, MIR_AND, mir_imm(memo_table.entries - 1), r10);
+    }
+    mir_emit(f, MIR_IMUL, mir_imm(MEMO_ENTRY_SIZE), r10);
+    mir_emit(f, MIR_LEA, mir_data(f, memo_table.name), r11);
+    mir_emit(f, MIR_ADD, r10, r11);
+}
+
+/*
+ * Traduce una instrucción IR a instrucciones de máquina en la función actual.
+ * Los operandos pueden ser temporales, constantes o variables.
+ */
+void translate_ir_instruction(MModule *module, IRCode *code, VarTable *vars) {
+    MFunction *f = active_function(module);
+    char comment[512];
+
     switch (code->op) {
         case IR_LOAD: {
             const char *src_name = code->arg1 ? code->arg1->name : "0";
-            const char *dst_reg = get_register_for_temp(code->result->name);
-            
-            if (is_constant(src_name)) {
-                snprintf(line, sizeof(line), "\tmovq\t$%s, %s", src_name, dst_reg);
-            } else {
-                int offset = var_table_get_offset(vars, src_name);
-                if (offset != 0) {
-                    snprintf(line, sizeof(line), "\tmovq\t%d(%%rbp), %s", offset, dst_reg);
-                } else {
-                    snprintf(line, sizeof(line), "\tmovq\t%s, %s", src_name, dst_reg);
-                }
-            }
-            object_emit(obj, line);
+            MOperand dst = temp_operand(code->result->name, vars);
+            emit_move(f, operand_ref(src_name, vars), dst);
             break;
         }
-        
+
         case IR_STORE: {
             const char *src_name = code->arg1->name;
-            const char *dst_name = code->result->name;
-            
-            int offset = var_table_add(vars, dst_name);
-
-            if (is_constant(src_name)) {
-                snprintf(line, sizeof(line), "\tmovq\t$%s, %d(%%rbp)", src_name, offset);
-            } else {
-                const char *src_reg = get_register_for_temp(src_name);
-                snprintf(line, sizeof(line), "\tmovq\t%s, %d(%%rbp)", src_reg, offset);
-            }
-            object_emit(obj, line);
+            MOperand dst = mir_mem(MREG_RBP, var_table_add(vars, code->result->name));
+            emit_move(f, operand_ref(src_name, vars), dst);
             break;
         }
-        
-        case IR_ADD: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *reg2 = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            if (strcmp(reg1, result_reg) != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%s, %s", reg1, result_reg);
-                object_emit(obj, line);
-            }
-            snprintf(line, sizeof(line), "\taddq\t%s, %s", reg2, result_reg);
-            object_emit(obj, line);
+
+        case IR_ADD:
+            translate_arith(f, MIR_ADD, 1, code, vars);
             break;
-        }
-        
-        case IR_SUB: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *reg2 = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            if (strcmp(reg1, result_reg) != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%s, %s", reg1, result_reg);
-                object_emit(obj, line);
-            }
-            snprintf(line, sizeof(line), "\tsubq\t%s, %s", reg2, result_reg);
-            object_emit(obj, line);
+
+        case IR_SUB:
+            translate_arith(f, MIR_SUB, 0, code, vars);
             break;
-        }
-        
-        case IR_MUL: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *reg2 = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            if (strcmp(reg1, result_reg) != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%s, %s", reg1, result_reg);
-                object_emit(obj, line);
-            }
-            snprintf(line, sizeof(line), "\timulq\t%s, %s", reg2, result_reg);
-            object_emit(obj, line);
+
+        case IR_MUL:
+            translate_arith(f, MIR_IMUL, 1, code, vars);
             break;
-        }
-        
-        case IR_DIV: {
-            object_emit(obj, "\tmovq\t%rax, %r10");
-            object_emit(obj, "\tmovq\t%rdx, %r11");
-            
-            const char *dividend_reg = get_register_for_temp(code->arg1->name);
-            const char *divisor_reg = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            snprintf(line, sizeof(line), "\tmovq\t%s, %%rax", dividend_reg);
-            object_emit(obj, line);
-            object_emit(obj, "\tcqto");
-            snprintf(line, sizeof(line), "\tidivq\t%s", divisor_reg);
-            object_emit(obj, line);
-            
-            if (strcmp(result_reg, "%rax") != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%%rax, %s", result_reg);
-                object_emit(obj, line);
-            }
-            
-            object_emit(obj, "\tmovq\t%r11, %rdx");
-            object_emit(obj, "\tmovq\t%r10, %rax");
+
+        case IR_DIV:
+            translate_division(f, MREG_RAX, code, vars);
             break;
-        }
-        
-        case IR_MOD: {
-            object_emit(obj, "\tmovq\t%rax, %r10");
-            object_emit(obj, "\tmovq\t%rdx, %r11");
-            
-            const char *dividend_reg = get_register_for_temp(code->arg1->name);
-            const char *divisor_reg = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            snprintf(line, sizeof(line), "\tmovq\t%s, %%rax", dividend_reg);
-            object_emit(obj, line);
-            object_emit(obj, "\tcqto");
-            snprintf(line, sizeof(line), "\tidivq\t%s", divisor_reg);
-            object_emit(obj, line);
-            
-            if (strcmp(result_reg, "%rdx") != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%%rdx, %s", result_reg);
-                object_emit(obj, line);
-            }
-            
-            object_emit(obj, "\tmovq\t%r11, %rdx");
-            object_emit(obj, "\tmovq\t%r10, %rax");
+
+        case IR_MOD:
+            translate_division(f, MREG_RDX, code, vars);
             break;
-        }
-        
-        case IR_LABEL: {
-            #if PLATFORM_MACOS
-            snprintf(line, sizeof(line), "L%s:", code->result->name + 1);
-            #else
-            snprintf(line, sizeof(line), "%s:", code->result->name);
-            #endif
-            object_emit(obj, line);
+
+        case IR_LABEL:
+            mir_begin_block(f, code->result->name);
             break;
-        }
-        
-        case IR_GOTO: {
-            #if PLATFORM_MACOS
-            snprintf(line, sizeof(line), "\tjmp\tL%s", code->result->name + 1);
-            #else
-            snprintf(line, sizeof(line), "\tjmp\t%s", code->result->name);
-            #endif
-            object_emit(obj, line);
+
+        case IR_GOTO:
+            mir_emit(f, MIR_JMP, mir_label(f, code->result->name), mir_none());
             break;
-        }
-        
+
         case IR_IF_FALSE: {
-            const char *cond_reg = get_register_for_temp(code->arg1->name);
-            snprintf(line, sizeof(line), "\tcmpq\t$0, %s", cond_reg);
-            object_emit(obj, line);
-            #if PLATFORM_MACOS
-            snprintf(line, sizeof(line), "\tje\tL%s", code->result->name + 1);
-            #else
-            snprintf(line, sizeof(line), "\tje\t%s", code->result->name);
-            #endif
-            object_emit(obj, line);
+            MOperand cond = test_operand(f, code->arg1->name, vars);
+            mir_emit(f, MIR_CMP, mir_imm(0), cond);
+            mir_emit_jcc(f, MCC_E, mir_label(f, code->result->name));
             break;
         }
-        
+
         case IR_RETURN: {
+            MOperand rax = mir_reg(MREG_RAX, 8);
             if (code->arg1) {
-                const char *ret_reg = get_register_for_temp(code->arg1->name);
-                if (strcmp(ret_reg, "%rax") != 0) {
-                    snprintf(line, sizeof(line), "\tmovq\t%s, %%rax", ret_reg);
-                    object_emit(obj, line);
-                }
+                emit_move(f, operand_ref(code->arg1->name, vars), rax);
             } else {
-                object_emit(obj, "\tmovq\t$0, %rax");
+                mir_emit(f, MIR_MOV, mir_imm(0), rax);
             }
-            translate_epilogue(obj);
+            translate_epilogue(f);
             break;
         }
-        
-        case IR_METHOD: {
-            temp_register_count = 0;
-            translate_prologue(obj, code->result->name, vars);
+
+        case IR_METHOD:
+            translate_prologue(module, code->result->name, vars);
             break;
-        }
-        
-        case IR_EQ: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *reg2 = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            snprintf(line, sizeof(line), "\tcmpq\t%s, %s", reg2, reg1);
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tsete\t%%al");
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tmovzbl\t%%al, %%eax");
-            object_emit(obj, line);
-            if (strcmp(result_reg, "%rax") != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%%rax, %s", result_reg);
-                object_emit(obj, line);
-            }
+
+        case IR_EQ:
+            translate_compare(f, MCC_E, code, vars);
             break;
-        }
-        
-        case IR_NEQ: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *reg2 = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            snprintf(line, sizeof(line), "\tcmpq\t%s, %s", reg2, reg1);
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tsetne\t%%al");
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tmovzbl\t%%al, %%eax");
-            object_emit(obj, line);
-            if (strcmp(result_reg, "%rax") != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%%rax, %s", result_reg);
-                object_emit(obj, line);
-            }
+
+        case IR_NEQ:
+            translate_compare(f, MCC_NE, code, vars);
             break;
-        }
-        
-        case IR_LT: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *reg2 = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            snprintf(line, sizeof(line), "\tcmpq\t%s, %s", reg2, reg1);
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tsetl\t%%al");
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tmovzbl\t%%al, %%eax");
-            object_emit(obj, line);
-            if (strcmp(result_reg, "%rax") != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%%rax, %s", result_reg);
-                object_emit(obj, line);
-            }
+
+        case IR_LT:
+            translate_compare(f, MCC_L, code, vars);
             break;
-        }
-        
-        case IR_LE: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *reg2 = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            snprintf(line, sizeof(line), "\tcmpq\t%s, %s", reg2, reg1);
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tsetle\t%%al");
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tmovzbl\t%%al, %%eax");
-            object_emit(obj, line);
-            if (strcmp(result_reg, "%rax") != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%%rax, %s", result_reg);
-                object_emit(obj, line);
-            }
+
+        case IR_LE:
+            translate_compare(f, MCC_LE, code, vars);
             break;
-        }
-        
-        case IR_GT: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *reg2 = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            snprintf(line, sizeof(line), "\tcmpq\t%s, %s", reg2, reg1);
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tsetg\t%%al");
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tmovzbl\t%%al, %%eax");
-            object_emit(obj, line);
-            if (strcmp(result_reg, "%rax") != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%%rax, %s", result_reg);
-                object_emit(obj, line);
-            }
+
+        case IR_GT:
+            translate_compare(f, MCC_G, code, vars);
             break;
-        }
-        
-        case IR_GE: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *reg2 = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            snprintf(line, sizeof(line), "\tcmpq\t%s, %s", reg2, reg1);
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tsetge\t%%al");
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tmovzbl\t%%al, %%eax");
-            object_emit(obj, line);
-            if (strcmp(result_reg, "%rax") != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%%rax, %s", result_reg);
-                object_emit(obj, line);
-            }
+
+        case IR_GE:
+            translate_compare(f, MCC_GE, code, vars);
             break;
-        }
-        
-        case IR_AND: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *reg2 = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            snprintf(line, sizeof(line), "\tcmpq\t$0, %s", reg1);
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tsetne\t%%al");
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tcmpq\t$0, %s", reg2);
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tsetne\t%%dl");
-            object_emit(obj, line);
-            object_emit(obj, "\tandb\t%dl, %al");
-            object_emit(obj, "\tmovzbl\t%al, %eax");
-            if (strcmp(result_reg, "%rax") != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%%rax, %s", result_reg);
-                object_emit(obj, line);
+
+        case IR_AND:
+            // Con operandos bool (0 o 1) alcanza con un andq, sin normalizar
+            if (is_bool_operand(code->arg1) && is_bool_operand(code->arg2)) {
+                translate_arith(f, MIR_AND, 1, code, vars);
+            } else {
+                translate_logical(f, MIR_AND, code, vars);
             }
             break;
-        }
-        
-        case IR_OR: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *reg2 = get_register_for_temp(code->arg2->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            snprintf(line, sizeof(line), "\tcmpq\t$0, %s", reg1);
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tsetne\t%%al");
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tcmpq\t$0, %s", reg2);
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tsetne\t%%dl");
-            object_emit(obj, line);
-            object_emit(obj, "\torb\t%dl, %al");
-            object_emit(obj, "\tmovzbl\t%al, %eax");
-            if (strcmp(result_reg, "%rax") != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%%rax, %s", result_reg);
-                object_emit(obj, line);
+
+        case IR_OR:
+            if (is_bool_operand(code->arg1) && is_bool_operand(code->arg2)) {
+                translate_arith(f, MIR_OR, 1, code, vars);
+            } else {
+                translate_logical(f, MIR_OR, code, vars);
             }
             break;
-        }
-        
+
         case IR_NOT: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            snprintf(line, sizeof(line), "\tcmpq\t$0, %s", reg1);
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tsete\t%%al");
-            object_emit(obj, line);
-            snprintf(line, sizeof(line), "\tmovzbl\t%%al, %%eax");
-            object_emit(obj, line);
-            if (strcmp(result_reg, "%rax") != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%%rax, %s", result_reg);
-                object_emit(obj, line);
+            if (is_bool_operand(code->arg1)) {
+                // !b == b xor 1
+                MOperand op1 = operand_ref(code->arg1->name, vars);
+                MOperand result = temp_operand(code->result->name, vars);
+                MOperand dst = result_register(result);
+                emit_move(f, op1, dst);
+                mir_emit(f, MIR_XOR, mir_imm(1), dst);
+                store_result(f, dst, result);
+                break;
             }
+
+            MOperand op1 = test_operand(f, code->arg1->name, vars);
+            MOperand result = temp_operand(code->result->name, vars);
+            mir_emit(f, MIR_CMP, mir_imm(0), op1);
+            mir_emit_setcc(f, MCC_E, mir_reg(MREG_RAX, 1));
+            emit_bool_result(f, result);
             break;
         }
-        
+
         case IR_UMINUS: {
-            const char *reg1 = get_register_for_temp(code->arg1->name);
-            const char *result_reg = get_register_for_temp(code->result->name);
-            
-            if (strcmp(reg1, result_reg) != 0) {
-                snprintf(line, sizeof(line), "\tmovq\t%s, %s", reg1, result_reg);
-                object_emit(obj, line);
-            }
-            snprintf(line, sizeof(line), "\tnegq\t%s", result_reg);
-            object_emit(obj, line);
+            MOperand op1 = operand_ref(code->arg1->name, vars);
+            MOperand result = temp_operand(code->result->name, vars);
+            MOperand dst = result_register(result);
+            emit_move(f, op1, dst);
+            mir_emit(f, MIR_NEG, mir_none(), dst);
+            store_result(f, dst, result);
             break;
         }
-        
+
         case IR_IF_TRUE: {
-            const char *cond_reg = get_register_for_temp(code->arg1->name);
-            snprintf(line, sizeof(line), "\tcmpq\t$0, %s", cond_reg);
-            object_emit(obj, line);
-            #if PLATFORM_MACOS
-            snprintf(line, sizeof(line), "\tjne\tL%s", code->result->name + 1);
-            #else
-            snprintf(line, sizeof(line), "\tjne\t%s", code->result->name);
-            #endif
-            object_emit(obj, line);
+            MOperand cond = test_operand(f, code->arg1->name, vars);
+            mir_emit(f, MIR_CMP, mir_imm(0), cond);
+            mir_emit_jcc(f, MCC_NE, mir_label(f, code->result->name));
             break;
         }
-        
-        case IR_CALL: {
-            const char *func_name = code->arg1->name;
-            #if PLATFORM_MACOS
-            snprintf(line, sizeof(line), "\tcall\t%s%s", SYM_PREFIX, func_name);
-            #else
-            snprintf(line, sizeof(line), "\tcall\t%s", func_name);
-            #endif
-            object_emit(obj, line);
 
+        case IR_CALL:
+            mir_emit(f, MIR_CALL, mir_symbol(f, code->arg1->name), mir_none());
             if (code->result) {
-                const char *result_reg = get_register_for_temp(code->result->name);
-                if (strcmp(result_reg, "%rax") != 0) {
-                    snprintf(line, sizeof(line), "\tmovq\t%%rax, %s", result_reg);
-                    object_emit(obj, line);
-                }
+                emit_move(f, mir_reg(MREG_RAX, 8), temp_operand(code->result->name, vars));
             }
             break;
-        }
-        
-        case IR_CALL_PARAM: {
-            const char *param_name = code->arg1->name;
-            if (is_constant(param_name)) {
-                snprintf(line, sizeof(line), "\tmovq\t$%s, %%rdi", param_name);
-            } else if (is_temp_var(param_name)) {
-                const char *param_reg = get_register_for_temp(param_name);
-                if (strcmp(param_reg, "%rdi") != 0) {
-                    snprintf(line, sizeof(line), "\tmovq\t%s, %%rdi", param_reg);
-                } else {
-                    break;
-                }
-            } else {
-                int offset = var_table_get_offset(vars, param_name);
-                if (offset != 0) {
-                    snprintf(line, sizeof(line), "\tmovq\t%d(%%rbp), %%rdi", offset);
-                } else {
-                    snprintf(line, sizeof(line), "\tmovq\t%s, %%rdi", param_name);
-                }
-            }
-            object_emit(obj, line);
+
+        case IR_IF_EQ:
+            translate_branch(f, MCC_E, code, vars);
+            break;
+
+        case IR_IF_NEQ:
+            translate_branch(f, MCC_NE, code, vars);
+            break;
+
+        case IR_IF_LT:
+            translate_branch(f, MCC_L, code, vars);
+            break;
+
+        case IR_IF_LE:
+            translate_branch(f, MCC_LE, code, vars);
+            break;
+
+        case IR_IF_GT:
+            translate_branch(f, MCC_G, code, vars);
+            break;
+
+        case IR_IF_GE:
+            translate_branch(f, MCC_GE, code, vars);
+            break;
+
+        case IR_CALL_PARAM:
+            emit_move(f, operand_ref(code->arg1->name, vars), mir_reg(MREG_RDI, 8));
+            break;
+
+        case IR_MEMO_DIRECT:
+        case IR_MEMO_HASH:
+            translate_memo_table(module, f, code);
+            break;
+
+        case IR_MEMO_LOOKUP: {
+            // Hay valor si la entrada está ocupada y guarda esta misma clave
+            MOperand r10 = mir_reg(MREG_R10, 8);
+            emit_memo_entry(f, code->arg1, vars);
+            emit_move(f, operand_ref(code->arg1->name, vars), r10);
+            mir_emit(f, MIR_CMP, r10, mir_mem(MREG_R11, 16));
+            mir_emit_setcc(f, MCC_E, mir_reg(MREG_R10, 1));
+            mir_emit(f, MIR_MOVZB, mir_reg(MREG_R10, 1), mir_reg(MREG_R10, 4));
+            mir_emit(f, MIR_AND, mir_mem(MREG_R11, 8), r10);
+            emit_move(f, r10, temp_operand(code->result->name, vars));
             break;
         }
-        
-        case IR_PARAM: {
-            const char *param_name = code->arg1->name;
-            snprintf(line, sizeof(line), "\t# Parameter: %s", param_name);
-            object_emit(obj, line);
+
+        case IR_MEMO_GET:
+            emit_memo_entry(f, code->arg1, vars);
+            emit_move(f, mir_mem(MREG_R11, 0), temp_operand(code->result->name, vars));
+            break;
+
+        case IR_MEMO_STORE: {
+            MOperand r10 = mir_reg(MREG_R10, 8);
+            emit_memo_entry(f, code->arg1, vars);
+            emit_move(f, operand_ref(code->arg2->name, vars), r10);
+            mir_emit(f, MIR_MOV, r10, mir_mem(MREG_R11, 0));
+            emit_move(f, operand_ref(code->arg1->name, vars), r10);
+            mir_emit(f, MIR_MOV, r10, mir_mem(MREG_R11, 16));
+            mir_emit(f, MIR_MOV, mir_imm(1), mir_mem(MREG_R11, 8));
             break;
         }
-        
+
+        case IR_PARAM:
+            snprintf(comment, sizeof(comment), "Parameter: %s", code->arg1->name);
+            mir_emit_comment(f, comment);
+            // Las llamadas pasan su argumento en %rdi: el primer parámetro, que es la
+            // primera variable del frame, lo guarda en su lugar
+            if (vars->count == 0) {
+                emit_move(f, mir_reg(MREG_RDI, 8), operand_ref(code->arg1->name, vars));
+            }
+            break;
+
         default:
-            snprintf(line, sizeof(line), "\t# Instrucción no implementada: %d", code->op);
-            object_emit(obj, line);
+            snprintf(comment, sizeof(comment), "Instrucción no implementada: %d", code->op);
+            mir_emit_comment(f, comment);
             break;
     }
 }
 
 /*
- * Hace todo el proceso de traducción; abre el archivo .ir, inicializa las estructuras,
- * agrega .text al inicio del output, lee el archivo .ir linea por linea, parsea los
- * argumentos y crea una estructura IRCode, usa translate_ir_instruction() para traducir,
- * por último emite .section .note.GNU-stack y guarda el archivo resultante como output.s
+ * Registros que pisa la traducción de una instrucción además de su resultado
+ * (bit 1 << MReg). Ningún temporal vivo a través de la instrucción puede ocupar
+ * uno de ellos; %r10 y %r11 no cuentan porque nunca se asignan a temporales.
+ */
+unsigned translate_clobbers(IRCode *code) {
+    switch (code->op) {
+        case IR_EQ:
+        case IR_NEQ:
+        case IR_LT:
+        case IR_LE:
+        case IR_GT:
+        case IR_GE:
+            return 1u << MREG_RAX;
+
+        case IR_AND:
+        case IR_OR:
+            if (is_bool_operand(code->arg1) && is_bool_operand(code->arg2)) return 0;
+            return (1u << MREG_RAX) | (1u << MREG_RDX);
+
+        case IR_NOT:
+            return is_bool_operand(code->arg1) ? 0 : 1u << MREG_RAX;
+
+        case IR_CALL:
+            // Registros caller-saved de la System V ABI
+            return (1u << MREG_RAX) | (1u << MREG_RCX) | (1u << MREG_RDX) |
+                   (1u << MREG_RSI) | (1u << MREG_RDI) | (1u << MREG_R8) |
+                   (1u << MREG_R9) | (1u << MREG_R10) | (1u << MREG_R11);
+
+        case IR_CALL_PARAM:
+            return 1u << MREG_RDI;
+
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Copia un símbolo leído del archivo .ir. Salvo etiquetas y funciones, el tipo
+ * se deduce del nombre, que es lo que distingue temporales, constantes y
+ * variables en el texto.
+ */
+static IRSymbol *copy_ir_symbol(IRSymbol *sym) {
+    if (!sym) return NULL;
+
+    IRSymbol *copy = malloc(sizeof(IRSymbol));
+    if (!copy) {
+        fprintf(stderr, "Error: no se pudo asignar memoria para IRSymbol\n");
+        exit(1);
+    }
+    *copy = *sym;
+    copy->name = strdup(sym->name);
+    if (copy->type != IR_SYM_LABEL && copy->type != IR_SYM_FUNC) {
+        if (is_temp_var(sym->name)) {
+            copy->type = IR_SYM_TEMP;
+        } else if (is_constant(sym->name)) {
+            copy->type = IR_SYM_CONST;
+            copy->value.int_val = atoi(sym->name);
+        } else {
+            copy->type = IR_SYM_VAR;
+        }
+    }
+    return copy;
+}
+
+static void free_ir_symbol_copy(IRSymbol *sym) {
+    if (sym) {
+        free(sym->name);
+        free(sym);
+    }
+}
+
+/*
+ * Agrega al programa una instrucción parseada, con copias propias de sus símbolos.
+ */
+static void keep_ir_code(IRList *program, IRCode *code) {
+    ir_emit(program, code->op, copy_ir_symbol(code->arg1), copy_ir_symbol(code->arg2),
+            copy_ir_symbol(code->result));
+}
+
+/*
+ * Salto fusionado que corresponde al sufijo de su nombre (LT → IR_IF_LT).
+ */
+static IRInstr compare_branch_from_suffix(const char *cc) {
+    if (strcmp(cc, "EQ") == 0) return IR_IF_EQ;
+    if (strcmp(cc, "NEQ") == 0) return IR_IF_NEQ;
+    if (strcmp(cc, "LT") == 0) return IR_IF_LT;
+    if (strcmp(cc, "LE") == 0) return IR_IF_LE;
+    if (strcmp(cc, "GT") == 0) return IR_IF_GT;
+    return IR_IF_GE;
+}
+
+/*
+ * Detecta una línea IF_EQ/IF_NEQ/IF_LT/IF_LE/IF_GT/IF_GE del archivo .ir.
+ */
+static int is_compare_branch_line(const char *line) {
+    static const char *prefixes[] = {"IF_EQ ", "IF_NEQ ", "IF_LT ", "IF_LE ", "IF_GT ", "IF_GE "};
+    for (size_t i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); i++) {
+        if (strncmp(line, prefixes[i], strlen(prefixes[i])) == 0) return 1;
+    }
+    return 0;
+}
+
+/*
+ * El archivo .ir no lleva tipos: los operandos de AND, OR y NOT se toman como bool
+ * porque el análisis semántico sólo admite bools en esas operaciones.
+ *
+ * Hace todo el proceso de traducción; abre el archivo .ir, lo lee linea por linea,
+ * parsea los argumentos y arma la lista de instrucciones IRCode. Después, por cada
+ * función, asigna registros a sus temporales y usa translate_ir_instruction() para
+ * traducir cada instrucción a MIR. Por último imprime el módulo completo (con .text
+ * y .section .note.GNU-stack) en el archivo resultante output.s
  */
 int generate_object_code(const char *ir_filename, const char *output_filename) {
     FILE *ir_file = fopen(ir_filename, "r");
@@ -657,15 +796,9 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         return 1;
     }
     
-    ObjectCode obj;
-    VarTable vars;
-    object_init(&obj);
-    var_table_init(&vars);
-    object_emit(&obj, ".text");
-    
+    IRList program;
+    ir_init(&program);
     char line[512];
-    char current_function[256] = "";
-    int in_function = 0;
     
     while (fgets(line, sizeof(line), ir_file)) {
         line[strcspn(line, "\n\r")] = 0;
@@ -677,9 +810,9 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
             if (sscanf(line, "METHOD %s", func_name) == 1) {
                 char *colon = strchr(func_name, ':');
                 if (colon) *colon = '\0';
-                strcpy(current_function, func_name);
-                translate_prologue(&obj, func_name, &vars);
-                in_function = 1;
+                IRSymbol func_sym = {func_name, IR_SYM_FUNC, {0}, TYPE_FUNCTION};
+                IRCode code = {IR_METHOD, NULL, NULL, &func_sym};
+                keep_ir_code(&program, &code);
             }
         }
         else if (strncmp(line, "EXTERN ", 7) == 0) {
@@ -688,18 +821,10 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "LOAD ", 5) == 0) {
             char src[256], dst[256];
             if (sscanf(line, "LOAD %[^,], %s", src, dst) == 2) {
-                IRSymbol src_sym = {strdup(src), IR_SYM_VAR, {0}};
-                IRSymbol dst_sym = {strdup(dst), IR_SYM_TEMP, {0}};
+                IRSymbol src_sym = {strdup(src), IR_SYM_VAR, {0}, TYPE_INTEGER};
+                IRSymbol dst_sym = {strdup(dst), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_LOAD, &src_sym, NULL, &dst_sym};
-                
-                if (!is_temp_var(src) && !is_constant(src)) {
-                    var_table_add(&vars, src);
-                }
-                if (!is_temp_var(dst)) {
-                    var_table_add(&vars, dst);
-                }
-                
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(src_sym.name);
                 free(dst_sym.name);
@@ -708,18 +833,10 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "STORE ", 6) == 0) {
             char src[256], dst[256];
             if (sscanf(line, "STORE %[^,], %s", src, dst) == 2) {
-                IRSymbol src_sym = {strdup(src), IR_SYM_TEMP, {0}};
-                IRSymbol dst_sym = {strdup(dst), IR_SYM_VAR, {0}};
+                IRSymbol src_sym = {strdup(src), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol dst_sym = {strdup(dst), IR_SYM_VAR, {0}, TYPE_INTEGER};
                 IRCode code = {IR_STORE, &src_sym, NULL, &dst_sym};
-                
-                if (!is_temp_var(src)) {
-                    var_table_add(&vars, src);
-                }
-                if (!is_temp_var(dst)) {
-                    var_table_add(&vars, dst);
-                }
-                
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(src_sym.name);
                 free(dst_sym.name);
@@ -728,11 +845,11 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "ADD ", 4) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "ADD %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_ADD, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
@@ -742,11 +859,11 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "SUB ", 4) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "SUB %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_SUB, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
@@ -756,11 +873,11 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "MUL ", 4) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "MUL %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_MUL, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
@@ -770,11 +887,11 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "DIV ", 4) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "DIV %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_DIV, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
@@ -784,11 +901,11 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "MOD ", 4) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "MOD %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_MOD, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
@@ -798,11 +915,11 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "AND ", 4) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "AND %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_BOOL};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_BOOL};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_AND, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
@@ -812,11 +929,11 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "OR ", 3) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "OR %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_BOOL};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_BOOL};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_OR, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
@@ -826,10 +943,10 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "NOT ", 4) == 0) {
             char arg1[256], result[256];
             if (sscanf(line, "NOT %[^,], %s", arg1, result) == 2) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_BOOL};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_NOT, &arg1_sym, NULL, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(result_sym.name);
@@ -838,10 +955,10 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "UMINUS ", 7) == 0) {
             char arg1[256], result[256];
             if (sscanf(line, "UMINUS %[^,], %s", arg1, result) == 2) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_UMINUS, &arg1_sym, NULL, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(result_sym.name);
@@ -850,11 +967,11 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "EQ ", 3) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "EQ %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_EQ, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
@@ -864,11 +981,11 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "LE ", 3) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "LE %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_LE, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
@@ -878,11 +995,11 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "NEQ ", 4) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "NEQ %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_NEQ, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
@@ -892,11 +1009,11 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "LT ", 3) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "LT %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_LT, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
@@ -906,11 +1023,11 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "GT ", 3) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "GT %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_GT, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
@@ -920,24 +1037,38 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "GE ", 3) == 0) {
             char arg1[256], arg2[256], result[256];
             if (sscanf(line, "GE %[^,], %[^,], %s", arg1, arg2, result) == 3) {
-                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}};
-                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_GE, &arg1_sym, &arg2_sym, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(arg1_sym.name);
                 free(arg2_sym.name);
                 free(result_sym.name);
             }
         }
+        else if (strncmp(line, "IF_", 3) == 0 && is_compare_branch_line(line)) {
+            char cc[16], arg1[256], arg2[256], label[256];
+            if (sscanf(line, "IF_%15[A-Z] %[^,], %[^,], %s", cc, arg1, arg2, label) == 4) {
+                IRSymbol arg1_sym = {strdup(arg1), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol arg2_sym = {strdup(arg2), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol label_sym = {strdup(label), IR_SYM_LABEL, {0}, TYPE_VOID};
+                IRCode code = {compare_branch_from_suffix(cc), &arg1_sym, &arg2_sym, &label_sym};
+                keep_ir_code(&program, &code);
+                
+                free(arg1_sym.name);
+                free(arg2_sym.name);
+                free(label_sym.name);
+            }
+        }
         else if (strncmp(line, "IF_FALSE ", 9) == 0) {
             char cond[256], label[256];
             if (sscanf(line, "IF_FALSE %[^,], %s", cond, label) == 2) {
-                IRSymbol cond_sym = {strdup(cond), IR_SYM_TEMP, {0}};
-                IRSymbol label_sym = {strdup(label), IR_SYM_LABEL, {0}};
+                IRSymbol cond_sym = {strdup(cond), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol label_sym = {strdup(label), IR_SYM_LABEL, {0}, TYPE_VOID};
                 IRCode code = {IR_IF_FALSE, &cond_sym, NULL, &label_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(cond_sym.name);
                 free(label_sym.name);
@@ -946,10 +1077,10 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "IF_TRUE ", 8) == 0) {
             char cond[256], label[256];
             if (sscanf(line, "IF_TRUE %[^,], %s", cond, label) == 2) {
-                IRSymbol cond_sym = {strdup(cond), IR_SYM_TEMP, {0}};
-                IRSymbol label_sym = {strdup(label), IR_SYM_LABEL, {0}};
+                IRSymbol cond_sym = {strdup(cond), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol label_sym = {strdup(label), IR_SYM_LABEL, {0}, TYPE_VOID};
                 IRCode code = {IR_IF_TRUE, &cond_sym, NULL, &label_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(cond_sym.name);
                 free(label_sym.name);
@@ -958,9 +1089,9 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "GOTO ", 5) == 0) {
             char label[256];
             if (sscanf(line, "GOTO %s", label) == 1) {
-                IRSymbol label_sym = {strdup(label), IR_SYM_LABEL, {0}};
+                IRSymbol label_sym = {strdup(label), IR_SYM_LABEL, {0}, TYPE_VOID};
                 IRCode code = {IR_GOTO, NULL, NULL, &label_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(label_sym.name);
             }
@@ -970,40 +1101,40 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
             if (sscanf(line, "LABEL %s", label) == 1) {
                 char *colon = strchr(label, ':');
                 if (colon) *colon = '\0';
-                IRSymbol label_sym = {strdup(label), IR_SYM_LABEL, {0}};
+                IRSymbol label_sym = {strdup(label), IR_SYM_LABEL, {0}, TYPE_VOID};
                 IRCode code = {IR_LABEL, NULL, NULL, &label_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 
                 free(label_sym.name);
             }
         }
-        else if (strncmp(line, "RETURN ", 7) == 0) {
+        else if (strncmp(line, "RETURN", 6) == 0) {
             char value[256];
             if (sscanf(line, "RETURN %s", value) == 1) {
-                IRSymbol value_sym = {strdup(value), IR_SYM_TEMP, {0}};
+                IRSymbol value_sym = {strdup(value), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_RETURN, &value_sym, NULL, NULL};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 free(value_sym.name);
             } else {
                 IRCode code = {IR_RETURN, NULL, NULL, NULL};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
             }
         }
         else if (strncmp(line, "CALL ", 5) == 0) {
             char func[256], result[256];
             if (sscanf(line, "CALL %[^,], %s", func, result) == 2) {
-                IRSymbol func_sym = {strdup(func), IR_SYM_FUNC, {0}};
-                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}};
+                IRSymbol func_sym = {strdup(func), IR_SYM_FUNC, {0}, TYPE_FUNCTION};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_CALL, &func_sym, NULL, &result_sym};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 free(func_sym.name);
                 free(result_sym.name);
             } else {
                 char func[256];
                 if (sscanf(line, "CALL %s", func) == 1) {
-                    IRSymbol func_sym = {strdup(func), IR_SYM_FUNC, {0}};
+                    IRSymbol func_sym = {strdup(func), IR_SYM_FUNC, {0}, TYPE_FUNCTION};
                     IRCode code = {IR_CALL, &func_sym, NULL, NULL};
-                    translate_ir_instruction(&obj, &code, &vars);
+                    keep_ir_code(&program, &code);
                     free(func_sym.name);
                 }
             }
@@ -1011,64 +1142,113 @@ int generate_object_code(const char *ir_filename, const char *output_filename) {
         else if (strncmp(line, "LOAD_PARAM ", 11) == 0) {
             char param[256];
             if (sscanf(line, "LOAD_PARAM %s", param) == 1) {
-                IRSymbol param_sym = {strdup(param), IR_SYM_TEMP, {0}};
+                IRSymbol param_sym = {strdup(param), IR_SYM_TEMP, {0}, TYPE_INTEGER};
                 IRCode code = {IR_CALL_PARAM, &param_sym, NULL, NULL};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 free(param_sym.name);
             }
         }
+        else if (strncmp(line, "MEMO_DIRECT ", 12) == 0 || strncmp(line, "MEMO_HASH ", 10) == 0) {
+            char entries[256];
+            if (sscanf(line, "MEMO_%*s %s", entries) == 1) {
+                IRSymbol entries_sym = {strdup(entries), IR_SYM_CONST, {0}, TYPE_INTEGER};
+                IRCode code = {line[5] == 'D' ? IR_MEMO_DIRECT : IR_MEMO_HASH, &entries_sym, NULL, NULL};
+                keep_ir_code(&program, &code);
+                free(entries_sym.name);
+            }
+        }
+        else if (strncmp(line, "MEMO_LOOKUP ", 12) == 0 || strncmp(line, "MEMO_GET ", 9) == 0) {
+            char key[256], result[256];
+            if (sscanf(line, "MEMO_%*s %[^,], %s", key, result) == 2) {
+                IRSymbol key_sym = {strdup(key), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol result_sym = {strdup(result), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRCode code = {line[5] == 'L' ? IR_MEMO_LOOKUP : IR_MEMO_GET, &key_sym, NULL, &result_sym};
+                keep_ir_code(&program, &code);
+                free(key_sym.name);
+                free(result_sym.name);
+            }
+        }
+        else if (strncmp(line, "MEMO_STORE ", 11) == 0) {
+            char key[256], value[256];
+            if (sscanf(line, "MEMO_STORE %[^,], %s", key, value) == 2) {
+                IRSymbol key_sym = {strdup(key), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRSymbol value_sym = {strdup(value), IR_SYM_TEMP, {0}, TYPE_INTEGER};
+                IRCode code = {IR_MEMO_STORE, &key_sym, &value_sym, NULL};
+                keep_ir_code(&program, &code);
+                free(key_sym.name);
+                free(value_sym.name);
+            }
+        }
         else if (strncmp(line, "PARAM ", 6) == 0) {
             char param[256];
             if (sscanf(line, "PARAM %s", param) == 1) {
-                IRSymbol param_sym = {strdup(param), IR_SYM_VAR, {0}};
+                IRSymbol param_sym = {strdup(param), IR_SYM_VAR, {0}, TYPE_INTEGER};
                 IRCode code = {IR_PARAM, &param_sym, NULL, NULL};
-                translate_ir_instruction(&obj, &code, &vars);
+                keep_ir_code(&program, &code);
                 free(param_sym.name);
             }
         }
     }
-    
-    if (in_function) {
-        for (int i = 0; i < obj.size; i++) {
-            if (strstr(obj.lines[i], "subq") && strstr(obj.lines[i], "$0, %rsp")) {
-                free(obj.lines[i]);
-                char new_sub[256];
-                int aligned_size = ((vars.stack_size + 15) / 16) * 16;
-                snprintf(new_sub, sizeof(new_sub), "\tsubq\t$%d, %%rsp", aligned_size);
-                obj.lines[i] = strdup(new_sub);
-                break;
-            }
+    fclose(ir_file);
+
+    // Traducción función por función: primero la asignación de registros de
+    // toda la función y después cada instrucción
+    MModule module;
+    VarTable vars;
+    mir_module_init(&module);
+    var_table_init(&vars);
+    regalloc_init(&allocation);
+
+    int in_function = 0;
+    if (program.size > 0 && program.codes[0].op != IR_METHOD) {
+        regalloc_function(&allocation, &program, 0);
+    }
+    for (int i = 0; i < program.size; i++) {
+        IRCode *code = &program.codes[i];
+        translate_ir_instruction(&module, code, &vars);
+        if (code->op == IR_METHOD) {
+            regalloc_function(&allocation, &program, i);
+            in_function = 1;
         }
-        translate_epilogue(&obj);
     }
-    
-    #if !PLATFORM_MACOS
-    /* Solo en Linux - macOS no necesita esta sección */
-    object_emit(&obj, ".section\t.note.GNU-stack,\"\",@progbits");
-    #endif
-    
-    fclose(ir_file);
-    
+
+    if (in_function) {
+        translate_epilogue(active_function(&module));
+    }
+    close_frame(&module, &vars);
+
+    if (debug_mode) {
+        printf("✓ Asignación de registros: %d temporales, %d en el stack, %d registros callee-saved guardados\n",
+               allocation.num_temps, allocation.num_spilled, allocation.num_callee_saved);
+        printf("✓ Código de máquina: %d instrucciones, %d mov\n",
+               mir_instr_count(&module), mir_opcode_count(&module, MIR_MOV));
+    }
+
+    for (int i = 0; i < program.size; i++) {
+        free_ir_symbol_copy(program.codes[i].arg1);
+        free_ir_symbol_copy(program.codes[i].arg2);
+        free_ir_symbol_copy(program.codes[i].result);
+    }
+    ir_free(&program);
+    regalloc_free(&allocation);
+
     FILE *output = fopen(output_filename, "w");
     if (!output) {
         fprintf(stderr, "Error: no se pudo crear %s\n", output_filename);
-        object_free(&obj);
+        mir_module_free(&module);
         var_table_free(&vars);
         return 1;
     }
-    
-    for (int i = 0; i < obj.size; i++) {
-        fprintf(output, "%s\n", obj.lines[i]);
-    }
-    
+
+    mir_print_module(&module, output);
     fclose(output);
-    
+
     if (debug_mode) {
         printf("Código objeto guardado en: %s\n", output_filename);
     }
-    
-    object_free(&obj);
+
+    mir_module_free(&module);
     var_table_free(&vars);
-    
+
     return 0;
 }
\ No newline at end of file
@@ -1,8 +1,24 @@
 #include "optimizer.h"
+#include "dataflow.h"
+#include "loops.h"
+#include "scev.h"
+#include "unroll.h"
+#include "inline.h"
+#include "tailrec.h"
+#include "memo.h"
+#include "specialize.h"
+#include "ipcp.h"
+#include "peval.h"
+#include "callgraph.h"
+#include "deadfunc.h"
+#include "cfgsimplify.h"
+#include "copyprop.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <limits.h>
+#include <time.h>
 
 /*
  * Verifica si un número es una potencia de 2.
@@ -68,6 +84,40 @@ void mark_instruction_as_nop(IRList *list, int index) {
     list->codes[index].result = NULL;
 }
 
+/*
+ * Evalúa una operación binaria sobre constantes. Devuelve false si no puede hacerse
+ * en tiempo de compilación: división por cero o un resultado que no entra en un int.
+ * En ejecución la aritmética es de 64 bits, así que un desborde no puede plegarse.
+ */
+static bool fold_binary(IRInstr op, int val1, int val2, int *result) {
+    long long a = val1, b = val2, r;
+    switch (op) {
+        case IR_ADD: r = a + b; break;
+        case IR_SUB: r = a - b; break;
+        case IR_MUL: r = a * b; break;
+        case IR_DIV:
+            if (b == 0) return false;
+            r = a / b;
+            break;
+        case IR_MOD:
+            if (b == 0) return false;
+            r = a % b;
+            break;
+        case IR_LT: r = a < b; break;
+        case IR_LE: r = a <= b; break;
+        case IR_GT: r = a > b; break;
+        case IR_GE: r = a >= b; break;
+        case IR_EQ: r = a == b; break;
+        case IR_NEQ: r = a != b; break;
+        case IR_AND: r = a && b; break;
+        case IR_OR: r = a || b; break;
+        default: return false;
+    }
+    if (r < INT_MIN || r > INT_MAX) return false;
+    *result = (int)r;
+    return true;
+}
+
 /*
  * Constant folding para IR: evaluar operaciones con constantes en tiempo de compilación
  * Ejemplo: 2 + 3 → 5
@@ -85,61 +135,21 @@ void optimize_constant_folding(IRList *list) {
             int val1 = get_constant_value(code->arg1);
             int val2 = get_constant_value(code->arg2);
             int result_value = 0;
-            bool can_fold = true;
             
-            switch (code->op) {
-                case IR_ADD:
-                    result_value = val1 + val2;
-                    break;
-                case IR_SUB:
-                    result_value = val1 - val2;
-                    break;
-                case IR_MUL:
-                    result_value = val1 * val2;
-                    break;
-                case IR_DIV:
-                    if (val2 != 0) {
-                        result_value = val1 / val2;
-                    } else {
-                        can_fold = false;
-                    }
-                    break;
-                case IR_MOD:
-                    if (val2 != 0) {
-                        result_value = val1 % val2;
-                    } else {
-                        can_fold = false;
-                    }
-                    break;
-                case IR_LT:
-                    result_value = val1 < val2 ? 1 : 0;
-                    break;
-                case IR_LE:
-                    result_value = val1 <= val2 ? 1 : 0;
-                    break;
-                case IR_GT:
-                    result_value = val1 > val2 ? 1 : 0;
-                    break;
-                case IR_GE:
-                    result_value = val1 >= val2 ? 1 : 0;
-                    break;
-                case IR_EQ:
-                    result_value = val1 == val2 ? 1 : 0;
-                    break;
-                case IR_NEQ:
-                    result_value = val1 != val2 ? 1 : 0;
-                    break;
-                case IR_AND:
-                    result_value = (val1 && val2) ? 1 : 0;
-                    break;
-                case IR_OR:
-                    result_value = (val1 || val2) ? 1 : 0;
-                    break;
-                default:
-                    can_fold = false;
-            }
+            // Un salto fusionado se evalúa como su comparación
+            bool can_fold = fold_binary(ir_compare_for_branch(code->op), val1, val2, &result_value);
             
-            if (can_fold) {
+            if (can_fold && ir_is_compare_branch(code->op)) {
+                // Salto que siempre se toma → GOTO; que nunca se toma → se elimina
+                printf("  [FOLDING] Línea %d: salto con %d op %d → %s\n", i, val1, val2,
+                       result_value ? "siempre" : "nunca");
+                if (result_value) {
+                    replace_instruction(list, i, IR_GOTO, NULL, NULL, code->result);
+                } else {
+                    mark_instruction_as_nop(list, i);
+                }
+                optimizations++;
+            } else if (can_fold) {
                 IRSymbol *const_result = new_const_symbol(result_value, 0);
                 replace_instruction(list, i, IR_LOAD, const_result, NULL, code->result);
                 printf("  [FOLDING] Línea %d: %d op %d → %d\n", i, val1, val2, result_value);
@@ -154,157 +164,1098 @@ void optimize_constant_folding(IRList *list) {
 }
 
 /*
- * Propagación de constantes en IR
- * Si t1 = 5 y luego usamos t1, reemplazar por 5 directamente
+ * Propagación de constantes condicional dispersa (SCCP) de Wegman y Zadeck.
+ *
+ * Cada valor del grafo SSA (instrucciones y phi) tiene un valor en la red TOP (todavía
+ * sin valor) > constante > BOTTOM (no constante). Como las phi incluyen a las variables
+ * locales, las constantes atraviesan STORE/LOAD y los bordes entre bloques. Sólo se
+ * evalúan los bloques alcanzados por aristas ejecutables, que se descubren desde la
+ * entrada siguiendo únicamente los saltos que pueden tomarse, y cada phi sólo combina
+ * los argumentos que llegan por esas aristas.
+ *
+ * Cada valor baja a lo sumo dos veces y cada bajada reencola sólo sus usuarios; cada
+ * arista se vuelve ejecutable una vez. El costo es lineal en el tamaño del grafo SSA.
  */
-void optimize_constant_propagation(IRList *list) {
-    int optimizations = 0;
-    
-    // Tabla para rastrear qué temporales tienen valores constantes
-    #define MAX_TEMPS 256
-    int temp_values[MAX_TEMPS];
-    bool temp_is_const[MAX_TEMPS];
-    
-    for (int i = 0; i < MAX_TEMPS; i++) {
-        temp_is_const[i] = false;
+typedef enum {
+    LATTICE_TOP,
+    LATTICE_CONST,
+    LATTICE_BOTTOM
+} LatticeKind;
+
+typedef struct {
+    LatticeKind kind;
+    int value;
+} LatticeValue;
+
+typedef struct {
+    CFG *cfg;
+    SSAGraph *ssa;
+    LatticeValue *values;   // Valor de cada instrucción y de cada phi
+    bool *block_exec;
+    bool *edge_exec;        // Arista j-ésima de entrada a cada bloque (offset en edge_start)
+    int *edge_start;
+    int *flow_worklist;     // Aristas (bloque destino, índice de predecesor) por visitar
+    int flow_top;
+    int *ssa_worklist;      // Valores que bajaron
+    int ssa_top;
+} SCCPState;
+
+static LatticeValue lattice_meet(LatticeValue a, LatticeValue b) {
+    if (a.kind == LATTICE_TOP) return b;
+    if (b.kind == LATTICE_TOP) return a;
+    if (a.kind == LATTICE_CONST && b.kind == LATTICE_CONST && a.value == b.value) return a;
+    LatticeValue bottom = {LATTICE_BOTTOM, 0};
+    return bottom;
+}
+
+/*
+ * Valor de la red de un valor SSA; la entrada y las llamadas aportan BOTTOM.
+ */
+static LatticeValue sccp_value(SCCPState *s, int value) {
+    LatticeValue bottom = {LATTICE_BOTTOM, 0};
+    return value < 0 ? bottom : s->values[value];
+}
+
+/*
+ * Valor de un operando: las constantes valen lo que dicen; los temporales y las
+ * variables, lo que valga el valor SSA que leen.
+ */
+static LatticeValue sccp_operand(SCCPState *s, int rel, int slot, IRSymbol *arg) {
+    LatticeValue result = {LATTICE_BOTTOM, 0};
+    if (s->cfg->use_of[2 * rel + slot] >= 0) {
+        return sccp_value(s, s->ssa->use_value[2 * rel + slot]);
     }
-    
-    for (int i = 0; i < list->size; i++) {
-        IRCode *code = &list->codes[i];
-        
-        // Detectar asignaciones de constantes: t1 = 5
-        if (code->op == IR_LOAD && is_constant_symbol(code->arg1)) {
-            if (code->result && code->result->name && code->result->name[0] == 't') {
-                int temp_num = atoi(code->result->name + 1);
-                if (temp_num >= 0 && temp_num < MAX_TEMPS) {
-                    temp_values[temp_num] = get_constant_value(code->arg1);
-                    temp_is_const[temp_num] = true;
+    if (is_constant_symbol(arg)) {
+        result.kind = LATTICE_CONST;
+        result.value = get_constant_value(arg);
+    }
+    return result;
+}
+
+/*
+ * Valor que define la instrucción según los valores actuales de sus operandos.
+ */
+static LatticeValue sccp_evaluate(SCCPState *s, int rel) {
+    IRCode *code = &s->cfg->list->codes[s->cfg->start + rel];
+    LatticeValue bottom = {LATTICE_BOTTOM, 0};
+
+    switch (code->op) {
+        case IR_LOAD:
+        case IR_STORE:
+            return code->arg1 ? sccp_operand(s, rel, 0, code->arg1) : bottom;
+
+        case IR_UMINUS:
+        case IR_NOT: {
+            LatticeValue a = sccp_operand(s, rel, 0, code->arg1);
+            if (a.kind == LATTICE_CONST) {
+                if (code->op == IR_UMINUS && a.value == INT_MIN) return bottom;
+                a.value = code->op == IR_NOT ? !a.value : -a.value;
+            }
+            return a;
+        }
+
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_MOD:
+        case IR_AND:
+        case IR_OR:
+        case IR_EQ:
+        case IR_NEQ:
+        case IR_LT:
+        case IR_LE:
+        case IR_GT:
+        case IR_GE: {
+            LatticeValue a = sccp_operand(s, rel, 0, code->arg1);
+            LatticeValue b = sccp_operand(s, rel, 1, code->arg2);
+            LatticeValue result = {LATTICE_CONST, 0};
+
+            // Un operando constante puede decidir el resultado aunque el otro no lo sea
+            if ((code->op == IR_AND || code->op == IR_OR) &&
+                ((a.kind == LATTICE_CONST && a.value == (code->op == IR_OR)) ||
+                 (b.kind == LATTICE_CONST && b.value == (code->op == IR_OR)))) {
+                result.value = code->op == IR_OR;
+                return result;
+            }
+            if (a.kind == LATTICE_BOTTOM || b.kind == LATTICE_BOTTOM) return bottom;
+            if (a.kind == LATTICE_TOP || b.kind == LATTICE_TOP) return a.kind == LATTICE_TOP ? a : b;
+            if (!fold_binary(code->op, a.value, b.value, &result.value)) return bottom;
+            return result;
+        }
+
+        default:
+            return bottom;
+    }
+}
+
+/*
+ * Resultado de un salto condicional: -1 si todavía no se sabe, 0 si nunca se toma,
+ * 1 si siempre se toma y 2 si puede ir para cualquier lado.
+ */
+static int sccp_branch_outcome(SCCPState *s, int rel) {
+    IRCode *code = &s->cfg->list->codes[s->cfg->start + rel];
+
+    if (ir_is_compare_branch(code->op)) {
+        LatticeValue a = sccp_operand(s, rel, 0, code->arg1);
+        LatticeValue b = sccp_operand(s, rel, 1, code->arg2);
+        int taken;
+        if (a.kind == LATTICE_BOTTOM || b.kind == LATTICE_BOTTOM) return 2;
+        if (a.kind == LATTICE_TOP || b.kind == LATTICE_TOP) return -1;
+        fold_binary(ir_compare_for_branch(code->op), a.value, b.value, &taken);
+        return taken;
+    }
+
+    LatticeValue cond = sccp_operand(s, rel, 0, code->arg1);
+    if (cond.kind == LATTICE_TOP) return -1;
+    if (cond.kind == LATTICE_BOTTOM) return 2;
+    return code->op == IR_IF_TRUE ? cond.value != 0 : cond.value == 0;
+}
+
+/*
+ * Marca como ejecutable la arista from -> to y la encola para visitar su destino.
+ */
+static void sccp_mark_edge(SCCPState *s, int from, int to) {
+    if (to < 0) return;
+    int j = ssa_pred_index(s->cfg, to, from);
+    if (j < 0 || s->edge_exec[s->edge_start[to] + j]) return;
+    s->edge_exec[s->edge_start[to] + j] = true;
+    s->flow_worklist[s->flow_top++] = s->edge_start[to] + j;
+}
+
+/*
+ * Bloque al que salta la última instrucción de b (no el que le sigue), o -1.
+ */
+static int sccp_branch_target(CFG *cfg, int b) {
+    IRCode *last = &cfg->list->codes[cfg->blocks[b].end - 1];
+    for (int k = 0; k < cfg->blocks[b].num_succs; k++) {
+        IRCode *first = &cfg->list->codes[cfg->blocks[cfg->blocks[b].succs[k]].start];
+        if (first->op == IR_LABEL && first->result && last->result &&
+            strcmp(first->result->name, last->result->name) == 0) {
+            return cfg->blocks[b].succs[k];
+        }
+    }
+    return -1;
+}
+
+/*
+ * Baja el valor v a now; si cambió, encola v para revisar a sus usuarios.
+ */
+static void sccp_update(SCCPState *s, int v, LatticeValue now) {
+    LatticeValue old = s->values[v];
+    now = lattice_meet(old, now);
+    if (now.kind != old.kind) {
+        s->values[v] = now;
+        s->ssa_worklist[s->ssa_top++] = v;
+    }
+}
+
+/*
+ * Una phi combina los argumentos que llegan por aristas ejecutables.
+ */
+static void sccp_visit_phi(SCCPState *s, int k) {
+    PhiNode *phi = &s->ssa->phis[k];
+    LatticeValue result = {LATTICE_TOP, 0};
+    for (int j = 0; j < s->cfg->blocks[phi->block].num_preds; j++) {
+        if (s->edge_exec[s->edge_start[phi->block] + j]) {
+            result = lattice_meet(result, sccp_value(s, phi->args[j]));
+        }
+    }
+    sccp_update(s, s->ssa->num_instrs + k, result);
+}
+
+/*
+ * Evalúa una instrucción de un bloque ejecutable y, si es un salto condicional,
+ * encola las aristas que pueden tomarse.
+ */
+static void sccp_visit_instr(SCCPState *s, int rel) {
+    CFG *cfg = s->cfg;
+    IRCode *code = &cfg->list->codes[cfg->start + rel];
+
+    if (cfg->def_of[rel] >= 0) {
+        sccp_update(s, rel, sccp_evaluate(s, rel));
+    }
+
+    if (ir_is_cond_branch(code)) {
+        int b = cfg->block_of[rel];
+        int outcome = sccp_branch_outcome(s, rel);
+        if (outcome == 0 || outcome == 2) {
+            sccp_mark_edge(s, b, b + 1 < cfg->num_blocks ? b + 1 : -1);
+        }
+        if (outcome == 1 || outcome == 2) {
+            sccp_mark_edge(s, b, sccp_branch_target(cfg, b));
+        }
+    }
+}
+
+/*
+ * Aplica SCCP a la función que empieza en start. Devuelve la cantidad de cambios.
+ */
+static int sccp_function(IRList *list, int start, int *end) {
+    CFG cfg;
+    SSAGraph ssa;
+    cfg_build(&cfg, list, start);
+    ssa_build(&ssa, &cfg);
+    *end = cfg.end;
+
+    int n = cfg.end - cfg.start;
+    int num_values = n + ssa.num_phis;
+    SCCPState s;
+    s.cfg = &cfg;
+    s.ssa = &ssa;
+    s.values = df_alloc(num_values + 1, sizeof(LatticeValue));
+    s.block_exec = df_alloc(cfg.num_blocks + 1, sizeof(bool));
+    s.edge_start = df_alloc(cfg.num_blocks + 1, sizeof(int));
+    s.edge_start[0] = 0;
+    for (int b = 0; b < cfg.num_blocks; b++) {
+        s.edge_start[b + 1] = s.edge_start[b] + cfg.blocks[b].num_preds;
+    }
+    int num_edges = s.edge_start[cfg.num_blocks];
+    s.edge_exec = df_alloc(num_edges + 1, sizeof(bool));
+    s.flow_worklist = df_alloc(num_edges + 1, sizeof(int));
+    s.ssa_worklist = df_alloc(2 * num_values + 1, sizeof(int));
+    s.flow_top = 0;
+    s.ssa_top = 0;
+
+    // Bloque de cada arista, para resolver el destino al sacarla de la worklist
+    int *edge_block = df_alloc(num_edges + 1, sizeof(int));
+    for (int b = 0; b < cfg.num_blocks; b++) {
+        for (int e = s.edge_start[b]; e < s.edge_start[b + 1]; e++) edge_block[e] = b;
+    }
+
+    // El bloque de entrada es ejecutable sin arista que llegue a él
+    int pending_entry = cfg.num_blocks > 0 ? 0 : -1;
+    while (pending_entry >= 0 || s.flow_top > 0 || s.ssa_top > 0) {
+        int block = -1;
+        if (pending_entry >= 0) {
+            block = pending_entry;
+            pending_entry = -1;
+        } else if (s.flow_top > 0) {
+            block = edge_block[s.flow_worklist[--s.flow_top]];
+            for (int k = ssa.block_phi_start[block]; k < ssa.block_phi_start[block + 1]; k++) {
+                sccp_visit_phi(&s, k);
+            }
+            if (s.block_exec[block]) continue;
+        } else {
+            // Un valor bajó: se revisan sus usuarios en bloques ejecutables
+            int v = s.ssa_worklist[--s.ssa_top];
+            for (int k = ssa.user_start[v]; k < ssa.user_start[v + 1]; k++) {
+                int user = ssa.users[k];
+                if (user < n) {
+                    if (s.block_exec[cfg.block_of[user]]) sccp_visit_instr(&s, user);
+                } else if (s.block_exec[ssa.phis[user - n].block]) {
+                    sccp_visit_phi(&s, user - n);
                 }
             }
+            continue;
         }
-        
-        // Propagar constantes en los usos
-        if (code->arg1 && code->arg1->name && code->arg1->name[0] == 't') {
-            int temp_num = atoi(code->arg1->name + 1);
-            if (temp_num >= 0 && temp_num < MAX_TEMPS && temp_is_const[temp_num]) {
-                code->arg1 = new_const_symbol(temp_values[temp_num], 0);
-                optimizations++;
+
+        // Primera visita a un bloque: todas sus instrucciones y sus sucesores fijos
+        s.block_exec[block] = true;
+        BasicBlock *bb = &cfg.blocks[block];
+        for (int i = bb->start; i < bb->end; i++) {
+            sccp_visit_instr(&s, i - cfg.start);
+        }
+        if (!ir_is_cond_branch(&list->codes[bb->end - 1])) {
+            for (int k = 0; k < bb->num_succs; k++) {
+                sccp_mark_edge(&s, block, bb->succs[k]);
             }
         }
-        
-        if (code->arg2 && code->arg2->name && code->arg2->name[0] == 't') {
-            int temp_num = atoi(code->arg2->name + 1);
-            if (temp_num >= 0 && temp_num < MAX_TEMPS && temp_is_const[temp_num]) {
-                code->arg2 = new_const_symbol(temp_values[temp_num], 0);
-                optimizations++;
+    }
+
+    // Reescritura: usos constantes, cálculos constantes, saltos resueltos y código inalcanzable
+    int changes = 0;
+    for (int rel = 0; rel < n; rel++) {
+        int i = cfg.start + rel;
+        IRCode *code = &list->codes[i];
+
+        if (!s.block_exec[cfg.block_of[rel]]) {
+            if (!ir_is_nop(code) && !(code->op == IR_LABEL && code->result)) {
+                if (debug_mode) {
+                    printf("  [SCCP] Línea %d: instrucción inalcanzable eliminada\n", i);
+                }
+                mark_instruction_as_nop(list, i);
+                changes++;
             }
+            continue;
         }
-        
-        // Invalidar temporales que son redefinidos
-        if (code->result && code->result->name && code->result->name[0] == 't') {
-            int temp_num = atoi(code->result->name + 1);
-            if (temp_num >= 0 && temp_num < MAX_TEMPS) {
-                if (code->op != IR_LOAD || !is_constant_symbol(code->arg1)) {
-                    temp_is_const[temp_num] = false;
+
+        if (ir_is_cond_branch(code)) {
+            int outcome = sccp_branch_outcome(&s, rel);
+            if (outcome == 0 || outcome == 1) {
+                if (debug_mode) {
+                    printf("  [SCCP] Línea %d: salto que %s se toma\n", i, outcome ? "siempre" : "nunca");
+                }
+                if (outcome) {
+                    replace_instruction(list, i, IR_GOTO, NULL, NULL, code->result);
+                } else {
+                    mark_instruction_as_nop(list, i);
                 }
+                changes++;
+                continue;
+            }
+        }
+
+        IRSymbol **args[2] = {&code->arg1, &code->arg2};
+        for (int slot = 0; slot < 2; slot++) {
+            if (cfg.use_of[2 * rel + slot] < 0) continue;
+            LatticeValue v = sccp_operand(&s, rel, slot, *args[slot]);
+            if (v.kind == LATTICE_CONST) {
+                *args[slot] = new_const_symbol(v.value, (*args[slot])->data_type == TYPE_BOOL);
+                changes++;
             }
         }
+
+        if (s.values[rel].kind == LATTICE_CONST && code->op != IR_LOAD && code->op != IR_STORE &&
+            code->result && code->result->type == IR_SYM_TEMP) {
+            if (debug_mode) {
+                printf("  [SCCP] Línea %d: %s = %d\n", i, code->result->name, s.values[rel].value);
+            }
+            replace_instruction(list, i, IR_LOAD,
+                                new_const_symbol(s.values[rel].value, code->result->data_type == TYPE_BOOL),
+                                NULL, code->result);
+            changes++;
+        }
     }
-    
+
+    free(s.values);
+    free(s.block_exec);
+    free(s.edge_exec);
+    free(s.edge_start);
+    free(s.flow_worklist);
+    free(s.ssa_worklist);
+    free(edge_block);
+    ssa_free(&ssa);
+    cfg_free(&cfg);
+    return changes;
+}
+
+/*
+ * Propagación de constantes en IR con SCCP, función por función.
+ */
+void optimize_constant_propagation(IRList *list) {
+    int optimizations = 0;
+
+    for (int start = 0; start < list->size; start++) {
+        if (list->codes[start].op != IR_METHOD) continue;
+        int end;
+        optimizations += sccp_function(list, start, &end);
+        start = end - 1;
+    }
+
+    compact_ir_list(list);
+
     if (optimizations > 0 && debug_mode) {
-        printf("✓ Propagación de constantes: %d reemplazos\n", optimizations);
+        printf("✓ Propagación de constantes (SCCP): %d cambios\n", optimizations);
+    }
+}
+
+/*
+ * Numeración global de valores (GVN) sobre el grafo SSA.
+ *
+ * Cada valor SSA recibe un número de valor: dos valores con el mismo número son
+ * iguales en cualquier ejecución. Una expresión se identifica por su operación y
+ * los números de valor (o constantes) de sus operandos, así que `a * b` calculado
+ * dos veces sin que cambien a ni b tiene un único número. Un LOAD o STORE copia el
+ * número de su operando, por lo que releer una variable que no cambió da el mismo
+ * valor que el temporal que ya la tenía.
+ *
+ * La tabla de expresiones se recorre con el árbol de dominadores: al entrar a un
+ * bloque se abre un ámbito que hereda lo disponible en sus dominadores y al salir
+ * se descarta. Dentro de un bloque es una numeración local (LVN); entre bloques,
+ * sólo se reutiliza un cálculo de un bloque que domina al actual, que seguro se
+ * ejecutó antes. Una instrucción redundante se elimina y sus usos pasan a leer el
+ * temporal líder, el primero que calculó ese valor.
+ *
+ * Además, al entrar a un bloque cuyo único predecesor termina en un salto fusionado,
+ * se registra el resultado de esa comparación: la misma comparación en un if anidado
+ * queda resuelta como constante.
+ */
+typedef struct {
+    Expression key;         // Operandos: número de valor (kind 0) o constante (kind 1)
+    int vn;
+    int next;
+} GVNEntry;
+
+typedef struct {
+    CFG *cfg;
+    SSAGraph *ssa;
+    int *vn;                // Número de valor de cada valor SSA, -1 si no se calculó
+    int *entry_vn;          // Número del valor de entrada de cada símbolo
+    int num_vns;
+    int vn_capacity;
+    bool *vn_is_const;
+    IRSymbol **leader;      // Temporal líder de cada número de valor
+    int *leader_block;
+    int *leader_log;        // Números de valor con líder, en orden (para deshacer)
+    int leader_top;
+    GVNEntry *entries;      // Tabla de expresiones encadenada; las entradas se apilan
+    int num_entries;
+    int *buckets;
+    int num_buckets;
+    int *const_keys;        // Constante -> número de valor, fuera de los ámbitos
+    int *const_vns;
+    int const_capacity;
+    int *def_count;         // Definiciones de cada símbolo de la función
+} GVNState;
+
+static void gvn_grow_values(GVNState *g) {
+    int old = g->vn_capacity;
+    g->vn_capacity *= 2;
+    g->vn_is_const = realloc(g->vn_is_const, g->vn_capacity * sizeof(bool));
+    g->leader = realloc(g->leader, g->vn_capacity * sizeof(IRSymbol *));
+    g->leader_block = realloc(g->leader_block, g->vn_capacity * sizeof(int));
+    g->leader_log = realloc(g->leader_log, g->vn_capacity * sizeof(int));
+    if (!g->vn_is_const || !g->leader || !g->leader_block || !g->leader_log) {
+        fprintf(stderr, "Error: no se pudo asignar memoria para GVN\n");
+        exit(1);
+    }
+    for (int v = old; v < g->vn_capacity; v++) {
+        g->vn_is_const[v] = false;
+        g->leader[v] = NULL;
+    }
+}
+
+static int gvn_new_value(GVNState *g) {
+    if (g->num_vns >= g->vn_capacity) gvn_grow_values(g);
+    return g->num_vns++;
+}
+
+/*
+ * Número de valor de un valor SSA. La entrada de cada símbolo tiene el suyo;
+ * un global pisado por una llamada es siempre un valor nuevo.
+ */
+static int gvn_value_number(GVNState *g, int value, int sym) {
+    if (value == SSA_CLOBBER) return gvn_new_value(g);
+    if (value == SSA_ENTRY) {
+        if (g->entry_vn[sym] < 0) g->entry_vn[sym] = gvn_new_value(g);
+        return g->entry_vn[sym];
+    }
+    if (g->vn[value] < 0) g->vn[value] = gvn_new_value(g);
+    return g->vn[value];
+}
+
+/*
+ * Operando de una instrucción para la clave de una expresión.
+ */
+static void gvn_operand(GVNState *g, int rel, int slot, IRSymbol *arg, int *kind, int *val) {
+    int sym = g->cfg->use_of[2 * rel + slot];
+    if (sym >= 0) {
+        *kind = 0;
+        *val = gvn_value_number(g, g->ssa->use_value[2 * rel + slot], sym);
+    } else if (arg && is_constant_symbol(arg)) {
+        *kind = 1;
+        *val = get_constant_value(arg);
+    } else {
+        *kind = 2;
+        *val = 0;
+    }
+}
+
+static unsigned int gvn_hash(const Expression *e) {
+    unsigned int h = (unsigned int)e->op;
+    h = h * 31u + (unsigned int)e->kind1;
+    h = h * 31u + (unsigned int)e->val1;
+    h = h * 31u + (unsigned int)e->kind2;
+    h = h * 31u + (unsigned int)e->val2;
+    return h;
+}
+
+static int gvn_lookup(GVNState *g, const Expression *key) {
+    unsigned int h = gvn_hash(key) & (unsigned int)(g->num_buckets - 1);
+    for (int e = g->buckets[h]; e >= 0; e = g->entries[e].next) {
+        if (memcmp(&g->entries[e].key, key, sizeof(Expression)) == 0) return g->entries[e].vn;
     }
+    return -1;
+}
+
+static void gvn_insert(GVNState *g, const Expression *key, int vn) {
+    unsigned int h = gvn_hash(key) & (unsigned int)(g->num_buckets - 1);
+    GVNEntry *entry = &g->entries[g->num_entries];
+    entry->key = *key;
+    entry->vn = vn;
+    entry->next = g->buckets[h];
+    g->buckets[h] = g->num_entries++;
+}
+
+/*
+ * Descarta las entradas y los líderes agregados después de las marcas dadas.
+ */
+static void gvn_close_scope(GVNState *g, int entries_mark, int leaders_mark) {
+    while (g->num_entries > entries_mark) {
+        GVNEntry *entry = &g->entries[--g->num_entries];
+        unsigned int h = gvn_hash(&entry->key) & (unsigned int)(g->num_buckets - 1);
+        g->buckets[h] = entry->next;
+    }
+    while (g->leader_top > leaders_mark) {
+        g->leader[g->leader_log[--g->leader_top]] = NULL;
+    }
+}
+
+/*
+ * Número de valor de la constante c. Las constantes valen en toda la función,
+ * así que su tabla no depende del ámbito.
+ */
+static int gvn_constant(GVNState *g, int c) {
+    unsigned int h = (unsigned int)c * 2654435761u;
+    for (;; h++) {
+        int slot = (int)(h & (unsigned int)(g->const_capacity - 1));
+        if (g->const_vns[slot] < 0) {
+            g->const_keys[slot] = c;
+            g->const_vns[slot] = gvn_new_value(g);
+            g->vn_is_const[g->const_vns[slot]] = true;
+            return g->const_vns[slot];
+        }
+        if (g->const_keys[slot] == c) return g->const_vns[slot];
+    }
+}
+
+/*
+ * Comparación opuesta: !(a < b) == (a >= b).
+ */
+static IRInstr compare_negation(IRInstr op) {
+    switch (op) {
+        case IR_EQ: return IR_NEQ;
+        case IR_NEQ: return IR_EQ;
+        case IR_LT: return IR_GE;
+        case IR_LE: return IR_GT;
+        case IR_GT: return IR_LE;
+        default: return IR_LT;
+    }
+}
+
+/*
+ * Lleva una expresión a su forma canónica: GT y GE se escriben como LT y LE con
+ * los operandos invertidos, y las operaciones conmutativas ordenan sus operandos.
+ */
+static void gvn_canonicalize(Expression *key) {
+    bool swap = false;
+    switch (key->op) {
+        case IR_GT:
+            key->op = IR_LT;
+            swap = true;
+            break;
+        case IR_GE:
+            key->op = IR_LE;
+            swap = true;
+            break;
+        case IR_ADD:
+        case IR_MUL:
+        case IR_AND:
+        case IR_OR:
+        case IR_EQ:
+        case IR_NEQ:
+            swap = key->kind1 > key->kind2 || (key->kind1 == key->kind2 && key->val1 > key->val2);
+            break;
+        default:
+            break;
+    }
+    if (swap) {
+        int kind = key->kind1, val = key->val1;
+        key->kind1 = key->kind2;
+        key->val1 = key->val2;
+        key->kind2 = kind;
+        key->val2 = val;
+    }
+}
+
+/*
+ * Clave de la comparación de un salto fusionado o de una instrucción de comparación.
+ */
+static Expression gvn_compare_key(GVNState *g, int rel, IRInstr op) {
+    IRCode *code = &g->cfg->list->codes[g->cfg->start + rel];
+    Expression key;
+    key.op = op;
+    gvn_operand(g, rel, 0, code->arg1, &key.kind1, &key.val1);
+    gvn_operand(g, rel, 1, code->arg2, &key.kind2, &key.val2);
+    gvn_canonicalize(&key);
+    return key;
+}
+
+/*
+ * Al entrar a un bloque con un único predecesor que termina en un salto fusionado,
+ * el resultado de la comparación se conoce: se registra junto con su negación.
+ */
+static void gvn_record_branch_outcome(GVNState *g, int block) {
+    CFG *cfg = g->cfg;
+    BasicBlock *bb = &cfg->blocks[block];
+    if (bb->num_preds != 1) return;
+
+    int pred = bb->preds[0];
+    BasicBlock *pb = &cfg->blocks[pred];
+    IRCode *last = &cfg->list->codes[pb->end - 1];
+    if (!ir_is_compare_branch(last->op) || pb->num_succs != 2) return;
+
+    bool taken = sccp_branch_target(cfg, pred) == block;
+    IRInstr cmp = ir_compare_for_branch(last->op);
+    Expression key = gvn_compare_key(g, pb->end - 1 - cfg->start, cmp);
+    Expression negated = gvn_compare_key(g, pb->end - 1 - cfg->start, compare_negation(cmp));
+    gvn_insert(g, &key, gvn_constant(g, taken));
+    gvn_insert(g, &negated, gvn_constant(g, !taken));
+}
+
+/*
+ * Reemplaza por leader los usos del valor que define rel. Falla sin tocar nada si
+ * el valor llega a una phi, porque entonces la definición tiene que quedar.
+ */
+static bool gvn_replace_uses(GVNState *g, int rel, IRSymbol *leader) {
+    SSAGraph *ssa = g->ssa;
+    int n = ssa->num_instrs;
+    for (int k = ssa->user_start[rel]; k < ssa->user_start[rel + 1]; k++) {
+        if (ssa->users[k] >= n) return false;
+    }
+
+    int sym = g->cfg->def_of[rel];
+    for (int k = ssa->user_start[rel]; k < ssa->user_start[rel + 1]; k++) {
+        int user = ssa->users[k];
+        IRCode *code = &g->cfg->list->codes[g->cfg->start + user];
+        IRSymbol **args[2] = {&code->arg1, &code->arg2};
+        for (int slot = 0; slot < 2; slot++) {
+            if (g->cfg->use_of[2 * user + slot] == sym && ssa->use_value[2 * user + slot] == rel) {
+                *args[slot] = leader;
+            }
+        }
+    }
+    return true;
+}
+
+static bool is_value_numbered_op(IRInstr op) {
+    switch (op) {
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_MOD:
+        case IR_AND:
+        case IR_OR:
+        case IR_NOT:
+        case IR_UMINUS:
+        case IR_EQ:
+        case IR_NEQ:
+        case IR_LT:
+        case IR_LE:
+        case IR_GT:
+        case IR_GE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * Numera las instrucciones de un bloque y elimina las redundantes.
+ */
+static void gvn_visit_block(GVNState *g, int block, int counts[3]) {
+    CFG *cfg = g->cfg;
+    SSAGraph *ssa = g->ssa;
+    int n = ssa->num_instrs;
+
+    // Una phi cuyos argumentos tienen todos el mismo número no crea un valor nuevo
+    for (int k = ssa->block_phi_start[block]; k < ssa->block_phi_start[block + 1]; k++) {
+        PhiNode *phi = &ssa->phis[k];
+        int common = -1;
+        for (int j = 0; j < cfg->blocks[block].num_preds && common != -2; j++) {
+            int arg = phi->args[j];
+            int vn = arg >= 0 ? g->vn[arg] : (arg == SSA_ENTRY ? g->entry_vn[phi->sym] : -1);
+            if (vn < 0 || (common >= 0 && vn != common)) common = -2;
+            else common = vn;
+        }
+        g->vn[n + k] = common >= 0 ? common : gvn_new_value(g);
+    }
+
+    for (int i = cfg->blocks[block].start; i < cfg->blocks[block].end; i++) {
+        int rel = i - cfg->start;
+        IRCode *code = &cfg->list->codes[i];
+
+        // Salto fusionado cuyo resultado ya decidió un salto dominante
+        if (ir_is_compare_branch(code->op)) {
+            Expression key = gvn_compare_key(g, rel, ir_compare_for_branch(code->op));
+            int vn = gvn_lookup(g, &key);
+            if (vn >= 0 && g->vn_is_const[vn]) {
+                bool taken = vn == gvn_constant(g, 1);
+                if (debug_mode) {
+                    printf("  [GVN] Línea %d: comparación ya decidida, el salto %s se toma\n",
+                           i, taken ? "siempre" : "nunca");
+                }
+                if (taken) {
+                    replace_instruction(cfg->list, i, IR_GOTO, NULL, NULL, code->result);
+                } else {
+                    mark_instruction_as_nop(cfg->list, i);
+                }
+                counts[2]++;
+            }
+            continue;
+        }
+
+        int sym = cfg->def_of[rel];
+        if (sym < 0) continue;
+
+        int vn;
+        if (code->op == IR_LOAD || code->op == IR_STORE) {
+            int kind, val;
+            gvn_operand(g, rel, 0, code->arg1, &kind, &val);
+            vn = kind == 0 ? val : (kind == 1 ? gvn_constant(g, val) : gvn_new_value(g));
+        } else if (is_value_numbered_op(code->op)) {
+            Expression key;
+            key.op = code->op;
+            gvn_operand(g, rel, 0, code->arg1, &key.kind1, &key.val1);
+            gvn_operand(g, rel, 1, code->arg2, &key.kind2, &key.val2);
+            gvn_canonicalize(&key);
+            vn = gvn_lookup(g, &key);
+            if (vn < 0) {
+                vn = gvn_new_value(g);
+                gvn_insert(g, &key, vn);
+            }
+        } else {
+            vn = gvn_new_value(g);
+        }
+        g->vn[rel] = vn;
+
+        if (code->result->type != IR_SYM_TEMP || g->def_count[sym] != 1 || code->op == IR_CALL) {
+            continue;
+        }
+
+        // Comparación cuyo resultado decidió un salto dominante
+        if (g->vn_is_const[vn] && code->op >= IR_EQ && code->op <= IR_GE) {
+            int value = vn == gvn_constant(g, 1);
+            if (debug_mode) {
+                printf("  [GVN] Línea %d: %s = %d por un salto dominante\n", i, code->result->name, value);
+            }
+            replace_instruction(cfg->list, i, IR_LOAD, new_const_symbol(value, 1), NULL, code->result);
+            counts[2]++;
+            continue;
+        }
+        if (g->vn_is_const[vn]) continue;
+
+        IRSymbol *leader = g->leader[vn];
+        if (leader && gvn_replace_uses(g, rel, leader)) {
+            bool local = g->leader_block[vn] == block;
+            if (debug_mode) {
+                printf("  [GVN] Línea %d: %s redundante, se usa %s (%s)\n", i, code->result->name,
+                       leader->name, local ? "mismo bloque" : "bloque dominante");
+            }
+            mark_instruction_as_nop(cfg->list, i);
+            counts[local ? 0 : 1]++;
+        } else if (!leader) {
+            g->leader[vn] = code->result;
+            g->leader_block[vn] = block;
+            g->leader_log[g->leader_top++] = vn;
+        }
+    }
+}
+
+/*
+ * Aplica GVN a la función que empieza en start, recorriendo el árbol de dominadores
+ * en preorden. counts acumula eliminaciones locales, entre bloques y comparaciones
+ * resueltas.
+ */
+static void gvn_function(IRList *list, int start, int *end, int counts[3]) {
+    CFG cfg;
+    SSAGraph ssa;
+    cfg_build(&cfg, list, start);
+    ssa_build(&ssa, &cfg);
+    *end = cfg.end;
+
+    int n = cfg.end - cfg.start;
+    int nb = cfg.num_blocks;
+    GVNState g;
+    g.cfg = &cfg;
+    g.ssa = &ssa;
+    g.num_vns = 0;
+    g.vn_capacity = 64;
+    g.leader_top = 0;
+    g.num_entries = 0;
+    g.num_buckets = 64;
+    while (g.num_buckets < 2 * (n + 3 * nb)) g.num_buckets *= 2;
+    g.vn = df_alloc(n + ssa.num_phis + 1, sizeof(int));
+    g.entry_vn = df_alloc(cfg.num_syms + 1, sizeof(int));
+    g.def_count = df_alloc(cfg.num_syms + 1, sizeof(int));
+    g.vn_is_const = df_alloc(g.vn_capacity, sizeof(bool));
+    g.leader = df_alloc(g.vn_capacity, sizeof(IRSymbol *));
+    g.leader_block = df_alloc(g.vn_capacity, sizeof(int));
+    g.leader_log = df_alloc(g.vn_capacity, sizeof(int));
+    // Por instrucción a lo sumo una expresión; por bloque, los dos hechos de un salto
+    g.entries = df_alloc(n + 2 * nb + 1, sizeof(GVNEntry));
+    g.buckets = df_alloc(g.num_buckets, sizeof(int));
+    g.const_capacity = 16;
+    while (g.const_capacity < 2 * (n + 2)) g.const_capacity *= 2;
+    g.const_keys = df_alloc(g.const_capacity, sizeof(int));
+    g.const_vns = df_alloc(g.const_capacity, sizeof(int));
+
+    int *child_start = df_alloc(nb + 2, sizeof(int));
+    int *children = df_alloc(nb + 1, sizeof(int));
+    int *stack = df_alloc(2 * nb + 1, sizeof(int));
+    int *entries_mark = df_alloc(nb + 1, sizeof(int));
+    int *leaders_mark = df_alloc(nb + 1, sizeof(int));
+    for (int v = 0; v < n + ssa.num_phis; v++) g.vn[v] = -1;
+    for (int sym = 0; sym < cfg.num_syms; sym++) g.entry_vn[sym] = -1;
+    for (int h = 0; h < g.num_buckets; h++) g.buckets[h] = -1;
+    for (int h = 0; h < g.const_capacity; h++) g.const_vns[h] = -1;
+    for (int rel = 0; rel < n; rel++) {
+        if (cfg.def_of[rel] >= 0) g.def_count[cfg.def_of[rel]]++;
+    }
+
+    // Hijos de cada bloque en el árbol de dominadores (CSR)
+    for (int b = 1; b < nb; b++) {
+        if (ssa.idom[b] >= 0) child_start[ssa.idom[b] + 1]++;
+    }
+    for (int b = 0; b < nb; b++) child_start[b + 1] += child_start[b];
+    int *fill = df_alloc(nb + 1, sizeof(int));
+    for (int b = 1; b < nb; b++) {
+        if (ssa.idom[b] >= 0) children[child_start[ssa.idom[b]] + fill[ssa.idom[b]]++] = b;
+    }
+    free(fill);
+
+    // Preorden con la pila: un bloque b se abre con b y se cierra con -1 - b
+    int sp = 0;
+    if (nb > 0) stack[sp++] = 0;
+    while (sp > 0) {
+        int item = stack[--sp];
+        if (item < 0) {
+            int b = -1 - item;
+            gvn_close_scope(&g, entries_mark[b], leaders_mark[b]);
+            continue;
+        }
+        entries_mark[item] = g.num_entries;
+        leaders_mark[item] = g.leader_top;
+        gvn_record_branch_outcome(&g, item);
+        gvn_visit_block(&g, item, counts);
+        stack[sp++] = -1 - item;
+        for (int k = child_start[item]; k < child_start[item + 1]; k++) {
+            stack[sp++] = children[k];
+        }
+    }
+
+    free(g.vn);
+    free(g.entry_vn);
+    free(g.def_count);
+    free(g.vn_is_const);
+    free(g.leader);
+    free(g.leader_block);
+    free(g.leader_log);
+    free(g.entries);
+    free(g.buckets);
+    free(g.const_keys);
+    free(g.const_vns);
+    free(child_start);
+    free(children);
+    free(stack);
+    free(entries_mark);
+    free(leaders_mark);
+    ssa_free(&ssa);
+    cfg_free(&cfg);
+}
+
+/*
+ * Eliminación de cálculos redundantes con GVN, función por función.
+ */
+void optimize_global_value_numbering(IRList *list) {
+    int counts[3] = {0, 0, 0};
+
+    for (int start = 0; start < list->size; start++) {
+        if (list->codes[start].op != IR_METHOD) continue;
+        int end;
+        gvn_function(list, start, &end, counts);
+        start = end - 1;
+    }
+
+    compact_ir_list(list);
+
+    if (counts[0] + counts[1] + counts[2] > 0 && debug_mode) {
+        printf("✓ Numeración de valores (GVN): %d instrucciones redundantes eliminadas "
+               "(%d en el mismo bloque, %d entre bloques), %d comparaciones resueltas\n",
+               counts[0] + counts[1], counts[0], counts[1], counts[2]);
+    }
+}
+
+/*
+ * Instrucciones sin efectos secundarios: pueden eliminarse si nadie usa su resultado.
+ * Los STORE a variables locales también, porque sus lecturas aparecen en las cadenas def-use.
+ */
+static bool is_removable_instruction(IRCode *code) {
+    if (!code->result) return false;
+    // Tras la coalescencia de copias una operación puede escribir un global (total = total + v)
+    if (code->result->type == IR_SYM_VAR && ir_is_global(code->result->name)) return false;
+    switch (code->op) {
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_MOD:
+        case IR_AND:
+        case IR_OR:
+        case IR_NOT:
+        case IR_UMINUS:
+        case IR_EQ:
+        case IR_NEQ:
+        case IR_LT:
+        case IR_LE:
+        case IR_GT:
+        case IR_GE:
+        case IR_LOAD:
+            return true;
+        case IR_STORE:
+            return code->result->type == IR_SYM_VAR && !ir_is_global(code->result->name);
+        default:
+            return false;
+    }
+}
+
+/*
+ * Una llamada se puede eliminar si su resultado no se usa y el grafo de llamadas
+ * dice que el método no escribe globales, no llama a externos y termina.
+ */
+static bool is_removable_call(IRCode *code) {
+    const CallNode *node = code->arg1 ? callgraph_summary(code->arg1->name) : NULL;
+    return node && node->read_only && node->terminates;
 }
 
 /*
  * Eliminación de código muerto en IR.
+ * Por cada función se construye el grafo SSA una sola vez y se marcan como vivas las
+ * instrucciones esenciales; luego, con una worklist, los valores (instrucciones o phi)
+ * que lee algún valor vivo. Todo lo que queda sin marcar y no tiene efectos se elimina.
+ * Cada valor entra a la worklist a lo sumo una vez: O(n + phis + argumentos de las phi).
+ * Los argumentos de una llamada eliminable viven sólo si vive la llamada. Los bloques
+ * inalcanzables no se tocan: los elimina la simplificación del CFG.
  */
 void optimize_dead_code_elimination(IRList *list) {
     int optimizations = 0;
-    bool *is_used = calloc(list->size, sizeof(bool));
+    StrMap arities;
+    ir_method_arities(list, &arities);
     
-    // Marcar todas las instrucciones esenciales (saltos, returns, stores, calls)
-    for (int i = 0; i < list->size; i++) {
-        IRCode *code = &list->codes[i];
+    for (int start = 0; start < list->size; start++) {
+        if (list->codes[start].op != IR_METHOD) continue;
+        
+        CFG cfg;
+        SSAGraph ssa;
+        cfg_build(&cfg, list, start);
+        ssa_build(&ssa, &cfg);
         
-        if (code->op == IR_STORE || code->op == IR_RETURN || 
-            code->op == IR_CALL || code->op == IR_LABEL ||
-            code->op == IR_GOTO || code->op == IR_IF_FALSE || code->op == IR_IF_TRUE ||
-            code->op == IR_METHOD || code->op == IR_EXTERN || code->op == IR_PARAM ||
-            code->op == IR_CALL_PARAM) {
-            is_used[i] = true;
+        int n = cfg.end - cfg.start;
+        int num_values = n + ssa.num_phis;
+        bool *is_live = df_alloc(num_values + 1, sizeof(bool));
+        int *worklist = df_alloc(num_values + 1, sizeof(int));
+        int top = 0;
+        
+        // Argumentos de cada llamada eliminable, como listas enlazadas por llamada
+        int *call_of = df_alloc(n, sizeof(int));
+        int *first_arg = df_alloc(n, sizeof(int));
+        int *next_arg = df_alloc(n, sizeof(int));
+        ir_match_call_params(&list->codes[cfg.start], n, &arities, call_of);
+        for (int i = 0; i < n; i++) first_arg[i] = -1;
+        for (int i = n - 1; i >= 0; i--) {
+            int call = call_of[i];
+            if (list->codes[cfg.start + i].op != IR_CALL_PARAM || call < 0) continue;
+            if (!is_removable_call(&list->codes[cfg.start + call])) continue;
+            next_arg[i] = first_arg[call];
+            first_arg[call] = i;
         }
-    }
-    
-    // Propagar uso hacia atrás
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        for (int i = list->size - 1; i >= 0; i--) {
-            if (!is_used[i]) continue;
-            
-            IRCode *code = &list->codes[i];
-            
-            // Si esta instrucción está marcada como usada, marcar sus dependencias
-            if (code->arg1 && code->arg1->name && code->arg1->name[0] == 't') {
-                // Buscar la definición de arg1
-                for (int j = i - 1; j >= 0; j--) {
-                    if (list->codes[j].result && 
-                        strcmp(list->codes[j].result->name, code->arg1->name) == 0) {
-                        if (!is_used[j]) {
-                            is_used[j] = true;
-                            changed = true;
-                        }
-                        break;
+        
+        // Marcar las instrucciones esenciales (saltos, returns, llamadas con efectos, stores a globales)
+        for (int i = 0; i < n; i++) {
+            IRCode *code = &list->codes[cfg.start + i];
+            bool essential;
+            if (cfg.blocks[cfg.block_of[i]].rpo < 0) essential = true;
+            else if (code->op == IR_CALL) essential = !is_removable_call(code);
+            else if (code->op == IR_CALL_PARAM) essential = call_of[i] < 0 || !is_removable_call(&list->codes[cfg.start + call_of[i]]);
+            else essential = !is_removable_instruction(code);
+            if (essential) {
+                is_live[i] = true;
+                worklist[top++] = i;
+            }
+        }
+        
+        // Propagar uso hacia los valores que lee cada instrucción o phi viva
+        while (top > 0) {
+            int v = worklist[--top];
+            if (v >= n) {
+                PhiNode *phi = &ssa.phis[v - n];
+                for (int j = 0; j < cfg.blocks[phi->block].num_preds; j++) {
+                    int arg = phi->args[j];
+                    if (arg >= 0 && !is_live[arg]) {
+                        is_live[arg] = true;
+                        worklist[top++] = arg;
                     }
                 }
+                continue;
             }
-            
-            if (code->arg2 && code->arg2->name && code->arg2->name[0] == 't') {
-                // Buscar la definición de arg2
-                for (int j = i - 1; j >= 0; j--) {
-                    if (list->codes[j].result && 
-                        strcmp(list->codes[j].result->name, code->arg2->name) == 0) {
-                        if (!is_used[j]) {
-                            is_used[j] = true;
-                            changed = true;
-                        }
-                        break;
-                    }
+            for (int a = first_arg[v]; a >= 0; a = next_arg[a]) {
+                if (!is_live[a]) {
+                    is_live[a] = true;
+                    worklist[top++] = a;
+                }
+            }
+            for (int u = 2 * v; u < 2 * v + 2; u++) {
+                int value = ssa.use_value[u];
+                if (cfg.use_of[u] >= 0 && value >= 0 && !is_live[value]) {
+                    is_live[value] = true;
+                    worklist[top++] = value;
                 }
             }
         }
-    }
-    
-    // Eliminar instrucciones no usadas
-    for (int i = 0; i < list->size; i++) {
-        if (!is_used[i]) {
-            IRCode *code = &list->codes[i];
-            // Solo eliminar operaciones aritméticas/lógicas con resultado temporal
-            if (code->result && code->result->name && code->result->name[0] == 't') {
-                if (code->op == IR_ADD || code->op == IR_SUB || code->op == IR_MUL ||
-                    code->op == IR_DIV || code->op == IR_MOD || code->op == IR_AND ||
-                    code->op == IR_OR || code->op == IR_NOT || code->op == IR_UMINUS ||
-                    code->op == IR_EQ || code->op == IR_NEQ || code->op == IR_LT ||
-                    code->op == IR_LE || code->op == IR_GT || code->op == IR_GE ||
-                    (code->op == IR_LOAD && code->arg1->type == IR_SYM_CONST)) {
-                    mark_instruction_as_nop(list, i);
-                    if (debug_mode) {
-                        printf("  [DEAD CODE] Línea %d: instrucción eliminada (resultado no usado)\n", i);
-                    }
-                    optimizations++;
+        
+        // Eliminar instrucciones no usadas
+        for (int i = 0; i < n; i++) {
+            if (!is_live[i]) {
+                mark_instruction_as_nop(list, cfg.start + i);
+                if (debug_mode) {
+                    printf("  [DEAD CODE] Línea %d: instrucción eliminada (resultado no usado)\n", cfg.start + i);
                 }
+                optimizations++;
             }
         }
+        
+        start = cfg.end - 1;
+        free(is_live);
+        free(worklist);
+        free(call_of);
+        free(first_arg);
+        free(next_arg);
+        ssa_free(&ssa);
+        cfg_free(&cfg);
     }
     
-    free(is_used);
+    strmap_free(&arities);
+    compact_ir_list(list);
     
     if (optimizations > 0 && debug_mode) {
         printf("✓ Eliminación de código muerto: %d instrucciones eliminadas\n", optimizations);
     }
 }
 
+/*
+ * Elimina de la lista las instrucciones marcadas como NOP.
+ */
+void compact_ir_list(IRList *list) {
+    int size = 0;
+    for (int i = 0; i < list->size; i++) {
+        if (!ir_is_nop(&list->codes[i])) {
+            list->codes[size++] = list->codes[i];
+        }
+    }
+    list->size = size;
+}
+
+/*
+ * Reemplaza las instrucciones [start, end) de la lista por las count de codes.
+ * Lo usan los pases que insertan código (preheaders, copias de loops).
+ */
+void ir_replace_range(IRList *list, int start, int end, IRCode *codes, int count) {
+    int new_size = list->size - (end - start) + count;
+    if (new_size > list->capacity) {
+        list->capacity = new_size * 2;
+        list->codes = realloc(list->codes, list->capacity * sizeof(IRCode));
+        if (!list->codes) {
+            fprintf(stderr, "Error: no se pudo redimensionar la lista de código intermedio\n");
+            exit(1);
+        }
+    }
+    memmove(&list->codes[start + count], &list->codes[end], (list->size - end) * sizeof(IRCode));
+    memcpy(&list->codes[start], codes, count * sizeof(IRCode));
+    list->size = new_size;
+}
+
 /*
  * Simplificación algebraica para las IR.
  * Incluye tanto optimizaciones algebraicas como patrones específicos.
@@ -435,18 +1386,19 @@ Nodo *optimize_ast_constant_folding(Nodo *node) {
                 int result_value = 0;
                 bool can_fold = true;
                 
+                // Igual que en el IR: un resultado que no entra en un int no se pliega
                 switch (node->opBinaria.op) {
                     case TOP_SUMA:
-                        result_value = val1 + val2;
+                        can_fold = fold_binary(IR_ADD, val1, val2, &result_value);
                         break;
                     case TOP_RESTA:
-                        result_value = val1 - val2;
+                        can_fold = fold_binary(IR_SUB, val1, val2, &result_value);
                         break;
                     case TOP_MULT:
-                        result_value = val1 * val2;
+                        can_fold = fold_binary(IR_MUL, val1, val2, &result_value);
                         break;
                     case TOP_DIV:
-                        if (val2 != 0) {
+                        if (val2 != 0 && !(val1 == INT_MIN && val2 == -1)) {
                             result_value = val1 / val2;
                         } else {
                             can_fold = false;
@@ -743,6 +1695,29 @@ Nodo *optimize_ast_algebraic_simplification(Nodo *node) {
 }
 
 
+/*
+ * Ejecuta un pase sobre el IR y, con -time-passes, informa cuánto tardó.
+ * Si el pase cambia qué llama cada método, el grafo de llamadas se recalcula
+ * dentro del tiempo del pase.
+ */
+static void run_ir_pass(const char *name, void (*pass)(IRList *), IRList *list, bool changes_calls) {
+    clock_t start = clock();
+    int size_before = list->size;
+    pass(list);
+    if (changes_calls) callgraph_update(list);
+    if (time_passes) {
+        double ms = 1000.0 * (double)(clock() - start) / CLOCKS_PER_SEC;
+        printf("  [TIEMPO] %-32s %10.2f ms  (%d -> %d instrucciones)\n",
+               name, ms, size_before, list->size);
+    }
+}
+
+static int inlined_calls = 0;
+
+static void run_inlining(IRList *list) {
+    inlined_calls = optimize_inlining(list);
+}
+
 /*
  * Función principal que ejecuta todas las optimizaciones para el IR
  */
@@ -751,12 +1726,44 @@ void optimize_ir_code(IRList *list) {
         printf("\n=== INICIANDO OPTIMIZACIONES ===\n");
     }
     
-    optimize_constant_folding(list);
-    optimize_constant_propagation(list);
-    optimize_algebraic_simplification(list);
-    optimize_dead_code_elimination(list);
+    run_ir_pass("call graph", callgraph_update, list, false);
+    // Primero: si el programa no lee nada, el resto de los pases ve sólo su salida
+    run_ir_pass("partial evaluation", optimize_partial_evaluation, list, true);
+    run_ir_pass("dead function elimination", optimize_dead_functions, list, true);
+    run_ir_pass("constant folding", optimize_constant_folding, list, false);
+    run_ir_pass("constant propagation", optimize_constant_propagation, list, false);
+    run_ir_pass("CFG simplification", optimize_cfg_simplification, list, false);
+    run_ir_pass("interprocedural constants", optimize_interprocedural_constants, list, true);
+    run_ir_pass("tail recursion", optimize_tail_recursion, list, true);
+    run_ir_pass("specialization", optimize_specialization, list, true);
+    run_ir_pass("inlining", run_inlining, list, true);
+    if (inlined_calls > 0) {
+        // Los cuerpos inlineados reciben argumentos constantes: se vuelven a plegar
+        run_ir_pass("constant folding (post-inlining)", optimize_constant_folding, list, false);
+        run_ir_pass("constant propagation (post-inlining)", optimize_constant_propagation, list, false);
+    }
+    // Los saltos plegados dejan bloques muertos y cadenas de GOTO antes de los pases de loops
+    run_ir_pass("CFG simplification (post-inlining)", optimize_cfg_simplification, list, false);
+    run_ir_pass("global value numbering", optimize_global_value_numbering, list, false);
+    run_ir_pass("loop invariant code motion", optimize_loop_invariant_code_motion, list, false);
+    run_ir_pass("loop unswitching", optimize_loop_unswitching, list, false);
+    run_ir_pass("loop closed forms", optimize_loop_closed_forms, list, false);
+    run_ir_pass("induction variables", optimize_induction_variables, list, false);
+    run_ir_pass("loop unrolling", optimize_loop_unrolling, list, false);
+    run_ir_pass("loop rotation", optimize_loop_rotation, list, false);
+    run_ir_pass("algebraic simplification", optimize_algebraic_simplification, list, false);
+    run_ir_pass("copy propagation", optimize_copy_propagation, list, false);
+    run_ir_pass("dead code elimination", optimize_dead_code_elimination, list, false);
+    run_ir_pass("CFG simplification (final)", optimize_cfg_simplification, list, false);
+    run_ir_pass("dead function elimination (post-inlining)", optimize_dead_functions, list, true);
+    if (memoize_enabled) {
+        // Último: ningún pase anterior conoce las instrucciones MEMO_*
+        run_ir_pass("memoization", optimize_memoization, list, false);
+    }
     
+    callgraph_clear();
     if (debug_mode) {
+        dataflow_report(list);
         printf("=== OPTIMIZACIONES COMPLETADAS ===\n\n");
     }
 }
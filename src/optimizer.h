@@ -9,6 +9,51 @@
  */
 extern int optimizer_enabled;
 
+/*
+ * Con -time-passes se informa el tiempo de cada pase de optimización del IR
+ */
+extern int time_passes;
+
+/*
+ * Factor del desenrollado parcial de loops (-unroll-factor N); menos de 2 lo apaga
+ */
+extern int unroll_factor;
+
+/*
+ * Instrucciones que el unswitching puede agregar en cada función (-unswitch-budget N)
+ */
+extern int unswitch_budget;
+
+/*
+ * Costo máximo de una llamada que se inlinea (-inline-threshold N); 0 lo apaga
+ */
+extern int inline_threshold;
+
+/*
+ * Clones por función que puede crear la especialización (-specialize-clones N); 0 la apaga
+ */
+extern int specialize_clones;
+
+/*
+ * Pasos por llamada que puede ejecutar la evaluación en compilación (-eval-steps N); 0 la apaga
+ */
+extern long eval_steps;
+
+/*
+ * Memoización de funciones puras y recursivas (-memoize)
+ */
+extern int memoize_enabled;
+
+/*
+ * Evaluación en compilación de programas sin entrada (-peval)
+ */
+extern int peval_enabled;
+
+/*
+ * Imprime el grafo de llamadas y los resúmenes de cada método (-dump-callgraph)
+ */
+extern int dump_callgraph;
+
 /*
  * Estructura para análisis de uso de variables
  */
@@ -32,6 +77,7 @@ typedef struct {
 // Funciones para instrucciones IR
 void optimize_constant_folding(IRList *list);
 void optimize_constant_propagation(IRList *list);
+void optimize_global_value_numbering(IRList *list);
 void optimize_dead_code_elimination(IRList *list);
 void optimize_algebraic_simplification(IRList *list);
 
@@ -54,5 +100,6 @@ void replace_instruction(IRList *list, int index, IRInstr new_op,
                         IRSymbol *new_arg1, IRSymbol *new_arg2, IRSymbol *new_result);
 void mark_instruction_as_nop(IRList *list, int index);
 void compact_ir_list(IRList *list);
+void ir_replace_range(IRList *list, int start, int end, IRCode *codes, int count);
 
 #endif
\ No newline at end of file
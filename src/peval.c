@@ -0,0 +1,147 @@
+#include "peval.h"
+#include "optimizer.h"
+#include "dataflow.h"
+#include "evaluator.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Evaluación parcial del programa completo.
+ *
+ * Un programa que no lee nada produce siempre la misma salida. Si ningún CALL
+ * va a un externo distinto de print_int, main se ejecuta en el evaluador del IR
+ * (con las globales inicializadas como antes del primer método) y cada llamada
+ * a print_int queda registrada. El programa resultante es un main que sólo
+ * hace esas llamadas con argumentos constantes; los demás métodos y las
+ * globales desaparecen.
+ *
+ * Si la ejecución supera el presupuesto de pasos o de salidas, divide por cero
+ * o llega a algo que el evaluador no sabe ejecutar, el programa queda como
+ * estaba y sigue el pipeline normal.
+ */
+
+/*
+ * Primer externo llamado que no es print_int, o NULL si no hay.
+ */
+static const char *input_extern(IRList *list) {
+    StrMap methods;
+    strmap_init(&methods, 16);
+    for (int i = 0; i < list->size; i++) {
+        if (list->codes[i].op == IR_METHOD && list->codes[i].result) {
+            strmap_put(&methods, list->codes[i].result->name, i);
+        }
+    }
+    const char *name = NULL;
+    for (int i = 0; i < list->size && !name; i++) {
+        IRCode *code = &list->codes[i];
+        if (code->op != IR_CALL || !code->arg1) continue;
+        if (strmap_get(&methods, code->arg1->name) >= 0) continue;
+        if (strcmp(code->arg1->name, "print_int") != 0) name = code->arg1->name;
+    }
+    strmap_free(&methods);
+    return name;
+}
+
+/*
+ * Índice del primer método seguido por código de nivel superior, o -1 si no
+ * hay. Es la forma que toma la inicialización de una global escrita después
+ * de un método: el evaluador no la correría antes de main, así que el
+ * resultado sería incorrecto.
+ */
+static int stray_top_level(IRList *list) {
+    for (int i = 0; i < list->size; i++) {
+        if (list->codes[i].op != IR_METHOD) continue;
+        CFG cfg;
+        cfg_build(&cfg, list, i);
+        bool stray = cfg_top_level_start(&cfg) < cfg.end;
+        int end = cfg.end;
+        cfg_free(&cfg);
+        if (stray) return i;
+        i = end - 1;
+    }
+    return -1;
+}
+
+void optimize_partial_evaluation(IRList *list) {
+    if (!peval_enabled) return;
+
+    const char *name = input_extern(list);
+    if (name) {
+        if (debug_mode) printf("  [PEVAL] El programa llama a %s: se compila normalmente\n", name);
+        return;
+    }
+
+    int stray = stray_top_level(list);
+    if (stray >= 0) {
+        if (debug_mode) {
+            printf("  [PEVAL] Hay globales que se inicializan después de %s: se compila normalmente\n",
+                   list->codes[stray].result->name);
+        }
+        return;
+    }
+
+    IREvaluator ev;
+    ir_eval_init(&ev, list, PEVAL_MAX_STEPS);
+    int main_func = ir_eval_function(&ev, "main");
+    if (main_func < 0) {
+        ir_eval_free(&ev);
+        return;
+    }
+
+    long result;
+    EvalStatus status = ir_eval_program(&ev, PEVAL_MAX_OUTPUT, &result);
+    const char *reason = status != EVAL_OK ? ir_eval_status_text(status) : NULL;
+    // Las constantes del IR son int
+    for (int k = 0; k < ev.num_output && !reason; k++) {
+        if (ev.output[k] < INT_MIN || ev.output[k] > INT_MAX) reason = "imprime un valor fuera del rango de int";
+    }
+    if (!reason && (result < INT_MIN || result > INT_MAX)) reason = "devuelve un valor fuera del rango de int";
+    if (reason) {
+        if (debug_mode) printf("  [PEVAL] main no se evalúa (%s, %ld pasos): se compila normalmente\n", reason, ev.steps);
+        ir_eval_free(&ev);
+        return;
+    }
+
+    // main devuelve un valor si alguno de sus RETURN lo tiene
+    IRSymbol *main_symbol = list->codes[ev.funcs[main_func].start].result;
+    bool returns_value = false;
+    IRSymbol *print_symbol = NULL;
+    for (int i = 0; i < list->size; i++) {
+        IRCode *code = &list->codes[i];
+        if (code->op == IR_RETURN && code->arg1 && i > ev.funcs[main_func].start && i < ev.funcs[main_func].end) {
+            returns_value = true;
+        }
+        if (code->op == IR_CALL && code->arg1 && strcmp(code->arg1->name, "print_int") == 0) {
+            print_symbol = code->arg1;
+        }
+    }
+
+    IRList program;
+    ir_init(&program);
+    for (int i = 0; i < list->size; i++) {
+        IRCode *code = &list->codes[i];
+        if (code->op == IR_EXTERN) ir_emit(&program, IR_EXTERN, code->arg1, code->arg2, code->result);
+    }
+    ir_emit(&program, IR_METHOD, NULL, NULL, main_symbol);
+    for (int k = 0; k < ev.num_output; k++) {
+        ir_emit(&program, IR_CALL_PARAM, new_const_symbol((int)ev.output[k], 0), NULL, NULL);
+        ir_emit(&program, IR_CALL, print_symbol, NULL, new_temp_symbol());
+    }
+    if (returns_value) ir_emit(&program, IR_RETURN, new_const_symbol((int)result, 0), NULL, NULL);
+
+    int size_before = list->size, prints = ev.num_output;
+    if (debug_mode) {
+        printf("  [PEVAL] main evaluado en compilación: %ld pasos, %d llamadas a print_int\n",
+               ev.steps, ev.num_output);
+    }
+    ir_replace_range(list, 0, list->size, program.codes, program.size);
+    ir_free(&program);
+    ir_eval_free(&ev);
+
+    if (debug_mode) {
+        printf("✓ Evaluación parcial: el programa se reduce a %d llamadas a print_int (%d -> %d instrucciones)\n",
+               prints, size_before, list->size);
+    }
+}
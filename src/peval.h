@@ -0,0 +1,22 @@
+#ifndef PEVAL_H
+#define PEVAL_H
+
+#include "intermediate.h"
+
+/*
+ * Presupuesto de la evaluación del programa completo: instrucciones ejecutadas
+ * y llamadas a print_int registradas. Si se supera cualquiera de los dos, el
+ * programa se compila normalmente.
+ */
+#define PEVAL_MAX_STEPS         50000000L
+#define PEVAL_MAX_OUTPUT        4096
+
+/*
+ * Evaluación parcial de programas sin entrada (-peval): si el programa no
+ * llama a get_int ni a ningún externo salvo print_int, se ejecuta main en
+ * tiempo de compilación y el programa se reemplaza por las llamadas a
+ * print_int que hizo, con sus argumentos constantes.
+ */
+void optimize_partial_evaluation(IRList *list);
+
+#endif
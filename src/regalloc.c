@@ -0,0 +1,230 @@
+#include "regalloc.h"
+#include "dataflow.h"
+#include "object.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/*
+ * Registros asignables, en orden de preferencia: primero los caller-saved, que
+ * no hay que guardar en el prólogo. %r10 y %r11 quedan fuera porque la selección
+ * de instrucciones los usa como auxiliares, y %rsp/%rbp sostienen el frame.
+ */
+static const MReg allocatable[] = {
+    MREG_RCX, MREG_RSI, MREG_RDI, MREG_R8, MREG_R9, MREG_RDX, MREG_RAX,
+    MREG_RBX, MREG_R12, MREG_R13, MREG_R14, MREG_R15
+};
+#define NUM_ALLOCATABLE ((int)(sizeof(allocatable) / sizeof(allocatable[0])))
+
+#define CALLEE_SAVED_MASK ((1u << MREG_RBX) | (1u << MREG_R12) | (1u << MREG_R13) | \
+                           (1u << MREG_R14) | (1u << MREG_R15))
+
+typedef struct {
+    int temp;           // Número del temporal
+    int start;          // Posiciones relativas al METHOD, inclusivas
+    int end;
+    unsigned forbidden; // Registros que pisa alguna instrucción dentro del intervalo
+} LiveInterval;
+
+void regalloc_init(RegAllocation *ra) {
+    ra->temp_reg = NULL;
+    ra->capacity = 0;
+    ra->callee_saved = 0;
+    ra->num_temps = 0;
+    ra->num_spilled = 0;
+    ra->num_callee_saved = 0;
+}
+
+void regalloc_free(RegAllocation *ra) {
+    free(ra->temp_reg);
+    regalloc_init(ra);
+}
+
+static void set_temp_register(RegAllocation *ra, int temp, MReg reg) {
+    if (temp >= ra->capacity) {
+        int old_capacity = ra->capacity;
+        ra->capacity = (temp + 1) * 2;
+        ra->temp_reg = realloc(ra->temp_reg, ra->capacity * sizeof(MReg));
+        if (!ra->temp_reg) {
+            fprintf(stderr, "Error: no se pudo redimensionar la tabla de registros\n");
+            exit(1);
+        }
+        for (int i = old_capacity; i < ra->capacity; i++) {
+            ra->temp_reg[i] = MREG_NONE;
+        }
+    }
+    ra->temp_reg[temp] = reg;
+}
+
+/*
+ * Registro asignado a un temporal, o MREG_NONE si vive en el stack.
+ */
+MReg regalloc_temp_register(RegAllocation *ra, const char *temp_name) {
+    int temp = atoi(temp_name + 1);
+    return temp < ra->capacity ? ra->temp_reg[temp] : MREG_NONE;
+}
+
+static int compare_intervals(const void *a, const void *b) {
+    const LiveInterval *x = a, *y = b;
+    if (x->start != y->start) return x->start - y->start;
+    return x->temp - y->temp;
+}
+
+static void extend_interval(LiveInterval *interval, int pos) {
+    if (pos < interval->start) interval->start = pos;
+    if (pos > interval->end) interval->end = pos;
+}
+
+/*
+ * Arma el intervalo de cada temporal de la función: todas sus apariciones más,
+ * por cada bloque donde está vivo a la entrada o a la salida, el borde de ese
+ * bloque. El intervalo resultante es la envoltura de todos los tramos vivos, así
+ * que puede ser más largo que lo necesario pero nunca más corto.
+ */
+static LiveInterval *build_intervals(CFG *cfg, int *num_intervals) {
+    int n = cfg->end - cfg->start;
+    int *interval_of = df_alloc(cfg->num_syms, sizeof(int));
+    LiveInterval *intervals = df_alloc(cfg->num_syms, sizeof(LiveInterval));
+    int count = 0;
+
+    for (int sym = 0; sym < cfg->num_syms; sym++) {
+        interval_of[sym] = -1;
+        if (is_temp_var(cfg->sym_names[sym])) {
+            interval_of[sym] = count;
+            intervals[count].temp = atoi(cfg->sym_names[sym] + 1);
+            intervals[count].start = INT_MAX;
+            intervals[count].end = INT_MIN;
+            intervals[count].forbidden = 0;
+            count++;
+        }
+    }
+
+    for (int rel = 0; rel < n; rel++) {
+        int syms[3] = {cfg->def_of[rel], cfg->use_of[2 * rel], cfg->use_of[2 * rel + 1]};
+        for (int k = 0; k < 3; k++) {
+            if (syms[k] >= 0 && interval_of[syms[k]] >= 0) {
+                extend_interval(&intervals[interval_of[syms[k]]], rel);
+            }
+        }
+    }
+
+    DataflowProblem live;
+    liveness_compute(&live, cfg);
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        int block_start = cfg->blocks[b].start - cfg->start;
+        int block_end = cfg->blocks[b].end - cfg->start;
+
+        for (int bit = bitset_next(&live.in[b], 0); bit >= 0; bit = bitset_next(&live.in[b], bit + 1)) {
+            int index = interval_of[cfg->nonlocal_syms[bit]];
+            if (index >= 0) {
+                extend_interval(&intervals[index], block_start - 1);
+                extend_interval(&intervals[index], block_start);
+            }
+        }
+        for (int bit = bitset_next(&live.out[b], 0); bit >= 0; bit = bitset_next(&live.out[b], bit + 1)) {
+            int index = interval_of[cfg->nonlocal_syms[bit]];
+            if (index >= 0) {
+                extend_interval(&intervals[index], block_end - 1);
+                extend_interval(&intervals[index], block_end);
+            }
+        }
+    }
+    dataflow_problem_free(&live);
+
+    // Registros pisados estrictamente dentro de cada intervalo, con sumas prefijas
+    // por registro: clobbered[r][k] = instrucciones anteriores a k que pisan r
+    int *clobbered[MREG_NONE] = {0};
+    for (int r = 0; r < NUM_ALLOCATABLE; r++) {
+        clobbered[allocatable[r]] = df_alloc(n + 2, sizeof(int));
+    }
+    for (int rel = 0; rel <= n; rel++) {
+        unsigned mask = rel < n ? translate_clobbers(&cfg->list->codes[cfg->start + rel]) : 0;
+        for (int r = 0; r < NUM_ALLOCATABLE; r++) {
+            MReg reg = allocatable[r];
+            clobbered[reg][rel + 1] = clobbered[reg][rel] + ((mask >> reg) & 1);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        LiveInterval *interval = &intervals[i];
+        int from = interval->start + 1 < 0 ? 0 : interval->start + 1;
+        int to = interval->end > n ? n : interval->end;
+        if (from >= to) continue;
+        for (int r = 0; r < NUM_ALLOCATABLE; r++) {
+            MReg reg = allocatable[r];
+            if (clobbered[reg][to] - clobbered[reg][from] > 0) interval->forbidden |= 1u << reg;
+        }
+    }
+    for (int r = 0; r < NUM_ALLOCATABLE; r++) {
+        free(clobbered[allocatable[r]]);
+    }
+
+    free(interval_of);
+    *num_intervals = count;
+    return intervals;
+}
+
+/*
+ * Asigna registros a los temporales de la función que empieza en start (una
+ * instrucción METHOD, o el código previo al primer METHOD).
+ */
+void regalloc_function(RegAllocation *ra, IRList *list, int start) {
+    CFG cfg;
+    cfg_build(&cfg, list, start);
+
+    int count;
+    LiveInterval *intervals = build_intervals(&cfg, &count);
+    qsort(intervals, count, sizeof(LiveInterval), compare_intervals);
+
+    // Intervalo que ocupa cada registro, -1 si está libre
+    int owner[MREG_NONE];
+    for (int r = 0; r < MREG_NONE; r++) owner[r] = -1;
+
+    ra->callee_saved = 0;
+    for (int i = 0; i < count; i++) {
+        LiveInterval *current = &intervals[i];
+
+        // Los intervalos que terminan donde empieza el actual liberan su registro:
+        // cada instrucción lee sus operandos antes de escribir el resultado
+        for (int r = 0; r < NUM_ALLOCATABLE; r++) {
+            MReg reg = allocatable[r];
+            if (owner[reg] >= 0 && intervals[owner[reg]].end <= current->start) owner[reg] = -1;
+        }
+
+        MReg chosen = MREG_NONE;
+        for (int r = 0; r < NUM_ALLOCATABLE && chosen == MREG_NONE; r++) {
+            MReg reg = allocatable[r];
+            if (owner[reg] < 0 && !(current->forbidden & (1u << reg))) chosen = reg;
+        }
+
+        if (chosen == MREG_NONE) {
+            // Sin registro libre: va al stack el intervalo que termina más tarde
+            int victim = -1;
+            for (int r = 0; r < NUM_ALLOCATABLE; r++) {
+                MReg reg = allocatable[r];
+                if (owner[reg] < 0 || (current->forbidden & (1u << reg))) continue;
+                if (victim < 0 || intervals[owner[reg]].end > intervals[owner[victim]].end) victim = reg;
+            }
+            if (victim >= 0 && intervals[owner[victim]].end > current->end) {
+                set_temp_register(ra, intervals[owner[victim]].temp, MREG_NONE);
+                chosen = victim;
+            } else {
+                set_temp_register(ra, current->temp, MREG_NONE);
+                ra->num_spilled++;
+                continue;
+            }
+            ra->num_spilled++;
+        }
+
+        owner[chosen] = i;
+        set_temp_register(ra, current->temp, chosen);
+        ra->callee_saved |= (1u << chosen) & CALLEE_SAVED_MASK;
+    }
+
+    ra->num_temps += count;
+    for (int r = 0; r < MREG_NONE; r++) {
+        if (ra->callee_saved & (1u << r)) ra->num_callee_saved++;
+    }
+
+    free(intervals);
+    cfg_free(&cfg);
+}
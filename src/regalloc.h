@@ -0,0 +1,32 @@
+#ifndef REGALLOC_H
+#define REGALLOC_H
+
+#include "intermediate.h"
+#include "mir.h"
+
+/*
+ * Asignación de registros por linear scan para los temporales de una función
+ * del IR. Cada temporal recibe un intervalo de posiciones de instrucción que
+ * cubre todos los puntos donde está vivo según el análisis de variables vivas,
+ * y los intervalos se recorren por inicio tomando el primer registro libre.
+ *
+ * Un temporal vivo a través de una instrucción que pisa registros (un CALL, un
+ * setcc sobre %al, la carga de un parámetro en %rdi) no puede ir a ninguno de
+ * ellos; a través de un CALL sólo quedan los callee-saved, que la función guarda
+ * en su frame. Si no queda ningún registro adecuado el temporal va al stack.
+ */
+typedef struct {
+    MReg *temp_reg;         // Registro de cada temporal (por número); MREG_NONE = en el stack
+    int capacity;
+    unsigned callee_saved;  // Registros callee-saved usados por la función (bit 1 << MReg)
+    int num_temps;          // Totales acumulados de todas las funciones
+    int num_spilled;
+    int num_callee_saved;
+} RegAllocation;
+
+void regalloc_init(RegAllocation *ra);
+void regalloc_free(RegAllocation *ra);
+void regalloc_function(RegAllocation *ra, IRList *list, int start);
+MReg regalloc_temp_register(RegAllocation *ra, const char *temp_name);
+
+#endif
@@ -0,0 +1,769 @@
+#include "scev.h"
+#include "optimizer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Evolución escalar (SCEV).
+ *
+ * Cada valor calculado dentro de un loop se modela como una recurrencia de suma
+ * en función del número de iteración j: {c0, +, c1, +, c2} vale c0 en la primera
+ * iteración y en cada una avanza lo que vale {c1, +, c2} en ella. Los
+ * coeficientes son expresiones afines sobre valores invariantes del loop.
+ *
+ * Una phi del header cuyo valor en el latch es phi + D, con D una recurrencia que
+ * no depende de la phi, es {valor inicial, +, D}. Las phi se resuelven en rondas:
+ * s = s + i se puede modelar recién cuando se conoce i.
+ *
+ * La aritmética es en complemento a dos de 64 bits, igual que el código generado.
+ */
+
+#define SCEV_EVAL_BUDGET 4096
+
+static long long wrap_add(long long a, long long b) {
+    return (long long)((unsigned long long)a + (unsigned long long)b);
+}
+
+static long long wrap_mul(long long a, long long b) {
+    return (long long)((unsigned long long)a * (unsigned long long)b);
+}
+
+/*
+ * Expresiones afines
+ */
+static void affine_const(SCEVAffine *a, long long value) {
+    a->constant = value;
+    a->num_terms = 0;
+}
+
+static void affine_sym(SCEVAffine *a, IRSymbol *sym) {
+    a->constant = 0;
+    a->num_terms = 1;
+    a->syms[0] = sym;
+    a->coefs[0] = 1;
+}
+
+bool scev_affine_is_constant(SCEVAffine *a) {
+    return a->num_terms == 0;
+}
+
+static bool affine_is_zero(SCEVAffine *a) {
+    return a->num_terms == 0 && a->constant == 0;
+}
+
+static bool affine_add_term(SCEVAffine *a, IRSymbol *sym, long long coef) {
+    if (coef == 0) return true;
+    for (int i = 0; i < a->num_terms; i++) {
+        if (strcmp(a->syms[i]->name, sym->name) != 0) continue;
+        a->coefs[i] = wrap_add(a->coefs[i], coef);
+        if (a->coefs[i] == 0) {
+            a->num_terms--;
+            a->syms[i] = a->syms[a->num_terms];
+            a->coefs[i] = a->coefs[a->num_terms];
+        }
+        return true;
+    }
+    if (a->num_terms == SCEV_MAX_TERMS) return false;
+    a->syms[a->num_terms] = sym;
+    a->coefs[a->num_terms] = coef;
+    a->num_terms++;
+    return true;
+}
+
+// dst = a + scale * b
+static bool affine_add(SCEVAffine *dst, SCEVAffine *a, SCEVAffine *b, long long scale) {
+    SCEVAffine r = *a;
+    r.constant = wrap_add(a->constant, wrap_mul(b->constant, scale));
+    for (int i = 0; i < b->num_terms; i++) {
+        if (!affine_add_term(&r, b->syms[i], wrap_mul(b->coefs[i], scale))) return false;
+    }
+    *dst = r;
+    return true;
+}
+
+static void affine_scale(SCEVAffine *a, long long k) {
+    a->constant = wrap_mul(a->constant, k);
+    for (int i = 0; i < a->num_terms; i++) a->coefs[i] = wrap_mul(a->coefs[i], k);
+    if (k == 0) a->num_terms = 0;
+}
+
+// Sólo productos en los que uno de los factores es constante
+static bool affine_mul(SCEVAffine *dst, SCEVAffine *a, SCEVAffine *b) {
+    SCEVAffine r;
+    if (scev_affine_is_constant(a)) {
+        r = *b;
+        affine_scale(&r, a->constant);
+    } else if (scev_affine_is_constant(b)) {
+        r = *a;
+        affine_scale(&r, b->constant);
+    } else {
+        return false;
+    }
+    *dst = r;
+    return true;
+}
+
+/*
+ * Recurrencias
+ */
+static void rec_const(SCEVRec *r, long long value) {
+    r->degree = 0;
+    affine_const(&r->coefs[0], value);
+}
+
+static void rec_sym(SCEVRec *r, IRSymbol *sym) {
+    r->degree = 0;
+    affine_sym(&r->coefs[0], sym);
+}
+
+static void rec_normalize(SCEVRec *r) {
+    while (r->degree > 0 && affine_is_zero(&r->coefs[r->degree])) r->degree--;
+}
+
+// dst = a + scale * b
+static bool rec_add(SCEVRec *dst, SCEVRec *a, SCEVRec *b, long long scale) {
+    SCEVRec r;
+    SCEVAffine zero;
+    affine_const(&zero, 0);
+    r.degree = a->degree > b->degree ? a->degree : b->degree;
+    for (int i = 0; i <= r.degree; i++) {
+        SCEVAffine *x = i <= a->degree ? &a->coefs[i] : &zero;
+        SCEVAffine *y = i <= b->degree ? &b->coefs[i] : &zero;
+        if (!affine_add(&r.coefs[i], x, y, scale)) return false;
+    }
+    rec_normalize(&r);
+    *dst = r;
+    return true;
+}
+
+static bool rec_mul(SCEVRec *dst, SCEVRec *a, SCEVRec *b) {
+    SCEVRec r;
+    if (b->degree == 0) {
+        SCEVRec *tmp = a;
+        a = b;
+        b = tmp;
+    }
+    if (a->degree == 0) {
+        r.degree = b->degree;
+        for (int i = 0; i <= b->degree; i++) {
+            if (!affine_mul(&r.coefs[i], &a->coefs[0], &b->coefs[i])) return false;
+        }
+    } else if (a->degree == 1 && b->degree == 1) {
+        // {a0, +, a1} * {b0, +, b1} = {a0 b0, +, a0 b1 + a1 b0 + a1 b1, +, 2 a1 b1}
+        SCEVAffine p00, p01, p10, p11;
+        if (!affine_mul(&p00, &a->coefs[0], &b->coefs[0]) || !affine_mul(&p01, &a->coefs[0], &b->coefs[1]) ||
+            !affine_mul(&p10, &a->coefs[1], &b->coefs[0]) || !affine_mul(&p11, &a->coefs[1], &b->coefs[1])) {
+            return false;
+        }
+        r.degree = 2;
+        r.coefs[0] = p00;
+        if (!affine_add(&r.coefs[1], &p01, &p10, 1) || !affine_add(&r.coefs[1], &r.coefs[1], &p11, 1)) return false;
+        r.coefs[2] = p11;
+        affine_scale(&r.coefs[2], 2);
+    } else {
+        return false;
+    }
+    rec_normalize(&r);
+    *dst = r;
+    return true;
+}
+
+/*
+ * Evaluación de valores SSA dentro del loop. target es la phi que se está
+ * resolviendo: sus apariciones se cuentan en self en lugar de modelarse.
+ */
+typedef struct {
+    int self;
+    SCEVRec rec;
+} SCEVTerm;
+
+typedef struct {
+    LoopSCEV *scev;
+    int target;
+    int budget;
+} SCEVEval;
+
+static bool scev_eval_value(SCEVEval *ev, int value, IRSymbol *sym, SCEVTerm *out);
+
+static bool scev_eval_operand(SCEVEval *ev, int rel, int slot, SCEVTerm *out) {
+    CFG *cfg = ev->scev->nest->cfg;
+    IRCode *code = &cfg->list->codes[cfg->start + rel];
+    IRSymbol *arg = slot == 0 ? code->arg1 : code->arg2;
+    if (!arg) return false;
+    if (cfg->use_of[2 * rel + slot] < 0) {
+        if (!is_constant_symbol(arg)) return false;
+        out->self = 0;
+        rec_const(&out->rec, get_constant_value(arg));
+        return true;
+    }
+    return scev_eval_value(ev, ev->scev->nest->ssa->use_value[2 * rel + slot], arg, out);
+}
+
+static bool scev_eval_value(SCEVEval *ev, int value, IRSymbol *sym, SCEVTerm *out) {
+    LoopSCEV *scev = ev->scev;
+    CFG *cfg = scev->nest->cfg;
+    SSAGraph *ssa = scev->nest->ssa;
+    Loop *loop = &scev->nest->loops[scev->loop];
+    int n = ssa->num_instrs;
+    if (--ev->budget < 0 || value == SSA_CLOBBER) return false;
+
+    out->self = 0;
+    if (value == SSA_ENTRY) {
+        if (!sym) return false;
+        rec_sym(&out->rec, sym);
+        return true;
+    }
+    if (value >= n) {
+        int phi = value - n;
+        if (ssa->phis[phi].block != loop->header) {
+            if (loop_contains(loop, ssa->phis[phi].block) || !sym) return false;
+            rec_sym(&out->rec, sym);
+            return true;
+        }
+        if (phi == ev->target) {
+            out->self = 1;
+            rec_const(&out->rec, 0);
+            return true;
+        }
+        if (!scev->phi_known[phi - scev->phi_start]) return false;
+        out->rec = scev->phi_recs[phi - scev->phi_start];
+        return true;
+    }
+    if (!loop_contains(loop, cfg->block_of[value])) {
+        if (!sym) return false;
+        rec_sym(&out->rec, sym);
+        return true;
+    }
+
+    IRCode *code = &cfg->list->codes[cfg->start + value];
+    SCEVTerm a, b;
+    switch (code->op) {
+        case IR_LOAD:
+        case IR_STORE:
+            return scev_eval_operand(ev, value, 0, out);
+
+        case IR_UMINUS: {
+            SCEVRec zero;
+            rec_const(&zero, 0);
+            if (!scev_eval_operand(ev, value, 0, &a)) return false;
+            out->self = -a.self;
+            return rec_add(&out->rec, &zero, &a.rec, -1);
+        }
+
+        case IR_ADD:
+        case IR_SUB: {
+            int sign = code->op == IR_ADD ? 1 : -1;
+            if (!scev_eval_operand(ev, value, 0, &a) || !scev_eval_operand(ev, value, 1, &b)) return false;
+            out->self = a.self + sign * b.self;
+            return rec_add(&out->rec, &a.rec, &b.rec, sign);
+        }
+
+        case IR_MUL:
+            if (!scev_eval_operand(ev, value, 0, &a) || !scev_eval_operand(ev, value, 1, &b)) return false;
+            if (b.self != 0) {
+                SCEVTerm tmp = a;
+                a = b;
+                b = tmp;
+            }
+            if (b.self != 0) return false;
+            if (a.self != 0) {
+                // phi * k sólo con k constante
+                if (b.rec.degree != 0 || !scev_affine_is_constant(&b.rec.coefs[0]) ||
+                    !fits_int(b.rec.coefs[0].constant)) return false;
+                out->self = a.self * (int)b.rec.coefs[0].constant;
+            }
+            return rec_mul(&out->rec, &a.rec, &b.rec);
+
+        default:
+            return false;
+    }
+}
+
+/*
+ * Si en todas las entradas al loop la variable recibe la misma constante, el
+ * valor inicial es esa constante en lugar del símbolo.
+ */
+static void scev_initial_constant(LoopSCEV *scev, int phi, SCEVAffine *initial) {
+    CFG *cfg = scev->nest->cfg;
+    SSAGraph *ssa = scev->nest->ssa;
+    Loop *loop = &scev->nest->loops[scev->loop];
+    BasicBlock *header = &cfg->blocks[loop->header];
+    bool found = false;
+    long long value = 0;
+
+    for (int p = 0; p < header->num_preds; p++) {
+        if (loop_contains(loop, header->preds[p])) continue;
+        int arg = ssa->phis[phi].args[p];
+        if (arg < 0 || arg >= ssa->num_instrs) return;
+        IRCode *code = &cfg->list->codes[cfg->start + arg];
+        if (code->op != IR_STORE || !is_constant_symbol(code->arg1)) return;
+        if (found && get_constant_value(code->arg1) != value) return;
+        value = get_constant_value(code->arg1);
+        found = true;
+    }
+    if (found) affine_const(initial, value);
+}
+
+/*
+ * Resuelve la phi del header si su valor en los latches es phi + D.
+ */
+static bool scev_solve_phi(LoopSCEV *scev, int phi) {
+    CFG *cfg = scev->nest->cfg;
+    SSAGraph *ssa = scev->nest->ssa;
+    Loop *loop = &scev->nest->loops[scev->loop];
+    BasicBlock *header = &cfg->blocks[loop->header];
+    int index = phi - scev->phi_start;
+    if (!scev->phi_syms[index]) return false;
+
+    int latch_value = SSA_CLOBBER;
+    for (int p = 0; p < header->num_preds; p++) {
+        if (!loop_contains(loop, header->preds[p])) continue;
+        int arg = ssa->phis[phi].args[p];
+        if (latch_value != SSA_CLOBBER && arg != latch_value) return false;
+        latch_value = arg;
+    }
+    if (latch_value == SSA_CLOBBER) return false;
+
+    SCEVEval ev = {scev, phi, SCEV_EVAL_BUDGET};
+    SCEVTerm step;
+    if (!scev_eval_value(&ev, latch_value, scev->phi_syms[index], &step) || step.self != 1 ||
+        step.rec.degree + 1 > SCEV_MAX_DEGREE) return false;
+
+    SCEVRec *rec = &scev->phi_recs[index];
+    rec->degree = step.rec.degree + 1;
+    affine_sym(&rec->coefs[0], scev->phi_syms[index]);
+    scev_initial_constant(scev, phi, &rec->coefs[0]);
+    for (int i = 0; i <= step.rec.degree; i++) rec->coefs[i + 1] = step.rec.coefs[i];
+    rec_normalize(rec);
+    scev->phi_known[index] = true;
+    return true;
+}
+
+/*
+ * Cantidad de iteraciones: la única salida del loop tiene que ser el salto
+ * fusionado al final del header, contra una diferencia lineal de paso constante.
+ */
+static void scev_trip_count(LoopSCEV *scev) {
+    CFG *cfg = scev->nest->cfg;
+    Loop *loop = &scev->nest->loops[scev->loop];
+    BasicBlock *header = &cfg->blocks[loop->header];
+    IRCode *branch = &cfg->list->codes[header->end - 1];
+    if (branch->op < IR_IF_EQ || branch->op > IR_IF_GE || header->num_succs != 2) return;
+
+    for (int k = 0; k < loop->num_blocks; k++) {
+        BasicBlock *bb = &cfg->blocks[loop->blocks[k]];
+        if (loop->blocks[k] == loop->header) continue;
+        for (int s = 0; s < bb->num_succs; s++) {
+            if (!loop_contains(loop, bb->succs[s])) return;
+        }
+    }
+
+    // succs[0] es la caída y succs[1] el destino del salto
+    IRInstr exit_op;
+    bool fall_inside = loop_contains(loop, header->succs[0]);
+    bool jump_inside = loop_contains(loop, header->succs[1]);
+    if (fall_inside == jump_inside) return;
+    if (fall_inside) {
+        exit_op = branch->op;
+        scev->exit_block = header->succs[1];
+    } else {
+        exit_op = negate_branch_op(branch->op);
+        scev->exit_block = header->succs[0];
+    }
+
+    int rel = header->end - 1 - cfg->start;
+    SCEVEval ev = {scev, -1, SCEV_EVAL_BUDGET};
+    SCEVTerm x, y;
+    if (!scev_eval_operand(&ev, rel, 0, &x) || !scev_eval_operand(&ev, rel, 1, &y)) return;
+
+    // Se sale en la primera iteración en que e >= 0
+    SCEVRec e;
+    SCEVRec one;
+    rec_const(&one, 1);
+    switch (exit_op) {
+        case IR_IF_GE:
+            if (!rec_add(&e, &x.rec, &y.rec, -1)) return;
+            break;
+        case IR_IF_GT:
+            if (!rec_add(&e, &x.rec, &y.rec, -1) || !rec_add(&e, &e, &one, -1)) return;
+            break;
+        case IR_IF_LE:
+            if (!rec_add(&e, &y.rec, &x.rec, -1)) return;
+            break;
+        case IR_IF_LT:
+            if (!rec_add(&e, &y.rec, &x.rec, -1) || !rec_add(&e, &e, &one, -1)) return;
+            break;
+        default:
+            return;
+    }
+    if (e.degree != 1 || !scev_affine_is_constant(&e.coefs[1]) || e.coefs[1].constant <= 0) return;
+
+    scev->has_trip_count = true;
+    scev->trip_start = e.coefs[0];
+    scev->trip_step = e.coefs[1].constant;
+    scev->exit_branch = rel;
+}
+
+bool scev_analyze_loop(LoopSCEV *scev, LoopNest *nest, int loop_index) {
+    CFG *cfg = nest->cfg;
+    SSAGraph *ssa = nest->ssa;
+    Loop *loop = &nest->loops[loop_index];
+
+    memset(scev, 0, sizeof(LoopSCEV));
+    scev->nest = nest;
+    scev->loop = loop_index;
+    scev->phi_start = ssa->block_phi_start[loop->header];
+    scev->phi_end = ssa->block_phi_start[loop->header + 1];
+    scev->exit_branch = -1;
+    scev->exit_block = -1;
+    int num_phis = scev->phi_end - scev->phi_start;
+    scev->phi_recs = df_alloc(num_phis, sizeof(SCEVRec));
+    scev->phi_known = df_alloc(num_phis, sizeof(bool));
+    scev->phi_syms = df_alloc(num_phis, sizeof(IRSymbol *));
+
+    // Símbolo de cada phi, tomado de una definición dentro del loop
+    for (int k = 0; k < loop->num_blocks; k++) {
+        BasicBlock *bb = &cfg->blocks[loop->blocks[k]];
+        for (int i = bb->start; i < bb->end; i++) {
+            int def = cfg->def_of[i - cfg->start];
+            if (def < 0) continue;
+            for (int p = 0; p < num_phis; p++) {
+                if (ssa->phis[scev->phi_start + p].sym == def) scev->phi_syms[p] = cfg->list->codes[i].result;
+            }
+        }
+    }
+
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (int p = 0; p < num_phis; p++) {
+            if (!scev->phi_known[p] && scev_solve_phi(scev, scev->phi_start + p)) progress = true;
+        }
+    }
+
+    scev_trip_count(scev);
+    return scev->has_trip_count;
+}
+
+void scev_free(LoopSCEV *scev) {
+    free(scev->phi_recs);
+    free(scev->phi_known);
+    free(scev->phi_syms);
+    scev->phi_recs = NULL;
+    scev->phi_known = NULL;
+    scev->phi_syms = NULL;
+}
+
+/*
+ * Recurrencia de un valor SSA (instrucción relativa o n + phi) dentro del loop.
+ */
+bool scev_value(LoopSCEV *scev, int value, SCEVRec *out) {
+    SCEVEval ev = {scev, -1, SCEV_EVAL_BUDGET};
+    SCEVTerm term;
+    if (!scev_eval_value(&ev, value, NULL, &term)) return false;
+    *out = term.rec;
+    return true;
+}
+
+void scev_print_affine(FILE *out, SCEVAffine *a) {
+    bool first = true;
+    for (int i = 0; i < a->num_terms; i++) {
+        long long k = a->coefs[i];
+        if (!first) fprintf(out, k < 0 ? " - " : " + ");
+        else if (k < 0) fprintf(out, "-");
+        if (k != 1 && k != -1) fprintf(out, "%lld*", k < 0 ? -k : k);
+        fprintf(out, "%s", a->syms[i]->name);
+        first = false;
+    }
+    if (first) fprintf(out, "%lld", a->constant);
+    else if (a->constant != 0) fprintf(out, a->constant < 0 ? " - %lld" : " + %lld",
+                                       a->constant < 0 ? -a->constant : a->constant);
+}
+
+void scev_print_rec(FILE *out, SCEVRec *rec) {
+    fprintf(out, "{");
+    for (int i = 0; i <= rec->degree; i++) {
+        if (i > 0) fprintf(out, ", +, ");
+        scev_print_affine(out, &rec->coefs[i]);
+    }
+    fprintf(out, "}");
+}
+
+/*
+ * Reemplazo por forma cerrada.
+ *
+ * Un loop interno cuyo cuerpo sólo hace aritmética sobre variables modeladas se
+ * reemplaza por el cálculo directo de los valores finales. Con N iteraciones, la
+ * phi {c0, +, c1, +, c2} termina valiendo c0 + c1 * N + c2 * C(N, 2). C(N, 2) se
+ * calcula como (N / 2) * (N - 1 + N % 2), que no pierde el bit alto al dividir.
+ * N = (E < 0) * ceil(-E / paso) no necesita saltos, así que el código que queda
+ * es lineal y el loop que lo contiene puede reemplazarse en la ronda siguiente.
+ */
+typedef struct {
+    LoopEditor *ed;
+    int pos;
+} SCEVEmitter;
+
+static IRSymbol *emit_const(long long value) {
+    return new_const_symbol((int)value, 0);
+}
+
+static IRSymbol *emit_binary(SCEVEmitter *em, IRInstr op, IRSymbol *a, IRSymbol *b) {
+    bool ca = is_constant_symbol(a), cb = is_constant_symbol(b);
+    long long x = ca ? get_constant_value(a) : 0, y = cb ? get_constant_value(b) : 0;
+    if (ca && cb) {
+        long long value = op == IR_ADD ? x + y : op == IR_SUB ? x - y : op == IR_MUL ? x * y : 0;
+        if ((op == IR_ADD || op == IR_SUB || op == IR_MUL) && fits_int(value)) return emit_const(value);
+    }
+    if ((op == IR_ADD || op == IR_SUB) && cb && y == 0) return a;
+    if (op == IR_ADD && ca && x == 0) return b;
+    if (op == IR_MUL && ((ca && x == 0) || (cb && y == 0))) return emit_const(0);
+    if (op == IR_MUL && cb && y == 1) return a;
+    if (op == IR_MUL && ca && x == 1) return b;
+
+    IRSymbol *result = new_temp_symbol();
+    loop_editor_insert_after(em->ed, em->pos, (IRCode){op, a, b, result});
+    return result;
+}
+
+// Los términos positivos se suman y los negativos se restan
+static IRSymbol *emit_affine(SCEVEmitter *em, SCEVAffine *a) {
+    IRSymbol *acc = NULL;
+    for (int i = 0; i < a->num_terms; i++) {
+        if (a->coefs[i] < 0) continue;
+        IRSymbol *term = emit_binary(em, IR_MUL, a->syms[i], emit_const(a->coefs[i]));
+        acc = acc ? emit_binary(em, IR_ADD, acc, term) : term;
+    }
+    if (!acc) acc = emit_const(a->constant);
+    else acc = emit_binary(em, IR_ADD, acc, emit_const(a->constant));
+    for (int i = 0; i < a->num_terms; i++) {
+        if (a->coefs[i] >= 0) continue;
+        IRSymbol *term = emit_binary(em, IR_MUL, a->syms[i], emit_const(-a->coefs[i]));
+        acc = emit_binary(em, IR_SUB, acc, term);
+    }
+    return acc;
+}
+
+static bool affine_fits(SCEVAffine *a) {
+    if (!fits_int(a->constant)) return false;
+    for (int i = 0; i < a->num_terms; i++) {
+        if (!fits_int(a->coefs[i]) || !fits_int(-a->coefs[i])) return false;
+    }
+    return true;
+}
+
+/*
+ * El cuerpo sólo tiene aritmética modelable, los temporales no se usan fuera del
+ * loop y cada variable que se escribe tiene su phi resuelta (o no se lee en
+ * otro bloque, así que su valor no sale del loop).
+ */
+static bool closed_form_candidate(LoopSCEV *scev) {
+    LoopNest *nest = scev->nest;
+    CFG *cfg = nest->cfg;
+    SSAGraph *ssa = nest->ssa;
+    Loop *loop = &nest->loops[scev->loop];
+    int n = ssa->num_instrs;
+
+    if (!scev->has_trip_count || !affine_fits(&scev->trip_start) || !fits_int(scev->trip_step)) return false;
+    if (scev_affine_is_constant(&scev->trip_start) && scev->trip_start.constant < 0 &&
+        !fits_int((-scev->trip_start.constant + scev->trip_step - 1) / scev->trip_step)) return false;
+    for (int b = loop->header; b < loop->header + loop->num_blocks; b++) {
+        if (b >= cfg->num_blocks || !loop_contains(loop, b)) return false;
+    }
+    for (int p = 0; p < scev->phi_end - scev->phi_start; p++) {
+        if (!scev->phi_known[p]) return false;
+        for (int i = 0; i <= scev->phi_recs[p].degree; i++) {
+            if (!affine_fits(&scev->phi_recs[p].coefs[i])) return false;
+        }
+    }
+
+    int first = cfg->blocks[loop->header].start - cfg->start;
+    int last = cfg->blocks[loop->header + loop->num_blocks - 1].end - cfg->start;
+    for (int rel = first; rel < last; rel++) {
+        IRCode *code = &cfg->list->codes[cfg->start + rel];
+        switch (code->op) {
+            case IR_LABEL:
+            case IR_GOTO:
+            case IR_LOAD:
+            case IR_ADD:
+            case IR_SUB:
+            case IR_MUL:
+            case IR_UMINUS:
+                break;
+            case IR_STORE: {
+                int sym = cfg->def_of[rel];
+                if (cfg->sym_bit[sym] < 0) break;
+                bool found = false;
+                for (int p = scev->phi_start; p < scev->phi_end && !found; p++) {
+                    found = ssa->phis[p].sym == sym;
+                }
+                if (!found) return false;
+                break;
+            }
+            default:
+                if (rel != scev->exit_branch) return false;
+        }
+        if (code->result && code->result->type == IR_SYM_TEMP) {
+            for (int u = ssa->user_start[rel]; u < ssa->user_start[rel + 1]; u++) {
+                int user = ssa->users[u];
+                int block = user < n ? cfg->block_of[user] : ssa->phis[user - n].block;
+                if (!loop_contains(loop, block)) return false;
+            }
+        }
+    }
+
+    int exit = scev->exit_block;
+    IRCode *exit_first = &cfg->list->codes[cfg->blocks[exit].start];
+    return exit == loop->header + loop->num_blocks || (exit_first->op == IR_LABEL && exit_first->result);
+}
+
+static bool closed_form_loop(LoopEditor *ed, int loop_index) {
+    LoopNest *nest = ed->nest;
+    CFG *cfg = nest->cfg;
+    Loop *loop = &nest->loops[loop_index];
+    LoopSCEV scev;
+    scev_analyze_loop(&scev, nest, loop_index);
+    if (!closed_form_candidate(&scev)) {
+        scev_free(&scev);
+        return false;
+    }
+
+    // El loop completo se reemplaza por código detrás de la etiqueta del header
+    int first = cfg->blocks[loop->header].start - cfg->start;
+    int last = cfg->blocks[loop->header + loop->num_blocks - 1].end - cfg->start;
+    for (int rel = first + 1; rel < last; rel++) loop_editor_remove(ed, rel);
+    SCEVEmitter em = {ed, first};
+
+    // N = (-E > 0) * ceil(-E / paso)
+    IRSymbol *trips;
+    SCEVAffine remaining = scev.trip_start;
+    affine_scale(&remaining, -1);
+    IRSymbol *distance = emit_affine(&em, &remaining);
+    long long step = scev.trip_step;
+    if (is_constant_symbol(distance)) {
+        long long d = get_constant_value(distance);
+        trips = emit_const(d <= 0 ? 0 : (d + step - 1) / step);
+    } else {
+        IRSymbol *count = distance;
+        if (step > 1) {
+            count = emit_binary(&em, IR_ADD, count, emit_const(step - 1));
+            count = emit_binary(&em, IR_DIV, count, emit_const(step));
+        }
+        IRSymbol *runs = new_temp_symbol();
+        runs->data_type = TYPE_BOOL;
+        loop_editor_insert_after(ed, first, (IRCode){IR_GT, distance, emit_const(0), runs});
+        trips = emit_binary(&em, IR_MUL, runs, count);
+    }
+
+    IRSymbol *pairs = NULL;
+    int num_phis = scev.phi_end - scev.phi_start;
+    for (int p = 0; p < num_phis; p++) {
+        if (scev.phi_recs[p].degree < 2) continue;
+        if (is_constant_symbol(trips)) {
+            long long t = get_constant_value(trips);
+            pairs = fits_int(t * (t - 1) / 2) ? emit_const(t * (t - 1) / 2) : NULL;
+        }
+        if (!pairs) {
+            IRSymbol *half = emit_binary(&em, IR_DIV, trips, emit_const(2));
+            IRSymbol *odd = emit_binary(&em, IR_MOD, trips, emit_const(2));
+            IRSymbol *other = emit_binary(&em, IR_SUB, emit_binary(&em, IR_ADD, trips, odd), emit_const(1));
+            pairs = emit_binary(&em, IR_MUL, half, other);
+        }
+        break;
+    }
+
+    // Primero se calculan todos los valores finales y después se guardan
+    IRSymbol **finals = calloc(num_phis > 0 ? num_phis : 1, sizeof(IRSymbol *));
+    for (int p = 0; p < num_phis; p++) {
+        SCEVRec *rec = &scev.phi_recs[p];
+        IRSymbol *value = emit_affine(&em, &rec->coefs[0]);
+        if (rec->degree >= 1) {
+            value = emit_binary(&em, IR_ADD, value, emit_binary(&em, IR_MUL, emit_affine(&em, &rec->coefs[1]), trips));
+        }
+        if (rec->degree >= 2) {
+            value = emit_binary(&em, IR_ADD, value, emit_binary(&em, IR_MUL, emit_affine(&em, &rec->coefs[2]), pairs));
+        }
+        if (value->type == IR_SYM_VAR && value != scev.phi_syms[p]) {
+            IRSymbol *copy = new_temp_symbol();
+            loop_editor_insert_after(ed, first, (IRCode){IR_LOAD, value, NULL, copy});
+            value = copy;
+        }
+        finals[p] = value;
+    }
+    for (int p = 0; p < num_phis; p++) {
+        if (finals[p] == scev.phi_syms[p] || scev.phi_syms[p]->type != IR_SYM_VAR) continue;
+        loop_editor_insert_after(ed, first, (IRCode){IR_STORE, finals[p], NULL, scev.phi_syms[p]});
+    }
+
+    if (scev.exit_block != loop->header + loop->num_blocks) {
+        IRSymbol *exit_label = cfg->list->codes[cfg->blocks[scev.exit_block].start].result;
+        loop_editor_insert_after(ed, first, (IRCode){IR_GOTO, NULL, NULL, exit_label});
+    }
+
+    if (debug_mode) {
+        printf("  [SCEV] Línea %d: loop de max(0, ceil(-(", cfg->start + first);
+        scev_print_affine(stdout, &scev.trip_start);
+        printf(") / %lld)) iteraciones reemplazado por su forma cerrada\n", step);
+        for (int p = 0; p < num_phis; p++) {
+            printf("           %s = ", scev.phi_syms[p]->name);
+            scev_print_rec(stdout, &scev.phi_recs[p]);
+            printf("\n");
+        }
+    }
+
+    free(finals);
+    scev_free(&scev);
+    return true;
+}
+
+/*
+ * Loops internos de la función que empieza en start reemplazados en una ronda.
+ */
+static int closed_form_function(IRList *list, int start, int *end, int *count) {
+    CFG cfg;
+    SSAGraph ssa;
+    LoopNest nest;
+    cfg_build(&cfg, list, start);
+    ssa_build(&ssa, &cfg);
+    loop_nest_build(&nest, &cfg, &ssa);
+
+    int replaced = 0;
+    *end = cfg.end;
+    if (nest.num_loops > 0) {
+        bool *has_inner = df_alloc(nest.num_loops, sizeof(bool));
+        for (int l = 0; l < nest.num_loops; l++) {
+            if (nest.loops[l].parent >= 0) has_inner[nest.loops[l].parent] = true;
+        }
+        LoopEditor ed;
+        loop_editor_init(&ed, &nest);
+        for (int l = 0; l < nest.num_loops; l++) {
+            if (!has_inner[l] && closed_form_loop(&ed, l)) replaced++;
+        }
+        *end = loop_editor_apply(&ed);
+        loop_editor_free(&ed);
+        free(has_inner);
+    }
+
+    loop_nest_free(&nest);
+    ssa_free(&ssa);
+    cfg_free(&cfg);
+    *count += replaced;
+    return replaced;
+}
+
+void optimize_loop_closed_forms(IRList *list) {
+    int count = 0;
+
+    for (int start = 0; start < list->size; start++) {
+        if (list->codes[start].op != IR_METHOD) continue;
+        int end;
+        // Al reemplazar un loop interno, el que lo contiene puede quedar modelable
+        for (int round = 0; round < 4 && closed_form_function(list, start, &end, &count) > 0; round++);
+        start = end - 1;
+    }
+
+    if (count > 0 && debug_mode) {
+        printf("✓ Evolución escalar: %d loops reemplazados por su forma cerrada\n", count);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef SCEV_H
+#define SCEV_H
+
+#include "intermediate.h"
+#include "dataflow.h"
+#include "loops.h"
+#include <stdio.h>
+
+#define SCEV_MAX_TERMS  4
+#define SCEV_MAX_DEGREE 2
+
+/*
+ * Expresión afín sobre valores invariantes del loop:
+ * constant + coefs[0] * syms[0] + ... Los símbolos se leen en el preheader.
+ */
+typedef struct {
+    long long constant;
+    int num_terms;
+    IRSymbol *syms[SCEV_MAX_TERMS];
+    long long coefs[SCEV_MAX_TERMS];
+} SCEVAffine;
+
+/*
+ * Recurrencia de suma {c0, +, c1, +, c2}: el valor en la iteración j es
+ * c0 + c1 * C(j, 1) + c2 * C(j, 2).
+ */
+typedef struct {
+    int degree;
+    SCEVAffine coefs[SCEV_MAX_DEGREE + 1];
+} SCEVRec;
+
+/*
+ * Evolución escalar de un loop: la recurrencia de cada phi del header que se
+ * pudo modelar y, si la única salida es el salto del header contra una
+ * recurrencia lineal de paso constante, la cantidad de iteraciones:
+ *   N = max(0, ceil(-trip_start / trip_step))
+ */
+typedef struct {
+    LoopNest *nest;
+    int loop;
+    int phi_start;              // Phis del header (índices del SSAGraph)
+    int phi_end;
+    SCEVRec *phi_recs;
+    bool *phi_known;
+    IRSymbol **phi_syms;        // Símbolo de cada phi
+    bool has_trip_count;
+    SCEVAffine trip_start;
+    long long trip_step;
+    int exit_branch;            // Instrucción (relativa) del salto de salida
+    int exit_block;
+} LoopSCEV;
+
+bool scev_analyze_loop(LoopSCEV *scev, LoopNest *nest, int loop);
+void scev_free(LoopSCEV *scev);
+bool scev_value(LoopSCEV *scev, int value, SCEVRec *out);
+bool scev_affine_is_constant(SCEVAffine *a);
+void scev_print_affine(FILE *out, SCEVAffine *a);
+void scev_print_rec(FILE *out, SCEVRec *rec);
+
+/*
+ * Reemplazo de loops por la forma cerrada de sus valores finales
+ */
+void optimize_loop_closed_forms(IRList *list);
+
+#endif
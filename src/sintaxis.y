@@ -24,6 +24,15 @@ int yylex(void);
 Nodo *ast = NULL;
 int debug_mode = 0;
 int optimizer_enabled = 0;
+int time_passes = 0;
+int unroll_factor = 4;
+int unswitch_budget = 256;
+int inline_threshold = 16;
+int memoize_enabled = 0;
+int peval_enabled = 0;
+int dump_callgraph = 0;
+int specialize_clones = 4;
+long eval_steps = 1000000;
 typedef enum {
     TARGET_SEMANTIC,    // Hasta análisis semántico (incluye AST + optimizaciones)
     TARGET_IR,          // Hasta código intermedio
@@ -377,6 +386,54 @@ int main(int argc, char **argv) {
             debug_mode = 1;
         } else if (strcmp(argv[i], "-optimizer") == 0) {
             optimizer_enabled = 1;
+        } else if (strcmp(argv[i], "-time-passes") == 0) {
+            time_passes = 1;
+        } else if (strcmp(argv[i], "-unroll-factor") == 0) {
+            if (i + 1 < argc) {
+                i++;
+                unroll_factor = atoi(argv[i]);
+            } else {
+                fprintf(stderr, "Error: -unroll-factor requiere un número (1 desactiva el desenrollado)\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-unswitch-budget") == 0) {
+            if (i + 1 < argc) {
+                i++;
+                unswitch_budget = atoi(argv[i]);
+            } else {
+                fprintf(stderr, "Error: -unswitch-budget requiere un número de instrucciones (0 desactiva el unswitching)\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-inline-threshold") == 0) {
+            if (i + 1 < argc) {
+                i++;
+                inline_threshold = atoi(argv[i]);
+            } else {
+                fprintf(stderr, "Error: -inline-threshold requiere un número (0 desactiva el inlining)\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-specialize-clones") == 0) {
+            if (i + 1 < argc) {
+                i++;
+                specialize_clones = atoi(argv[i]);
+            } else {
+                fprintf(stderr, "Error: -specialize-clones requiere un número (0 desactiva la especialización)\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-eval-steps") == 0) {
+            if (i + 1 < argc) {
+                i++;
+                eval_steps = atol(argv[i]);
+            } else {
+                fprintf(stderr, "Error: -eval-steps requiere un número (0 desactiva la evaluación en compilación)\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-memoize") == 0) {
+            memoize_enabled = 1;
+        } else if (strcmp(argv[i], "-peval") == 0) {
+            peval_enabled = 1;
+        } else if (strcmp(argv[i], "-dump-callgraph") == 0) {
+            dump_callgraph = 1;
         } else if (strcmp(argv[i], "-target") == 0) {
             if (i + 1 < argc) {
                 i++; // Avanzar al siguiente argumento
@@ -0,0 +1,288 @@
+#include "specialize.h"
+#include "optimizer.h"
+#include "dataflow.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Especialización de funciones por argumentos constantes.
+ *
+ * Las llamadas a un método del programa se agrupan por la tupla de argumentos
+ * constantes que pasan ("_,10" es el segundo parámetro fijo en 10). Para cada
+ * tupla se arma un clon del método sin esos parámetros, que los inicializa con
+ * un STORE de la constante, y se le aplican plegado de constantes, SCCP y DCE
+ * por separado. La ganancia es la diferencia de tamaño con el cuerpo original:
+ * cálculos plegados y ramas que SCCP descarta por un salto resuelto.
+ *
+ * Las tuplas que ganan al menos SPECIALIZE_MIN_GAIN instrucciones y
+ * SPECIALIZE_MIN_PERCENT del cuerpo son candidatas; de cada función se
+ * especializan las de mayor ganancia por llamada, hasta specialize_clones. El
+ * clon ya optimizado se inserta después del original con el nombre "f.specN",
+ * sus llamadas dejan de pasar los argumentos constantes y el original queda
+ * para el resto de las llamadas.
+ *
+ * Corre antes del inlining: un clon que quedó chico se puede inlinear después.
+ */
+
+typedef struct {
+    const char *name;
+    int start;
+    int end;
+    IRSymbol **params;
+    int num_params;
+    int size;               // Instrucciones del cuerpo (sin METHOD, PARAM ni etiquetas)
+    int clones;
+} SpecFunc;
+
+typedef struct {
+    int callee;
+    char key[256];          // Constantes de la tupla, "_" en los parámetros libres
+    IRSymbol **consts;      // Por parámetro: la constante, o NULL
+    int *sites;             // CALL de cada llamada
+    int *args;              // CALL_PARAM de cada llamada, num_params por llamada
+    int num_sites;
+    int number;             // N del nombre "f.specN"
+    IRList clone;           // Clon optimizado, vacío si no se evaluó
+    int gain;
+} SpecCandidate;
+
+/*
+ * Arma el clon de la función para la tupla (todavía con el nombre del original)
+ * y lo optimiza aparte. Los pases corren en silencio: sólo interesa el tamaño
+ * que queda.
+ */
+static void build_clone(IRList *list, SpecFunc *f, SpecCandidate *c, IRSymbol *name) {
+    IRCode *codes = list->codes;
+    ir_init(&c->clone);
+    ir_emit(&c->clone, IR_METHOD, NULL, NULL, name);
+    for (int k = 0; k < f->num_params; k++) {
+        if (!c->consts[k]) ir_emit(&c->clone, IR_PARAM, NULL, NULL, f->params[k]);
+    }
+    for (int k = 0; k < f->num_params; k++) {
+        if (c->consts[k]) ir_emit(&c->clone, IR_STORE, c->consts[k], NULL, f->params[k]);
+    }
+
+    // Las variables viven en el frame del clon: sólo se copian temporales y etiquetas
+    IRRenamer r;
+    ir_renamer_init(&r, 3 * (f->end - f->start), -1);
+    for (int i = f->start + 1 + f->num_params; i < f->end; i++) {
+        IRCode *code = &codes[i];
+        if (ir_is_nop(code)) continue;
+        ir_emit(&c->clone, code->op, ir_rename_operand(&r, code->arg1),
+                ir_rename_operand(&r, code->arg2), ir_rename_operand(&r, code->result));
+    }
+    ir_renamer_free(&r);
+
+    int saved_debug = debug_mode;
+    debug_mode = 0;
+    optimize_constant_folding(&c->clone);
+    optimize_constant_propagation(&c->clone);
+    optimize_constant_folding(&c->clone);
+    optimize_dead_code_elimination(&c->clone);
+    debug_mode = saved_debug;
+
+    c->gain = f->size - ir_body_size(c->clone.codes, 0, c->clone.size);
+}
+
+static void describe(SpecFunc *f, SpecCandidate *c, char *buf, size_t size) {
+    snprintf(buf, size, "%s(%s)", f->name, c->key);
+}
+
+/*
+ * Agrega la llamada en pos a la tupla que le corresponde.
+ */
+static void add_site(SpecCandidate **cands, int *num_cands, int *capacity, SpecFunc *callee, int callee_index,
+                     IRCode *codes, int pos, int *args) {
+    char key[256] = "";
+    size_t len = 0;
+    bool any_const = false;
+    for (int k = 0; k < callee->num_params; k++) {
+        IRSymbol *arg = codes[args[k]].arg1;
+        const char *part = is_constant_symbol(arg) ? arg->name : "_";
+        if (is_constant_symbol(arg)) any_const = true;
+        int written = snprintf(key + len, sizeof(key) - len, "%s%s", k > 0 ? "," : "", part);
+        if (written < 0 || len + written >= sizeof(key)) return;
+        len += written;
+    }
+    if (!any_const) return;
+
+    SpecCandidate *c = NULL;
+    for (int k = 0; k < *num_cands && !c; k++) {
+        if ((*cands)[k].callee == callee_index && strcmp((*cands)[k].key, key) == 0) c = &(*cands)[k];
+    }
+    if (!c) {
+        if (*num_cands >= *capacity) {
+            *capacity = *capacity > 0 ? *capacity * 2 : 16;
+            *cands = realloc(*cands, *capacity * sizeof(SpecCandidate));
+            if (!*cands) {
+                fprintf(stderr, "Error: no se pudo asignar memoria para la especialización\n");
+                exit(1);
+            }
+        }
+        c = &(*cands)[(*num_cands)++];
+        memset(c, 0, sizeof(*c));
+        c->callee = callee_index;
+        strcpy(c->key, key);
+        c->consts = df_alloc(callee->num_params, sizeof(IRSymbol *));
+        for (int k = 0; k < callee->num_params; k++) {
+            IRSymbol *arg = codes[args[k]].arg1;
+            if (is_constant_symbol(arg)) c->consts[k] = arg;
+        }
+    }
+    c->sites = realloc(c->sites, (c->num_sites + 1) * sizeof(int));
+    c->args = realloc(c->args, (c->num_sites + 1) * callee->num_params * sizeof(int));
+    if (!c->sites || !c->args) {
+        fprintf(stderr, "Error: no se pudo asignar memoria para la especialización\n");
+        exit(1);
+    }
+    c->sites[c->num_sites] = pos;
+    memcpy(&c->args[c->num_sites * callee->num_params], args, callee->num_params * sizeof(int));
+    c->num_sites++;
+}
+
+static int by_gain_per_call(const void *a, const void *b) {
+    const SpecCandidate *ca = *(SpecCandidate *const *)a;
+    const SpecCandidate *cb = *(SpecCandidate *const *)b;
+    long wa = (long)ca->gain * ca->num_sites, wb = (long)cb->gain * cb->num_sites;
+    return wa < wb ? 1 : wa > wb ? -1 : 0;
+}
+
+static int by_insert_position(const void *a, const void *b) {
+    const SpecCandidate *ca = *(SpecCandidate *const *)a;
+    const SpecCandidate *cb = *(SpecCandidate *const *)b;
+    if (ca->callee != cb->callee) return ca->callee < cb->callee ? 1 : -1;
+    return ca->number < cb->number ? 1 : ca->number > cb->number ? -1 : 0;
+}
+
+void optimize_specialization(IRList *list) {
+    if (specialize_clones <= 0) return;
+
+    SpecFunc *funcs = df_alloc(list->size, sizeof(SpecFunc));
+    int num_funcs = 0;
+    StrMap func_map;
+    strmap_init(&func_map, 16);
+    for (int i = 0; i < list->size; i++) {
+        if (list->codes[i].op != IR_METHOD || !list->codes[i].result) continue;
+        SpecFunc *f = &funcs[num_funcs];
+        f->name = list->codes[i].result->name;
+        f->start = i;
+        f->end = ir_function_end(list, i);
+        f->params = df_alloc(f->end - f->start, sizeof(IRSymbol *));
+        while (i + 1 + f->num_params < f->end && list->codes[i + 1 + f->num_params].op == IR_PARAM) {
+            f->params[f->num_params] = list->codes[i + 1 + f->num_params].result;
+            f->num_params++;
+        }
+        f->size = ir_body_size(list->codes, f->start, f->end);
+        strmap_put(&func_map, f->name, num_funcs++);
+    }
+
+    // Tuplas de argumentos constantes de cada llamada a un método del programa
+    StrMap arities;
+    ir_method_arities(list, &arities);
+    SpecCandidate *cands = NULL;
+    int num_cands = 0, capacity = 0;
+    for (int k = 0; k < num_funcs; k++) {
+        int start = funcs[k].start, n = funcs[k].end - start;
+        int *call_of = df_alloc(n, sizeof(int));
+        int *args = df_alloc(n, sizeof(int));
+        ir_match_call_params(&list->codes[start], n, &arities, call_of);
+        for (int j = 0; j < n; j++) {
+            IRCode *code = &list->codes[start + j];
+            if (code->op != IR_CALL || !code->arg1) continue;
+            int callee = strmap_get(&func_map, code->arg1->name);
+            if (callee < 0 || funcs[callee].num_params == 0 || strcmp(funcs[callee].name, "main") == 0) continue;
+            int num_args = 0;
+            for (int a = 0; a < j; a++) {
+                if (call_of[a] == j) args[num_args++] = start + a;
+            }
+            if (num_args != funcs[callee].num_params) continue;
+            add_site(&cands, &num_cands, &capacity, &funcs[callee], callee, list->codes, start + j, args);
+        }
+        free(call_of);
+        free(args);
+    }
+
+    // Evaluación de cada tupla con su clon optimizado
+    char desc[512];
+    SpecCandidate **order = df_alloc(num_cands, sizeof(SpecCandidate *));
+    int num_order = 0;
+    for (int k = 0; k < num_cands; k++) {
+        SpecCandidate *c = &cands[k];
+        SpecFunc *f = &funcs[c->callee];
+        describe(f, c, desc, sizeof(desc));
+        if (f->size > SPECIALIZE_MAX_BODY) {
+            if (debug_mode) printf("  [SPEC] %s no se especializa (cuerpo de %d instrucciones)\n", desc, f->size);
+            continue;
+        }
+        build_clone(list, f, c, list->codes[f->start].result);
+        if (c->gain < SPECIALIZE_MIN_GAIN || c->gain * 100 < SPECIALIZE_MIN_PERCENT * f->size) {
+            if (debug_mode) {
+                printf("  [SPEC] %s no se especializa (ganancia de %d de %d instrucciones)\n", desc, c->gain, f->size);
+            }
+            ir_free(&c->clone);
+            continue;
+        }
+        order[num_order++] = c;
+    }
+
+    // Las de mayor ganancia por llamada, hasta el límite de cada función
+    qsort(order, num_order, sizeof(SpecCandidate *), by_gain_per_call);
+    int accepted = 0, redirected = 0, growth = 0;
+    for (int k = 0; k < num_order; k++) {
+        SpecCandidate *c = order[k];
+        SpecFunc *f = &funcs[c->callee];
+        describe(f, c, desc, sizeof(desc));
+        if (f->clones >= specialize_clones) {
+            if (debug_mode) printf("  [SPEC] %s no se especializa (límite de %d clones)\n", desc, specialize_clones);
+            ir_free(&c->clone);
+            continue;
+        }
+        c->number = ++f->clones;
+        char name[256];
+        snprintf(name, sizeof(name), "%s.spec%d", f->name, c->number);
+        c->clone.codes[0].result = new_func_symbol(name);
+
+        for (int s = 0; s < c->num_sites; s++) {
+            for (int p = 0; p < f->num_params; p++) {
+                if (c->consts[p]) mark_instruction_as_nop(list, c->args[s * f->num_params + p]);
+            }
+            list->codes[c->sites[s]].arg1 = c->clone.codes[0].result;
+        }
+        accepted++;
+        redirected += c->num_sites;
+        growth += c->clone.size;
+        if (debug_mode) {
+            printf("  [SPEC] %s -> %s: %d -> %d instrucciones, %d llamadas\n", desc, name, f->size,
+                   f->size - c->gain, c->num_sites);
+        }
+        order[accepted - 1] = c;
+    }
+
+    // Los clones van después de su original, de la última función a la primera;
+    // los de una misma función se insertan del último al primero para quedar en orden
+    qsort(order, accepted, sizeof(SpecCandidate *), by_insert_position);
+    for (int k = 0; k < accepted; k++) {
+        SpecFunc *f = &funcs[order[k]->callee];
+        ir_replace_range(list, f->end, f->end, order[k]->clone.codes, order[k]->clone.size);
+        ir_free(&order[k]->clone);
+    }
+    compact_ir_list(list);
+
+    if (accepted > 0 && debug_mode) {
+        printf("✓ Especialización: %d clones para %d llamadas con argumentos constantes, +%d instrucciones\n",
+               accepted, redirected, growth);
+    }
+
+    for (int k = 0; k < num_cands; k++) {
+        free(cands[k].consts);
+        free(cands[k].sites);
+        free(cands[k].args);
+    }
+    free(cands);
+    free(order);
+    for (int k = 0; k < num_funcs; k++) free(funcs[k].params);
+    free(funcs);
+    strmap_free(&func_map);
+    strmap_free(&arities);
+}
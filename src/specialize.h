@@ -0,0 +1,25 @@
+#ifndef SPECIALIZE_H
+#define SPECIALIZE_H
+
+#include "intermediate.h"
+
+/*
+ * Ganancia mínima de un clon: instrucciones que se eliminan del cuerpo al
+ * plegar los parámetros constantes, en total y como porcentaje del cuerpo.
+ */
+#define SPECIALIZE_MIN_GAIN     4
+#define SPECIALIZE_MIN_PERCENT  20
+
+/*
+ * Tamaño máximo del cuerpo de una función que se prueba especializar.
+ */
+#define SPECIALIZE_MAX_BODY     2000
+
+/*
+ * Especialización de funciones: las llamadas con argumentos constantes pasan a
+ * un clon del método con esos parámetros fijos, si al plegarlos el cuerpo se
+ * achica lo suficiente. Cada función tiene a lo sumo -specialize-clones clones.
+ */
+void optimize_specialization(IRList *list);
+
+#endif
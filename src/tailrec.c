@@ -0,0 +1,276 @@
+#include "tailrec.h"
+#include "optimizer.h"
+#include "dataflow.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Eliminación de recursión de cola.
+ *
+ * Una llamada del método a sí mismo está en posición de cola si lo siguiente
+ * que se ejecuta es un RETURN de su resultado (o un RETURN sin valor, o el fin
+ * del método). Esa llamada se reemplaza por una asignación a los parámetros y
+ * un salto a una etiqueta puesta después de los PARAM, así que el método reusa
+ * su stack frame.
+ *
+ * Las recursiones lineales de la forma "return x op f(...)" con op asociativa y
+ * conmutativa (ADD o MUL) se convierten con un acumulador: al entrar se guarda
+ * el neutro de op, cada llamada reemplazada hace acc = acc op x antes del salto
+ * y cada RETURN v del método devuelve acc op v. En "return f(a) + f(b)" se
+ * reemplaza la última llamada y la otra sigue siendo recursiva.
+ *
+ * Los argumentos se leen donde estaba su CALL_PARAM: los que son variables se
+ * copian a un temporal, porque los parámetros se pisan recién al final, en el
+ * lugar de la llamada.
+ */
+
+typedef struct {
+    int call;               // CALL reemplazado
+    int op;                 // ADD/MUL que combina el resultado, -1 si es de cola pura
+    int ret;                // RETURN que deja de ejecutarse, -1 si no hay
+    IRSymbol *other;        // Operando de op que no es el resultado de la llamada
+} TailSite;
+
+static bool is_self_call(IRCode *code, const char *name) {
+    return code->op == IR_CALL && code->arg1 && strcmp(code->arg1->name, name) == 0;
+}
+
+static bool reads_symbol(IRCode *code, IRSymbol *sym) {
+    IRSymbol *uses[2];
+    int count = ir_use_symbols(code, uses);
+    for (int u = 0; u < count; u++) {
+        if (same_symbol(uses[u], sym)) return true;
+    }
+    return false;
+}
+
+/*
+ * Indica si después de la instrucción pos el método termina devolviendo value:
+ * un RETURN de value inmediato, o un RETURN sin valor o el fin del método
+ * pasando sólo por etiquetas. En ret queda el RETURN que sólo se alcanza desde
+ * pos, o -1 si hay una etiqueta en el medio.
+ */
+static bool returns_after(IRCode *codes, int pos, int end, IRSymbol *value, int *ret) {
+    bool crossed_label = false;
+    int j = pos + 1;
+    while (j < end && codes[j].op == IR_LABEL) {
+        if (!ir_is_nop(&codes[j])) crossed_label = true;
+        j++;
+    }
+    *ret = j < end && !crossed_label ? j : -1;
+    if (j == end) return true;
+    if (codes[j].op != IR_RETURN) return false;
+    if (!codes[j].arg1) return true;
+    return !crossed_label && same_symbol(codes[j].arg1, value);
+}
+
+/*
+ * Busca hacia atrás, sin cruzar saltos ni etiquetas, la llamada a sí mismo que
+ * define sym. Devuelve su índice o -1.
+ */
+static int defining_self_call(IRCode *codes, int start, int pos, IRSymbol *sym, const char *name) {
+    if (!sym || sym->type != IR_SYM_TEMP) return -1;
+    for (int j = pos - 1; j > start; j--) {
+        IRCode *code = &codes[j];
+        if (ir_is_nop(code)) continue;
+        if (code->op == IR_LABEL || ir_is_terminator(code)) return -1;
+        if (same_symbol(ir_def_symbol(code), sym)) return is_self_call(code, name) ? j : -1;
+    }
+    return -1;
+}
+
+/*
+ * Sitio con acumulador: "op a, b, r" seguido del RETURN de r, con a o b el
+ * resultado de una llamada a sí mismo que no se lee en el medio. Si los dos
+ * operandos lo son se elige la llamada más cercana.
+ */
+static bool find_accumulator_site(IRCode *codes, int start, int end, int q, const char *name, TailSite *site) {
+    IRCode *code = &codes[q];
+    if (code->op != IR_ADD && code->op != IR_MUL) return false;
+    int ret;
+    if (!returns_after(codes, q, end, code->result, &ret) || ret < 0 || !codes[ret].arg1) return false;
+
+    int c1 = defining_self_call(codes, start, q, code->arg1, name);
+    int c2 = defining_self_call(codes, start, q, code->arg2, name);
+    if (c1 < 0 && c2 < 0) return false;
+    int call = c1 > c2 ? c1 : c2;
+    IRSymbol *result = codes[call].result;
+    IRSymbol *other = call == c1 ? code->arg2 : code->arg1;
+    if (same_symbol(other, result)) return false;
+    for (int j = call + 1; j < q; j++) {
+        if (reads_symbol(&codes[j], result)) return false;
+    }
+    site->call = call;
+    site->op = q;
+    site->ret = ret;
+    site->other = other;
+    return true;
+}
+
+static int emit(IRCode *out, int count, IRInstr op, IRSymbol *arg1, IRSymbol *arg2, IRSymbol *result) {
+    out[count].op = op;
+    out[count].arg1 = arg1;
+    out[count].arg2 = arg2;
+    out[count].result = result;
+    return count + 1;
+}
+
+/*
+ * Transforma la función que empieza en start. Devuelve la posición siguiente a
+ * su última instrucción después del cambio.
+ */
+static int tailrec_function(IRList *list, int start, StrMap *arities, int stats[3]) {
+    int end = ir_function_end(list, start);
+    IRCode *codes = list->codes;
+    const char *name = codes[start].result->name;
+    int n = end - start;
+
+    int first_body = start + 1;
+    while (first_body < end && codes[first_body].op == IR_PARAM) first_body++;
+    int num_params = first_body - start - 1;
+
+    int *call_of = df_alloc(n, sizeof(int));
+    ir_match_call_params(&codes[start], n, arities, call_of);
+    int *num_args = df_alloc(n, sizeof(int));
+    for (int j = 0; j < n; j++) {
+        if (call_of[j] >= 0) num_args[call_of[j]]++;
+    }
+
+    // Sitios: se buscan por la llamada (cola pura) o por el RETURN (acumulador)
+    TailSite *sites = df_alloc(n, sizeof(TailSite));
+    int *site_at = df_alloc(n, sizeof(int));   // Por instrucción: sitio + 1 del CALL, op o RETURN
+    int num_sites = 0;
+    IRInstr acc_op = IR_LABEL;
+    for (int j = first_body; j < end; j++) {
+        TailSite site = {-1, -1, -1, NULL};
+        int ret;
+        if (is_self_call(&codes[j], name) && returns_after(codes, j, end, codes[j].result, &ret)) {
+            site.call = j;
+            site.ret = ret;
+        } else if (find_accumulator_site(codes, start, end, j, name, &site)) {
+            if (acc_op != IR_LABEL && codes[j].op != acc_op) continue;
+        } else {
+            continue;
+        }
+        if (num_args[site.call - start] != num_params || site_at[site.call - start]) continue;
+        if (site.op >= 0) acc_op = codes[site.op].op;
+
+        sites[num_sites] = site;
+        site_at[site.call - start] = num_sites + 1;
+        if (site.op >= 0) site_at[site.op - start] = num_sites + 1;
+        if (site.ret >= 0) site_at[site.ret - start] = num_sites + 1;
+        num_sites++;
+    }
+
+    if (num_sites == 0) {
+        free(call_of);
+        free(num_args);
+        free(sites);
+        free(site_at);
+        return end;
+    }
+
+    IRSymbol **params = df_alloc(num_params, sizeof(IRSymbol *));
+    for (int k = 0; k < num_params; k++) params[k] = codes[start + 1 + k].result;
+    IRSymbol ***args = df_alloc(num_sites, sizeof(IRSymbol **));
+    int *next_arg = df_alloc(num_sites, sizeof(int));
+    for (int s = 0; s < num_sites; s++) args[s] = df_alloc(num_params, sizeof(IRSymbol *));
+
+    IRSymbol *entry = new_label_symbol();
+    IRSymbol *acc = NULL;
+    if (acc_op != IR_LABEL) {
+        char acc_name[256];
+        snprintf(acc_name, sizeof(acc_name), "%s.acc", name);
+        acc = new_var_symbol(acc_name);
+    }
+
+    // Cada sitio agrega a lo sumo acc op x y un STORE por parámetro; cada RETURN, el op
+    IRCode *out = df_alloc(3 * n + (num_params + 4) * num_sites + 4, sizeof(IRCode));
+    int count = 0;
+    for (int j = start; j < first_body; j++) out[count++] = codes[j];
+    if (acc) count = emit(out, count, IR_STORE, new_const_symbol(acc_op == IR_MUL ? 1 : 0, 0), NULL, acc);
+    count = emit(out, count, IR_LABEL, NULL, NULL, entry);
+
+    for (int j = first_body; j < end; j++) {
+        IRCode *code = &codes[j];
+        int s = site_at[j - start] - 1;
+        int call = code->op == IR_CALL_PARAM ? call_of[j - start] : -1;
+        int call_site = call >= 0 ? site_at[call] - 1 : -1;
+
+        if (call_site >= 0 && sites[call_site].call == start + call) {
+            IRSymbol *value = code->arg1;
+            if (value && value->type == IR_SYM_VAR) {
+                IRSymbol *copy = new_temp_symbol();
+                copy->data_type = value->data_type;
+                count = emit(out, count, IR_LOAD, value, NULL, copy);
+                value = copy;
+            }
+            args[call_site][next_arg[call_site]++] = value;
+            continue;
+        }
+
+        if (s >= 0 && (j == sites[s].op || (j == sites[s].call && sites[s].op < 0))) {
+            if (sites[s].op >= 0) {
+                IRSymbol *sum = new_temp_symbol();
+                count = emit(out, count, acc_op, acc, sites[s].other, sum);
+                count = emit(out, count, IR_STORE, sum, NULL, acc);
+            }
+            for (int k = 0; k < num_params; k++) {
+                count = emit(out, count, IR_STORE, args[s][k], NULL, params[k]);
+            }
+            count = emit(out, count, IR_GOTO, NULL, NULL, entry);
+            stats[0]++;
+            if (sites[s].op >= 0) stats[1]++;
+            if (debug_mode) {
+                printf("  [TAILREC] Línea %d: llamada de %s a sí misma convertida en salto%s\n",
+                       sites[s].call, name, sites[s].op >= 0 ? (acc_op == IR_MUL ? " (acumulador *)" : " (acumulador +)") : "");
+            }
+            continue;
+        }
+        if (s >= 0 && (j == sites[s].call || j == sites[s].ret)) continue;
+
+        if (acc && code->op == IR_RETURN && code->arg1) {
+            IRSymbol *result = new_temp_symbol();
+            count = emit(out, count, acc_op, acc, code->arg1, result);
+            count = emit(out, count, IR_RETURN, result, NULL, NULL);
+            continue;
+        }
+        out[count++] = *code;
+    }
+
+    ir_replace_range(list, start, end, out, count);
+    stats[2]++;
+
+    for (int s = 0; s < num_sites; s++) free(args[s]);
+    free(args);
+    free(next_arg);
+    free(params);
+    free(out);
+    free(call_of);
+    free(num_args);
+    free(sites);
+    free(site_at);
+    return start + count;
+}
+
+void optimize_tail_recursion(IRList *list) {
+    int stats[3] = {0, 0, 0};   // Llamadas reemplazadas, con acumulador, funciones
+    StrMap arities;
+    ir_method_arities(list, &arities);
+
+    int i = 0;
+    while (i < list->size) {
+        if (list->codes[i].op == IR_METHOD && list->codes[i].result) {
+            i = tailrec_function(list, i, &arities, stats);
+        } else {
+            i++;
+        }
+    }
+    strmap_free(&arities);
+
+    if (stats[0] > 0 && debug_mode) {
+        printf("✓ Recursión de cola: %d llamadas convertidas en saltos (%d con acumulador) en %d funciones\n",
+               stats[0], stats[1], stats[2]);
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef TAILREC_H
+#define TAILREC_H
+
+#include "intermediate.h"
+
+/*
+ * Eliminación de recursión de cola: las llamadas de un método a sí mismo en
+ * posición de cola, o combinadas con el resultado por una suma o un producto,
+ * se reemplazan por un salto al principio del método.
+ */
+void optimize_tail_recursion(IRList *list);
+
+#endif
@@ -0,0 +1,395 @@
+#include "unroll.h"
+#include "optimizer.h"
+#include "dataflow.h"
+#include "loops.h"
+#include "scev.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Desenrollado de loops.
+ *
+ * Se trabaja sobre loops internos con la forma que genera el frontend: el header
+ * evalúa la condición y sale con el salto fusionado del final, el cuerpo sigue
+ * en bloques contiguos y el único latch termina con GOTO al header. La cantidad
+ * de iteraciones la da la evolución escalar: la salida es la primera iteración
+ * en que E + paso * j >= 0.
+ *
+ * Con N constante y chico el loop se reemplaza por N copias del cuerpo. Si no,
+ * el loop principal repite F copias del cuerpo mientras queden al menos F
+ * iteraciones, lo que se decide con una sola comparación: E(j + F - 1) < 0
+ * desplazando en paso * (F - 1) el operando de la condición. Las iteraciones
+ * que sobran las hace el loop original, que queda a continuación como resto.
+ *
+ * Los temporales que nacen y mueren dentro de una iteración se renombran en cada
+ * copia para que sus intervalos de vida no se alarguen. Como las variables viven
+ * en el stack, dentro del cuerpo desenrollado cada lectura de una variable local
+ * usa directamente el último valor guardado en ella mientras no haya una etiqueta
+ * en el medio: así la cadena de una iteración a la siguiente pasa por registros
+ * y DCE borra los STORE que quedan pisados.
+ */
+
+typedef struct {
+    LoopEditor *ed;
+    CFG *cfg;
+    int pos;                    // Las copias se insertan detrás de esta instrucción
+    bool rename;                // Copia con temporales y etiquetas nuevas
+    bool *renamable;            // Por símbolo: temporal local a una iteración
+    IRSymbol **temp_map;        // Por símbolo: nombre del temporal en la copia actual
+    IRSymbol **labels;          // Etiquetas definidas en el cuerpo
+    IRSymbol **label_map;
+    int num_labels;
+    IRSymbol *header_label;
+    IRSymbol *header_target;    // A dónde van los saltos al header en la copia
+    IRSymbol **known;           // Por variable local: último valor guardado, NULL si no se sabe
+    int *known_src;             // Por variable local: símbolo del CFG de ese valor, -1 si no tiene
+    int *active;                // Variables con valor conocido
+    int num_active;
+} UnrollCopier;
+
+static IRSymbol *copy_operand(UnrollCopier *c, IRSymbol *sym) {
+    if (!sym) return NULL;
+    if (sym->type == IR_SYM_LABEL) {
+        if (c->header_label && strcmp(sym->name, c->header_label->name) == 0) return c->header_target;
+        if (!c->rename) return sym;
+        for (int l = 0; l < c->num_labels; l++) {
+            if (strcmp(sym->name, c->labels[l]->name) != 0) continue;
+            if (!c->label_map[l]) c->label_map[l] = new_label_symbol();
+            return c->label_map[l];
+        }
+        return sym;
+    }
+    if (!c->rename || sym->type != IR_SYM_TEMP) return sym;
+    int index = cfg_sym_index(c->cfg, sym->name);
+    if (index < 0 || !c->renamable[index]) return sym;
+    if (!c->temp_map[index]) {
+        c->temp_map[index] = new_temp_symbol();
+        c->temp_map[index]->data_type = sym->data_type;
+    }
+    return c->temp_map[index];
+}
+
+static void known_reset(UnrollCopier *c) {
+    for (int k = 0; k < c->num_active; k++) c->known[c->active[k]] = NULL;
+    c->num_active = 0;
+}
+
+// Una nueva definición de sym invalida los valores conocidos que lo leían
+static void known_kill(UnrollCopier *c, int sym) {
+    for (int k = 0; k < c->num_active; k++) {
+        int var = c->active[k];
+        if (var != sym && c->known_src[var] != sym) continue;
+        c->known[var] = NULL;
+        c->active[k--] = c->active[--c->num_active];
+    }
+}
+
+static IRSymbol *forward_operand(UnrollCopier *c, IRSymbol *sym) {
+    if (!sym || sym->type != IR_SYM_VAR) return sym;
+    int index = cfg_sym_index(c->cfg, sym->name);
+    return index >= 0 && c->known[index] ? c->known[index] : sym;
+}
+
+static void known_define(UnrollCopier *c, IRCode *copy) {
+    if (copy->op == IR_LABEL) {
+        known_reset(c);
+        return;
+    }
+    IRSymbol *def = ir_def_symbol(copy);
+    if (!def) return;
+    int index = cfg_sym_index(c->cfg, def->name);
+    if (index < 0) return;
+    known_kill(c, index);
+    if (copy->op != IR_STORE || ir_is_global(def->name)) return;
+    IRSymbol *value = copy->arg1;
+    c->known[index] = value;
+    c->known_src[index] = value->type == IR_SYM_CONST ? -1 : cfg_sym_index(c->cfg, value->name);
+    c->active[c->num_active++] = index;
+}
+
+// Empieza una copia nueva: cada una tiene sus propios temporales y etiquetas
+static void copy_begin(UnrollCopier *c, bool rename) {
+    c->rename = rename;
+    if (!rename) return;
+    memset(c->temp_map, 0, c->cfg->num_syms * sizeof(IRSymbol *));
+    memset(c->label_map, 0, (c->num_labels > 0 ? c->num_labels : 1) * sizeof(IRSymbol *));
+}
+
+static void copy_range(UnrollCopier *c, int from, int to) {
+    for (int rel = from; rel < to; rel++) {
+        IRCode *code = &c->cfg->list->codes[c->cfg->start + rel];
+        if (ir_is_nop(code)) continue;
+        IRCode copy = {code->op, copy_operand(c, code->arg1), copy_operand(c, code->arg2),
+                       copy_operand(c, code->result)};
+        if (c->rename) {
+            copy.arg1 = forward_operand(c, copy.arg1);
+            copy.arg2 = forward_operand(c, copy.arg2);
+            known_define(c, &copy);
+        }
+        loop_editor_insert_after(c->ed, c->pos, copy);
+    }
+}
+
+static bool header_op_is_pure(IRInstr op) {
+    switch (op) {
+        case IR_LOAD:
+        case IR_ADD:
+        case IR_SUB:
+        case IR_UMINUS:
+        case IR_MUL:
+        case IR_AND:
+        case IR_OR:
+        case IR_NOT:
+        case IR_EQ:
+        case IR_NEQ:
+        case IR_LT:
+        case IR_LE:
+        case IR_GT:
+        case IR_GE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool value_used_only_in(SSAGraph *ssa, CFG *cfg, int rel, Loop *loop, int block) {
+    int n = ssa->num_instrs;
+    for (int u = ssa->user_start[rel]; u < ssa->user_start[rel + 1]; u++) {
+        int user = ssa->users[u];
+        if (user >= n) return false;
+        if (block >= 0 ? cfg->block_of[user] != block : !loop_contains(loop, cfg->block_of[user])) return false;
+    }
+    return true;
+}
+
+/*
+ * Forma del loop: bloques contiguos, salida sólo por el salto del header hacia
+ * afuera, un único latch al final y un header que sólo calcula la condición.
+ */
+static bool unroll_candidate(LoopSCEV *scev) {
+    LoopNest *nest = scev->nest;
+    CFG *cfg = nest->cfg;
+    Loop *loop = &nest->loops[scev->loop];
+    BasicBlock *header = &cfg->blocks[loop->header];
+
+    if (!scev->has_trip_count || !fits_int(scev->trip_step)) return false;
+    if (loop->num_blocks < 2 || loop->num_latches != 1) return false;
+    for (int b = loop->header; b < loop->header + loop->num_blocks; b++) {
+        if (b >= cfg->num_blocks || !loop_contains(loop, b)) return false;
+    }
+    if (header->succs[0] != loop->header + 1 || scev->exit_block != header->succs[1]) return false;
+
+    int last_block = loop->header + loop->num_blocks - 1;
+    IRCode *latch_jump = &cfg->list->codes[cfg->blocks[last_block].end - 1];
+    if (loop->latches[0] != last_block || latch_jump->op != IR_GOTO) return false;
+
+    IRCode *label = &cfg->list->codes[header->start];
+    if (label->op != IR_LABEL || !label->result) return false;
+    for (int i = header->start + 1; i < header->end - 1; i++) {
+        IRCode *code = &cfg->list->codes[i];
+        if (ir_is_nop(code)) continue;
+        if (!header_op_is_pure(code->op) || !code->result || code->result->type != IR_SYM_TEMP) return false;
+        if (!value_used_only_in(nest->ssa, cfg, i - cfg->start, loop, loop->header)) return false;
+    }
+
+    int exit = scev->exit_block;
+    IRCode *exit_first = &cfg->list->codes[cfg->blocks[exit].start];
+    return exit == last_block + 1 || (exit_first->op == IR_LABEL && exit_first->result);
+}
+
+static int unroll_loop(LoopEditor *ed, int loop_index, bool *renamable, int *budget,
+                       int *full, int *partial) {
+    LoopNest *nest = ed->nest;
+    CFG *cfg = nest->cfg;
+    Loop *loop = &nest->loops[loop_index];
+    LoopSCEV scev;
+    scev_analyze_loop(&scev, nest, loop_index);
+    if (!unroll_candidate(&scev)) {
+        scev_free(&scev);
+        return 0;
+    }
+
+    BasicBlock *header = &cfg->blocks[loop->header];
+    int last_block = loop->header + loop->num_blocks - 1;
+    int first = header->start - cfg->start;
+    int branch = header->end - 1 - cfg->start;
+    int body_first = branch + 1;
+    int latch = cfg->blocks[last_block].end - 1 - cfg->start;
+    int last = latch + 1;
+
+    // Tamaño de una iteración sin contar etiquetas ni el salto de vuelta
+    int body_size = 0, header_size = 0;
+    for (int rel = first; rel < latch; rel++) {
+        IRCode *code = &cfg->list->codes[cfg->start + rel];
+        if (ir_is_nop(code) || code->op == IR_LABEL) continue;
+        if (rel < body_first) header_size++;
+        else body_size++;
+    }
+    if (body_size == 0) {
+        scev_free(&scev);
+        return 0;
+    }
+
+    long long trips = -1;
+    if (scev_affine_is_constant(&scev.trip_start)) {
+        long long e = scev.trip_start.constant;
+        trips = e >= 0 ? 0 : (-e + scev.trip_step - 1) / scev.trip_step;
+    }
+
+    int factor = unroll_factor;
+    bool unroll_full = trips >= 0 && trips <= UNROLL_FULL_MAX_TRIPS &&
+                       trips * body_size <= UNROLL_MAX_BODY && (trips - 1) * body_size <= *budget;
+    if (!unroll_full) {
+        while (factor > 1 && (factor * body_size > UNROLL_MAX_BODY || factor * body_size + header_size + 2 > *budget)) {
+            factor--;
+        }
+        long long shift = scev.trip_step * (factor - 1);
+        if (factor < 2 || (trips >= 0 && trips < factor) || !fits_int(shift)) {
+            scev_free(&scev);
+            return 0;
+        }
+    }
+
+    UnrollCopier c;
+    memset(&c, 0, sizeof(UnrollCopier));
+    c.ed = ed;
+    c.cfg = cfg;
+    c.pos = first;
+    c.renamable = renamable;
+    c.temp_map = df_alloc(cfg->num_syms, sizeof(IRSymbol *));
+    c.known = df_alloc(cfg->num_syms, sizeof(IRSymbol *));
+    c.known_src = df_alloc(cfg->num_syms, sizeof(int));
+    c.active = df_alloc(cfg->num_syms, sizeof(int));
+    c.labels = df_alloc(last - first, sizeof(IRSymbol *));
+    c.label_map = df_alloc(last - first, sizeof(IRSymbol *));
+    c.header_label = cfg->list->codes[cfg->start + first].result;
+    c.header_target = c.header_label;
+    for (int rel = body_first; rel < last; rel++) {
+        IRCode *code = &cfg->list->codes[cfg->start + rel];
+        if (code->op == IR_LABEL && code->result) c.labels[c.num_labels++] = code->result;
+    }
+    loop_local_temps(nest, loop_index, renamable);
+
+    // El loop completo se reescribe detrás de la etiqueta del header
+    for (int rel = first + 1; rel < last; rel++) loop_editor_remove(ed, rel);
+
+    int growth;
+    if (unroll_full) {
+        for (long long k = 0; k < trips; k++) {
+            copy_begin(&c, true);
+            copy_range(&c, body_first, latch);
+        }
+        if (scev.exit_block != last_block + 1) {
+            IRSymbol *exit_label = cfg->list->codes[cfg->blocks[scev.exit_block].start].result;
+            loop_editor_insert_after(ed, first, (IRCode){IR_GOTO, NULL, NULL, exit_label});
+        }
+        growth = (int)(trips - 1) * body_size;
+        (*full)++;
+    } else {
+        IRCode *exit_test = &cfg->list->codes[cfg->start + branch];
+        IRSymbol *remainder = new_label_symbol();
+
+        // Loop principal: F iteraciones por vuelta mientras alcancen
+        copy_begin(&c, true);
+        copy_range(&c, first + 1, branch);
+        IRSymbol *x = copy_operand(&c, exit_test->arg1);
+        IRSymbol *y = copy_operand(&c, exit_test->arg2);
+        long long shift = scev.trip_step * (factor - 1);
+        if (exit_test->op == IR_IF_LE || exit_test->op == IR_IF_LT) shift = -shift;
+        IRSymbol *shifted;
+        if (is_constant_symbol(x) && fits_int(get_constant_value(x) + shift)) {
+            shifted = new_const_symbol((int)(get_constant_value(x) + shift), 0);
+        } else {
+            shifted = new_temp_symbol();
+            loop_editor_insert_after(ed, first, (IRCode){IR_ADD, x, new_const_symbol((int)shift, 0), shifted});
+        }
+        loop_editor_insert_after(ed, first, (IRCode){exit_test->op, shifted, y, remainder});
+        for (int k = 0; k < factor; k++) {
+            copy_begin(&c, true);
+            copy_range(&c, body_first, latch);
+        }
+        loop_editor_insert_after(ed, first, (IRCode){IR_GOTO, NULL, NULL, c.header_label});
+
+        // Loop de resto: el original, con la etiqueta nueva como header
+        loop_editor_insert_after(ed, first, (IRCode){IR_LABEL, NULL, NULL, remainder});
+        c.header_target = remainder;
+        copy_begin(&c, false);
+        copy_range(&c, first + 1, last);
+        growth = factor * body_size + header_size + 2;
+        (*partial)++;
+    }
+
+    if (debug_mode) {
+        printf("  [UNROLL] Línea %d: loop de max(0, ceil(-(", cfg->start + first);
+        scev_print_affine(stdout, &scev.trip_start);
+        if (unroll_full) {
+            printf(") / %lld)) iteraciones desenrollado por completo (%lld copias)\n", scev.trip_step, trips);
+        } else {
+            printf(") / %lld)) iteraciones desenrollado x%d con loop de resto\n", scev.trip_step, factor);
+        }
+    }
+
+    *budget -= growth;
+    free(c.temp_map);
+    free(c.known);
+    free(c.known_src);
+    free(c.active);
+    free(c.labels);
+    free(c.label_map);
+    scev_free(&scev);
+    return growth;
+}
+
+/*
+ * Loops internos de la función que empieza en start. Devuelve el nuevo final.
+ */
+static int unroll_function(IRList *list, int start, int *full, int *partial, int *growth) {
+    CFG cfg;
+    SSAGraph ssa;
+    LoopNest nest;
+    cfg_build(&cfg, list, start);
+    ssa_build(&ssa, &cfg);
+    loop_nest_build(&nest, &cfg, &ssa);
+
+    int end = cfg.end;
+    if (nest.num_loops > 0) {
+        bool *has_inner = df_alloc(nest.num_loops, sizeof(bool));
+        bool *renamable = df_alloc(cfg.num_syms, sizeof(bool));
+        for (int l = 0; l < nest.num_loops; l++) {
+            if (nest.loops[l].parent >= 0) has_inner[nest.loops[l].parent] = true;
+        }
+        // El código de la función puede crecer como mucho al doble
+        int budget = cfg.end - cfg.start;
+        if (budget < UNROLL_MIN_GROWTH) budget = UNROLL_MIN_GROWTH;
+        LoopEditor ed;
+        loop_editor_init(&ed, &nest);
+        for (int l = 0; l < nest.num_loops; l++) {
+            if (!has_inner[l]) *growth += unroll_loop(&ed, l, renamable, &budget, full, partial);
+        }
+        end = loop_editor_apply(&ed);
+        loop_editor_free(&ed);
+        free(renamable);
+        free(has_inner);
+    }
+
+    loop_nest_free(&nest);
+    ssa_free(&ssa);
+    cfg_free(&cfg);
+    return end;
+}
+
+void optimize_loop_unrolling(IRList *list) {
+    int full = 0, partial = 0, growth = 0;
+    if (unroll_factor < 2) return;
+
+    for (int start = 0; start < list->size; start++) {
+        if (list->codes[start].op != IR_METHOD) continue;
+        start = unroll_function(list, start, &full, &partial, &growth) - 1;
+    }
+
+    if (full + partial > 0 && debug_mode) {
+        printf("✓ Desenrollado de loops: %d completos, %d parciales (factor %d), +%d instrucciones\n",
+               full, partial, unroll_factor, growth);
+    }
+}
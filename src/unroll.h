@@ -0,0 +1,20 @@
+#ifndef UNROLL_H
+#define UNROLL_H
+
+#include "intermediate.h"
+
+/*
+ * Límites del desenrollado: iteraciones de un loop que se desenrolla por
+ * completo, instrucciones del cuerpo desenrollado y crecimiento por función.
+ */
+#define UNROLL_FULL_MAX_TRIPS   16
+#define UNROLL_MAX_BODY         128
+#define UNROLL_MIN_GROWTH       256
+
+/*
+ * Desenrollado de loops contados: completo si la cantidad de iteraciones es
+ * una constante chica, parcial por unroll_factor con un loop de resto si no.
+ */
+void optimize_loop_unrolling(IRList *list);
+
+#endif